@@ -36,6 +36,7 @@ class BFLBody :
 {
 	friend class ObjectManager;
 	friend class GridObj;
+	friend class MpiManager;
 
 public:
 	// Default constructor and destructor
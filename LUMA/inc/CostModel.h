@@ -0,0 +1,78 @@
+/*
+* --------------------------------------------------------------
+*
+* ------ Lattice Boltzmann @ The University of Manchester ------
+*
+* -------------------------- L-U-M-A ---------------------------
+*
+* Copyright 2019 The University of Manchester
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.*
+*/
+
+#ifndef COSTMODEL_H
+#define COSTMODEL_H
+
+#include "stdafx.h"
+
+/// \brief	Per-site cost model used to balance the domain decomposition.
+///
+///			The work of each coarse site is described by a count of features
+///			(fluid updates, solid sites, boundary sites, BFL links and IBM 
+///			support sites) per coarse time step. The cost of a site is the 
+///			weighted sum of its features. Features can be estimated from the 
+///			refinement and wall configuration before the grids are built, 
+///			measured from the grids and bodies of a run or read back from a
+///			map written by a previous run. Weights default to the L_COST_*
+///			values and may be fitted to measured step times.
+class CostModel
+{
+
+public:
+
+	/************** Constructors **************/
+	CostModel();
+	~CostModel();
+
+
+	/************** Member Data **************/
+
+	std::vector<double> weights;	///< Cost of one unit of each feature (access using eCostFeature)
+	std::vector<double> features;	///< Features of each coarse site (feature fastest then k, j and i)
+	int dims[3];					///< Number of coarse sites in each direction
+
+
+	/************** Member Methods **************/
+
+	void buildAnalytic();								// Estimate features from the refinement and wall configuration
+	bool read(const std::string &filename, bool bReadWeights);	// Read features (and weights) from file
+	void write(const std::string &filename) const;		// Write features and weights to file
+	void updateCosts();									// Rebuild the cost sums after features or weights change
+	double getBlockCost(const double *bounds) const;	// Cost of the coarse sites within the bounds
+	double getCost(const double *siteFeatures) const;	// Cost of a set of features
+	double getSiteCost(int i, int j, int k) const;		// Cost of a single coarse site
+	bool isBuilt() const;								// Are the cost sums available
+	bool fitWeights(const std::vector<double> &rankFeatures, 
+		const std::vector<double> &rankTimes);			// Fit weights to measured times of a set of ranks
+	static eCostFeature getFeature(eType type);		// Feature associated with a site type
+	static int getFinestLevel(double x, double y, double z);	// Finest grid level covering a position
+
+private:
+
+	std::vector<double> _sums;		///< Summed-volume table of site costs
+
+	size_t _sumIdx(int i, int j, int k) const;			// Index into the summed-volume table
+
+};
+
+#endif
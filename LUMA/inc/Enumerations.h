@@ -94,6 +94,27 @@ enum eType
 	eSlip					///< Slip boundary
 };
 
+/// \enum  eStreamLink
+/// \brief Streaming link handlers stored in the precomputed stream tables
+enum eStreamLink
+{
+	eStreamRegular,			///< Pull population from the (possibly periodic) source site
+	eStreamBounceBack,		///< Source site is solid so apply half-way bounce-back
+	eStreamExplode,			///< Filled from the parent grid on the first sub-cycle, regular otherwise
+	eStreamCoalesce,		///< Filled from the child grid before streaming
+	eStreamBFL,				///< Filled from the BFL link table before streaming
+	eStreamSpecial			///< Link requires a BC or refinement operation
+};
+
+/// \enum  eSweepSites
+/// \brief Subset of sites visited by a kernel sweep
+enum eSweepSites
+{
+	eSweepAll,				///< All sites
+	eSweepSender,			///< Only sites on an MPI sender layer
+	eSweepInterior			///< All sites not on an MPI sender layer
+};
+
 /// \enum eWallLocation
 /// \brief Enumeration to describe locations in terms of domain walls.
 enum eWallLocation
@@ -169,6 +190,17 @@ enum eMoveableType {
 	eRigid	///< Immersed boundary body
 };
 
+/// \enum  eCostFeature
+/// \brief Features counted by the decomposition cost model.
+enum eCostFeature {
+	eCostFluid,			///< Fluid site update
+	eCostSolid,			///< Solid or refined site which is skipped by the kernel
+	eCostBoundary,		///< Site with a boundary condition handler
+	eCostBFLLink,		///< BFL link
+	eCostIBMSupport,	///< IBM support site interpolated from and spread to
+	eCostNumFeatures	///< Number of features
+};
+
 ///	\enum eSDReturnType
 ///	\brief	Return types for smart decomposition methods.
 enum eSDReturnType {
@@ -179,4 +211,12 @@ enum eSDReturnType {
 	eSDEarlyExit
 };
 
+/// \enum  eAmrCriterion
+/// \brief Criteria used to tag coarse sites for adaptive refinement.
+enum eAmrCriterion {
+	eAmrVorticity,			///< Magnitude of the vorticity
+	eAmrVelocityGradient,	///< Magnitude of the velocity gradient tensor
+	eAmrBodyDistance		///< Distance to the nearest immersed boundary marker
+};
+
 #endif
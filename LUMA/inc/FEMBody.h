@@ -88,9 +88,13 @@ class FEMBody {
 	std::vector<FEMNode> nodes;				///< Vector of FEM nodes
 	std::vector<FEMElement> elements;		///< Vector of FEM elements
 
-	// System matrices
-	std::vector<std::vector<double>> M;			///< Mass matrix
-	std::vector<std::vector<double>> K;			///< Linear stiffness matrix
+	// System matrices (beam elements only couple neighbouring nodes so these are stored banded)
+	int bandWidth;								///< Number of sub- (and super-) diagonals of the system matrices
+	int bandRows;								///< Leading dimension of the banded storage (3 * bandWidth + 1)
+	std::vector<double> M;						///< Mass matrix (LAPACK banded storage)
+	std::vector<double> K;						///< Linear stiffness matrix (LAPACK banded storage, factorised in place)
+	std::vector<int> ipiv;						///< Pivots of the factorised stiffness matrix
+	std::vector<double> Meff_hat;				///< Effective accelerations used to get the inertia forces
 	std::vector<double> R;						///< Load vector
 	std::vector<double> F;						///< Vector of internal forces
 	std::vector<double> U;						///< Vector of displacements
@@ -118,6 +122,16 @@ class FEMBody {
 	// Helper methods
 	double checkNRConvergence();								// Check convergence of the Newton-Raphson scheme
 	void computeNodeMapping(int nIBMNodes, int nFEMNodes);		// Compute mapping between FEM and IBM nodes
+
+	/// \brief	Entry (i,j) of a system matrix in banded storage
+	///
+	///	\param	A	matrix in banded storage
+	///	\param	i	row
+	///	\param	j	column
+	///	\return	reference to the entry
+	inline double& bandEntry(std::vector<double> &A, int i, int j) {
+		return A[j * bandRows + 2 * bandWidth + i - j];
+	}
 };
 
 #endif
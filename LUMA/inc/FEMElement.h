@@ -116,7 +116,7 @@ private:
 
 	// Assembly methods
 	void assembleGlobalMat(const std::vector<double> &localVec, std::vector<double> &globalVec);							// Assemble into global vector
-	void assembleGlobalMat(const std::vector<std::vector<double>> &localMat, std::vector<std::vector<double>> &globalMat);	// Assemble into global matrix
+	void assembleGlobalMat(const std::vector<std::vector<double>> &localMat, std::vector<double> &globalMat);				// Assemble into global banded matrix
 	std::vector<double> disassembleGlobalMat(const std::vector<double> &globalVec);											// Disassemble global vector
 
 };
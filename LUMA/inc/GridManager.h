@@ -36,6 +36,8 @@ class GridManager
 	friend class MpiManager;
 	friend class GridUtils;
 	friend class GridObj;
+	friend class CostModel;
+	friend class ObjectManager;
 
 public:
 	/// Number of active cells in the calculation
@@ -109,6 +111,9 @@ private:
 	void createWritableDataStore(HDFstruct *& datastruct);
 	bool createWritableDataStore(GridObj const * const targetGrid);
 
+	// Compute the edges and size of a sub-grid
+	void setSubGridEdges(int lev, int reg, double dh, bool bPlaced = false);
+
 	// Get estimated active cell count within the global bounds supplied
 	void updateGlobalCellCount();
 	long getActiveCellCount(double *bounds, bool bCountAsOps);
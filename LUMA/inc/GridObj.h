@@ -63,6 +63,14 @@ private :
 	int CoarseLimsY[2];		///< Local Y indices corresponding to where this grid is locate on parent grid
 	int CoarseLimsZ[2];		///< Local Z indices corresponding to where this grid is locate on parent grid
 
+	// Precomputed index maps between this grid and the parent grid
+	std::vector<int> CoarseIdxX;	///< Local X index on the parent grid of each local X index on this grid
+	std::vector<int> CoarseIdxY;	///< Local Y index on the parent grid of each local Y index on this grid
+	std::vector<int> CoarseIdxZ;	///< Local Z index on the parent grid of each local Z index on this grid
+	std::vector<int> FineIdxX;		///< First local X index on this grid of each local X index on the parent grid (-1 if not covered)
+	std::vector<int> FineIdxY;		///< First local Y index on this grid of each local Y index on the parent grid (-1 if not covered)
+	std::vector<int> FineIdxZ;		///< First local Z index on this grid of each local Z index on the parent grid (-1 if not covered)
+
 	// 1D arrays
 public :
 	std::vector<double> XPos;	///< Vector of global X positions of each site
@@ -77,13 +85,13 @@ private :
 
 	// Vector nodal properties
 	// Flattened 4D arrays (i,j,k,vel)
-	IVector<double> f;				///< Distribution functions
-	IVector<double> feq;			///< Equilibrium distribution functions
-	IVector<double> fNew;			///< Copy of distribution functions
+	PopVector f;					///< Distribution functions
+	PopVector feq;				///< Equilibrium distribution functions (only stored for KBC and text output)
+	PopVector fNew;				///< Copy of distribution functions (not stored with in-place streaming)
 	IVector<double> u;				///< Macropscopic velocity components
 	IVector<double> u_n;			///< Macropscopic velocity components at start of current time step
 	IVector<double> force_xyz;		///< Macroscopic body force components
-	IVector<double> force_i;		///< Mesoscopic body force components
+	PopVector force_i;			///< Mesoscopic body force components
 
 	// Scalar nodal properties
 	// Flattened 3D arrays (i,j,k)
@@ -97,10 +105,53 @@ private :
 	// Grid scale parameter
 	double refinement_ratio;	///< Equivalent to (1 / pow(2, level))
 
+	// Precomputed stream tables
+	bool bStreamTablesValid = false;			///< Flag indicating whether stream tables match the current site labels
+	int streamSrcOffset[L_NUM_VELS];			///< Offset of the source site from the current site for each direction
+	std::vector<int> streamLinkStart;			///< Index of first link of each site in the link lists (-1 for bulk sites)
+	std::vector<int> streamLinkSrc;				///< Source site of each boundary link
+	std::vector<eStreamLink> streamLinkKind;	///< Handler for each boundary link
+
+	// Precomputed grid transition links
+	std::vector<int> explodeLinkDst;			///< Population (v + id * L_NUM_VELS) on this grid filled by explosion
+	std::vector<int> explodeLinkSrc;			///< Site on the parent grid from which each exploded population is pulled
+#ifdef L_REFINEMENT_INTERPOLATION
+	std::vector<int> explodeLinkSub;			///< Position of the source site in its parent cell (bit d set if on the positive side in direction d)
+#endif
+	std::vector<int> coalesceLinkDst;			///< Population (v + id * L_NUM_VELS) on this grid filled by coalescence
+	std::vector<int> coalesceLinkSrc;			///< First site of the child cluster averaged for each coalesced population
+	std::vector<GridObj*> coalesceLinkGrid;		///< Child grid holding the cluster of each coalesced population
+
+	// Precomputed BFL links
+	std::vector<int> bflLinkDst;				///< Population (v + id * L_NUM_VELS) on this grid set by the BFL condition
+	std::vector<int> bflLinkSrc;				///< Population interpolated with the reflected population of each BFL link
+	std::vector<double> bflLinkWeight;			///< Interpolation weight of each BFL link derived from its Q value
+	std::vector<int> bflLinkBody;				///< BFL body intersected by each link
+	std::vector<int> bflLinkMarker;				///< Marker receiving the momentum exchange force of each link (-1 if none)
+
+	// Precomputed momentum exchange links
+	std::vector<int> momexLinkSrc;				///< Population (v + id * L_NUM_VELS) at a fluid site pointing into a bounce-back body
+	std::vector<int> momexBodyStart;			///< Index of the first link of each bounce-back body in momexLinkSrc
+
+#ifdef L_USE_SPARSE_LATTICE
+	// Sparse population storage
+	int sparseCount;						///< Number of sites with a slot in the population arrays
+	int sparseShared;						///< Slot shared by all inactive sites (-1 if every site has its own slot)
+	std::vector<int> sparseIdx;				///< Slot of each site in the population arrays
+	std::vector<int> sparseSites;			///< Flattened ijk index of each active site in ascending order
+	std::vector<int> sparsePlaneStart;		///< Position in sparseSites of the first active site of each x-plane
+#endif
+
+#if (defined L_BUILD_FOR_MPI && defined L_MPI_OVERLAP)
+	// Split-phase update
+	std::vector<bool> mpiSenderSite;		///< Flag indicating non-solid sites which lie on an MPI sender layer
+#endif
+
 	// Public data members
 public :
 
 	IVector<eType> LatTyp;			///< Flattened 3D array of site labels
+	std::vector<int> solidBody;		///< Bounce-back body to which each site belongs (-1 if none, empty if no bodies on grid)
 
 	// Grid Scalars
 	double dh;						///< Dimensionless lattice spacing (same for x, y and z)
@@ -143,12 +194,15 @@ public :
 	eType LBM_setBCPrecedence(eType currentBC, eType desiredBC);		// Determine BC based on any existing BC
 
 	// LBM operations
-	DEPRECATED void LBM_kbcCollide(int i, int j, int k, IVector<double>& f_new);		// KBC collision operator
+	DEPRECATED void LBM_kbcCollide(int i, int j, int k, PopVector& f_new);		// KBC collision operator
 	void LBM_macro(int i, int j, int k);
 	DEPRECATED void LBM_resetForces();								// Resets the force vectors on the grid
 
 	// Multi-grid operations
 	void LBM_addSubGrid(int RegionNumber);				// Add and initialise subgrid structure for a given region number
+#ifdef L_ADAPTIVE_REFINEMENT
+	bool LBM_adaptSubGrids();							// Move, resize, create and delete the sub-grids to follow the flow
+#endif
 
 	// IO methods
 	void io_textout(std::string output_tag);	// Writes out the contents of the class as well as any subgrids to a text file
@@ -167,25 +221,130 @@ private :
 											// to a different .fga file for each subgrid. .fga format is the one used for Unreal 
 											// Engine 4 VectorField object.
 	// Private optimised LBM functions
+	void _LBM_multiStart_opt(int subcycle);
 	void _LBM_stream_opt(int i, int j, int k, int id, eType type_local, int subcycle);
+	void _LBM_streamLink_opt(int i, int j, int k, int id, eType type_local, int subcycle, int v);
+	void _LBM_buildStreamTables();
+	void _LBM_buildMomexLinks();
+#ifdef L_USE_SPARSE_LATTICE
+	void _LBM_initSparseStorage();
+	void _LBM_buildSparseLattice();
+	void _LBM_sparseRepack(PopVector &pop, const std::vector<int> &oldIdx, int oldCount, int oldShared, bool bEquilibrium);
+#endif
+	void _LBM_streamCollide_opt(int subcycle, eSweepSites sweep);
+#ifdef L_USE_FUSED_KERNEL
+	void _LBM_fusedStreamCollide_opt(int subcycle, eSweepSites sweep);
+#endif
+#ifdef L_USE_AA_STREAMING
+	void _LBM_aaStreamCollide_opt(int subcycle);
+	void _LBM_aaGather_opt(int i, int j, int k, int id, bool bOddStep, double *fSite);
+	void _LBM_aaScatter_opt(int i, int j, int k, int id, bool bOddStep, const double *fSite);
+	double _LBM_aaGetPopulation(int i, int j, int k, int v);
+#endif
 	void _LBM_coalesce_opt(int i, int j, int k, int id, int v);
 	void _LBM_explode_opt(int id, int v, int src_x, int src_y, int src_z);
+	void _LBM_transitionLinks_opt(int subcycle);
+#ifdef L_REFINEMENT_INTERPOLATION
+	double _LBM_explodeValue_opt(int v, int pId, int sub);
+#endif
+	GridObj * _LBM_getChildGrid(int i, int j, int k);
+#ifdef L_ADAPTIVE_REFINEMENT
+	void _LBM_restrictMacros();
+	void _LBM_tagSites(std::vector<unsigned char> &tags, const int *size);
+	void _LBM_velocityGradient(int i, int j, int k, double *grad);
+	void _LBM_getSiteState(int id, double *state);
+	void _LBM_setSiteState(int id, const double *state);
+	bool _LBM_restrictSite(int id, double *state);
+	int _LBM_findSite(double x, double y, double z);
+	void _LBM_gatherGrids(std::vector<GridObj*> &grids);
+	void _LBM_adaptFill(const std::vector<GridObj*> &oldGrids,
+		const std::vector<int> &restrictedSlot, const std::vector<double> &restricted);
+#endif
 	void _LBM_collide_opt(int id);
+	void _LBM_collide_opt(int id, double *fSite);
+#ifdef L_USE_SIMD_COLLISION
+	void _LBM_collideSites_opt(const std::vector<int> &ids);
+#endif
 	void _LBM_macro_opt(int i, int j, int k, int id, eType type_local);
+	void _LBM_macro_opt(int i, int j, int k, int id, eType type_local, const double *fSite);
 	void _LBM_forceGrid_opt(int id);
 	double _LBM_equilibrium_opt(int id, int v);
-	bool _LBM_applyBFL_opt(int id, int src_id, int v, int i, int j, int k, int src_x, int src_y, int src_z);
+	bool _LBM_addBFLLink(int i, int j, int k, int id, int src_id, int v,
+		const std::vector<int> &siteBody, const std::vector<int> &siteMarker);
+	void _LBM_bflLinks_opt();
 	bool _LBM_applySpecReflect_opt(int i, int j, int k, int id, int v);
 	void _LBM_regularised_opt(int i, int j, int k, int id, eType type, int subcycle);
+	void _LBM_regularised_opt(int i, int j, int k, int id, eType type, int subcycle, double *fSite);
 	void _LBM_kbcCollide_opt(int id);
 	void _LBM_resetForces();
-	double _LBM_smag(int id, double omega);
+	double _LBM_smag(int id, double omega, const double *fSite);
 	void _LBM_updateInteriorLatticeSite(int i, int j, int k, int subcycle);
 	double _LBM_updateAndExtrapolate(int subcycle, IVector<double> &quantity,
 			std::vector<int> direction, int order, int i, int j, int k, int p = NULL, int max = 1);
 
 public :
 	void LBM_multi_opt(int subcycle = 0);
+	void LBM_invalidateStreamTables();
+#if (defined L_USE_SIMD_COLLISION && defined L_COLLISION_BENCHMARK)
+	void LBM_benchmarkCollision();
+#endif
+#if (defined L_ENABLE_OPENMP && defined L_OMP_BENCHMARK)
+	void LBM_benchmarkThreads();
+#endif
+
+	/// \brief	Flattened index of a population.
+	///
+	///			Populations are stored as an array of structures (velocity 
+	///			fastest) by default or as a structure of arrays (one array per 
+	///			velocity) when the fused kernel is used. With sparse storage the
+	///			site is first mapped to its slot so inactive sites share a 
+	///			single slot. All access to f, fNew, feq and force_i should go 
+	///			through this method.
+	///
+	///	\param	v	lattice direction.
+	///	\param	id	flattened ijk index.
+	///	\return	index into the population array.
+	inline int fIdx(int v, int id) const
+	{
+#if (defined L_USE_SPARSE_LATTICE && defined L_USE_FUSED_KERNEL)
+		return sparseIdx[id] + v * sparseCount;
+#elif defined L_USE_SPARSE_LATTICE
+		return v + sparseIdx[id] * L_NUM_VELS;
+#elif defined L_USE_FUSED_KERNEL
+		return id + v * N_lim * M_lim * K_lim;
+#else
+		return v + id * L_NUM_VELS;
+#endif
+	}
+
+	/// \brief	Flattened index of a population.
+	///
+	///	\param	i	x-index of site.
+	///	\param	j	y-index of site.
+	///	\param	k	z-index of site.
+	///	\param	v	lattice direction.
+	///	\return	index into the population array.
+	inline int fIdx(int i, int j, int k, int v) const
+	{
+		return fIdx(v, k + j * K_lim + i * K_lim * M_lim);
+	}
+
+	/// \brief	Is a site visited by the given sweep.
+	///
+	///			When overlapping communication the sender layer sites are 
+	///			updated in a separate sweep ahead of the rest of the grid.
+	///
+	///	\param	id		flattened ijk index.
+	///	\param	sweep	subset of sites being updated.
+	///	\return	true if the site should be updated.
+	inline bool _LBM_inSweep(int id, eSweepSites sweep) const
+	{
+#if (defined L_BUILD_FOR_MPI && defined L_MPI_OVERLAP)
+		return (sweep == eSweepAll || mpiSenderSite[id] == (sweep == eSweepSender));
+#else
+		return true;
+#endif
+	}
 
 
 };
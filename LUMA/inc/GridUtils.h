@@ -29,6 +29,8 @@
 // LAPACK interfaces
 extern "C" void dgetrf_(int* dim1, int* dim2, double* a, int* lda, int* ipiv, int* info);
 extern "C" void dgetrs_(char *TRANS, int *N, int *NRHS, double *A, int *LDA, int *IPIV, double *B, int *LDB, int *INFO );
+extern "C" void dgbtrf_(int *M, int *N, int *KL, int *KU, double *AB, int *LDAB, int *IPIV, int *INFO);
+extern "C" void dgbtrs_(char *TRANS, int *N, int *KL, int *KU, int *NRHS, double *AB, int *LDAB, int *IPIV, double *B, int *LDB, int *INFO);
 
 /// \brief	Grid utility class.
 ///
@@ -77,6 +79,15 @@ public:
 	static std::vector<double> divide(std::vector<double> vec1, double scalar);					// Divide vector by a scalar
 	static std::vector<std::vector<double>> matrix_transpose(std::vector<std::vector<double>> &origMat);			// Transpose a matrix
 	static std::vector<double> solveLinearSystem(std::vector<std::vector<double>> &A, std::vector<double> b, int BC = 0);		// Solve A.x = b
+	static void solveBandedSystem(std::vector<double> &AB, int kl, int ku, std::vector<double> &b, std::vector<int> &ipiv, int BC = 0);	// Solve banded A.x = b in place
+#ifdef L_BUILD_FOR_MPI
+	static double solveSparseSystem(const std::vector<int> &rowPtr, const std::vector<int> &colIdx, const std::vector<double> &val,
+		const std::vector<double> &b, std::vector<double> &x, int &iterations,
+		const std::vector<int> &rowCounts, MPI_Comm comm);											// Solve sparse A.x = b with rows distributed over comm
+#else
+	static double solveSparseSystem(const std::vector<int> &rowPtr, const std::vector<int> &colIdx, const std::vector<double> &val,
+		const std::vector<double> &b, std::vector<double> &x, int &iterations);						// Solve sparse A.x = b
+#endif
 
 	// LBM-specific utilities
 	static int getOpposite(int direction);	// Function: getOpposite
@@ -105,6 +116,7 @@ public:
 	static bool isOnRecvLayer(double site_position, eCartMinMax edge);				// Is site on specified recv layer
 	static int getMpiDirection(int offset_vector[]);								// Get MPI direction from vector
 	static int safeGetRank();														// Parallel/Serial safe method to get rank
+	static void getThreadPlaneRange(int N_lim, int *start, int *end);				// Range of x-planes owned by the calling OpenMP thread
 
 	// Coordinate Management
 	static bool isOffGrid(int i, int j, int k, GridObj const * const g);											// Is site off supplied grid
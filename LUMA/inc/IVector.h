@@ -30,9 +30,10 @@
 ///			This class has all the behaviour of std::vector but 
 ///			has a overriden operator() to allow automatic flattening of indices 
 ///			before returning a reference of value at indexed location.
-///			Needs to be able to accept different datatypes so templated.
-template <typename GenTyp>
-class IVector :	public std::vector<GenTyp>		// Define IVector class which inherits from std::vector
+///			Needs to be able to accept different datatypes so templated. An
+///			allocator may also be supplied (standard allocator by default).
+template <typename GenTyp, typename Alloc = std::allocator<GenTyp> >
+class IVector :	public std::vector<GenTyp, Alloc>		// Define IVector class which inherits from std::vector
 {
 	
 public:
@@ -135,4 +136,45 @@ public:
 
 };
 
+
+/// \brief	Allocator which does not initialise elements on resize.
+///
+///			Resizing a vector using this allocator reserves the memory without
+///			writing to it. Each page is then placed in the memory of the NUMA 
+///			node of the thread which first writes to it (first-touch) rather 
+///			than that of the thread which resized the vector.
+template <typename T>
+class FirstTouchAllocator : public std::allocator<T>
+{
+
+public:
+
+	/// Rebind to allocator of another type
+	template <typename U>
+	struct rebind { typedef FirstTouchAllocator<U> other; };
+
+	/// Default constructor
+	FirstTouchAllocator() { }
+
+	/// Copy constructor from allocator of another type
+	template <typename U>
+	FirstTouchAllocator(const FirstTouchAllocator<U>&) { }
+
+	/// Default-initialise (i.e. do not touch) new elements
+	template <typename U>
+	void construct(U *p) { ::new (static_cast<void*>(p)) U; }
+
+	/// Construct new elements with arguments as usual
+	template <typename U, typename... Args>
+	void construct(U *p, Args&&... args) { ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...); }
+
+};
+
+/// Vector type used for population arrays (f, fNew, feq, force_i)
+#ifdef L_ENABLE_OPENMP
+typedef IVector<double, FirstTouchAllocator<double> > PopVector;
+#else
+typedef IVector<double> PopVector;
+#endif
+
 #endif
\ No newline at end of file
@@ -26,19 +26,12 @@
 #include "stdafx.h"
 #include "HDFstruct.h"
 #include "IBInfo.h"
+#include "CostModel.h"
 class GridObj;
 class GridManager;
 class IBBody;
 
 
-// Define the loop expressions required to inspect the overlap regions of a grid for ease of coding
-#define range_i_left	i = 0; i < GridUtils::downToLimit((int)pow(2, g->level + 1), N_lim); i++	///< For loop definition for left halo
-#define range_j_down	j = 0; j < GridUtils::downToLimit((int)pow(2, g->level + 1), M_lim); j++	///< For loop definition for bottom halo
-#define range_k_front	k = 0; k < GridUtils::downToLimit((int)pow(2, g->level + 1), K_lim); k++	///< For loop definition for front halo
-#define range_i_right	i = GridUtils::upToZero(N_lim - (int)pow(2, g->level + 1)); i < N_lim; i++	///< For loop definition for right halo
-#define range_j_up		j = GridUtils::upToZero(M_lim - (int)pow(2, g->level + 1)); j < M_lim; j++	///< For loop definition for top halo
-#define range_k_back	k = GridUtils::upToZero(K_lim - (int)pow(2, g->level + 1)); k < K_lim; k++	///< For loop definition for back halo
-
 /// \brief	MPI Manager class.
 ///
 ///			Class to manage all MPI apsects of the code.
@@ -171,20 +164,109 @@ public :
 	MPI_Status recv_stat;					///< Status structure for Receive return information
 	MPI_Request send_requests[L_MPI_DIRS];	///< Array of request structures for handles to posted ISends
 	MPI_Status send_stat[L_MPI_DIRS];		///< Array of statuses for each ISend
+	MPI_Request recv_requests[L_MPI_DIRS];	///< Array of request structures for handles to posted IRecvs
+	MPI_Status recv_stats[L_MPI_DIRS];		///< Array of statuses for each IRecv
 
 	/// \struct BufferSizeStruct
-	/// \brief	Structure storing buffers sizes in each direction for particular grid.
+	/// \brief	Structure storing buffers sizes and sites in each direction for particular grid.
 	struct BufferSizeStruct
 	{
-		int size[L_MPI_DIRS];	///< Buffer sizes for each direction
-		int level;				///< Grid level
-		int region;				///< Region number
+		int size[L_MPI_DIRS];				///< Buffer sizes (number of sites) for each direction
+		std::vector<int> sites[L_MPI_DIRS];	///< Flattened ijk index of each site passed in each direction
+		int level;							///< Grid level
+		int region;							///< Region number
 
 		BufferSizeStruct(int l, int r) 
 			: level(l), region(r){};
 	};
 	std::vector<BufferSizeStruct> buffer_send_info;	///< Vectors of buffer_info structures holding sender layer size info.
 	std::vector<BufferSizeStruct> buffer_recv_info;	///< Vectors of buffer_info structures holding receiver layer size info.
+	std::vector<int> crossing_vels[L_MPI_DIRS];		///< Lattice directions of the populations passed in each MPI direction
+
+	/// \struct HaloExchangeStruct
+	/// \brief	Halo exchange of a particular grid which has been posted but not completed.
+	///
+	///			The buffers bound to the posted messages are swapped out of 
+	///			f_buffer_send and f_buffer_recv until the exchange completes so 
+	///			that the exchanges of several grids may be in flight at once.
+	struct HaloExchangeStruct
+	{
+		std::vector<double> send[L_MPI_DIRS];	///< Outgoing buffer for each direction
+		std::vector<double> recv[L_MPI_DIRS];	///< Incoming buffer for each direction
+		MPI_Request send_requests[L_MPI_DIRS];	///< Send requests (null if direction does not send)
+		MPI_Request recv_requests[L_MPI_DIRS];	///< Receive requests (null if direction does not receive)
+		MPI_Request neighbour_request;			///< Request of the neighbourhood collective (null if not used)
+		clock_t comm_clock;						///< Time spent posting the exchange
+
+		HaloExchangeStruct() 
+			: neighbour_request(MPI_REQUEST_NULL), comm_clock(0)
+		{
+			std::fill(send_requests, send_requests + L_MPI_DIRS, MPI_REQUEST_NULL);
+			std::fill(recv_requests, recv_requests + L_MPI_DIRS, MPI_REQUEST_NULL);
+		};
+	};
+	std::vector<HaloExchangeStruct> halo_exchanges;	///< Exchange of each grid (indexed by level and region)
+
+#ifdef L_MPI_PERSISTENT
+	/// \struct PersistentCommStruct
+	/// \brief	Fixed buffers and persistent requests for the halo exchange of a particular grid.
+	///
+	///			The buffers are swapped into f_buffer_send and f_buffer_recv for
+	///			the duration of an exchange. Swapping vectors does not move their
+	///			storage so the requests remain bound to the right memory.
+	struct PersistentCommStruct
+	{
+		std::vector<double> send[L_MPI_DIRS];	///< Outgoing buffer for each direction
+		std::vector<double> recv[L_MPI_DIRS];	///< Incoming buffer for each direction
+		MPI_Request send_requests[L_MPI_DIRS];	///< Persistent send requests (null if direction does not send)
+		MPI_Request recv_requests[L_MPI_DIRS];	///< Persistent receive requests (null if direction does not receive)
+		int level;								///< Grid level
+		int region;								///< Region number
+		bool reverse;							///< Set if these are the reverse (in-place streaming) exchange requests
+
+		PersistentCommStruct(int l, int r, bool rev)
+			: level(l), region(r), reverse(rev) {};
+	};
+	std::vector<PersistentCommStruct> persistent_comms;	///< Persistent exchange data for each grid on the rank
+#endif
+
+#ifdef L_MPI_NEIGHBOUR_COLLECTIVES
+	/// \struct NeighbourCommStruct
+	/// \brief	Distributed graph topology used to exchange the halo of a particular grid.
+	///
+	///			Edges are only created for the directions which communicate and 
+	///			are listed in ascending direction order on both sides so that 
+	///			multiple edges between the same pair of ranks match up.
+	struct NeighbourCommStruct
+	{
+		MPI_Comm comm;							///< Graph communicator (MPI_COMM_NULL if grid not on this rank)
+		std::vector<int> send_dirs;				///< MPI direction of each outgoing edge
+		std::vector<int> recv_dirs;				///< MPI direction of each incoming edge
+		std::vector<int> send_counts;			///< Number of values sent along each edge
+		std::vector<int> recv_counts;			///< Number of values received along each edge
+		std::vector<MPI_Aint> send_displs;		///< Absolute address of the buffer of each outgoing edge
+		std::vector<MPI_Aint> recv_displs;		///< Absolute address of the buffer of each incoming edge
+		std::vector<MPI_Datatype> send_types;	///< Datatype of each outgoing edge
+		std::vector<MPI_Datatype> recv_types;	///< Datatype of each incoming edge
+		int level;								///< Grid level
+		int region;								///< Region number
+		bool reverse;							///< Set if this is the reverse (in-place streaming) exchange
+
+		NeighbourCommStruct(int l, int r, bool rev)
+			: comm(MPI_COMM_NULL), level(l), region(r), reverse(rev) {};
+	};
+	std::vector<NeighbourCommStruct> neighbour_comms;	///< Graph topologies for each grid in the hierarchy
+	bool bNeighbourCollectives;							///< Flag to select the neighbourhood collective (else point-to-point)
+#endif
+
+#ifdef L_MPI_COST_MODEL
+	CostModel costModel;				///< Per-site cost model used by the smart decomposition
+	std::vector<double> rank_features;	///< Cost features of this rank measured from its grids and bodies
+#endif
+
+#ifdef L_MPI_REBALANCE
+	double rebalance_time = 0.0;		///< Step time of this rank at the last load balance check
+#endif
 
 	/// Logfile handle
 	std::ofstream* logout;
@@ -206,6 +288,7 @@ public :
 	// Initialisation
 	void mpi_init();												// Initialisation of MpiManager & Cartesian topology
 	void mpi_gridbuild(GridManager* const grid_man);				// Do domain decomposition to build local grid dimensions
+	void mpi_setLocalGrid(GridManager* const grid_man);				// Set the local grid size, rank core edges and halo positions
 	void mpi_communicateBlockEdges();								// Get the positional limits of all ranks
 	int mpi_buildCommunicators(GridManager* const grid_man);		// Create a new communicator for each sub-grid and region combo
 	void mpi_updateLoadInfo(GridManager* const grid_man);			// Method to compute the number of active cells on the rank and pass to master
@@ -218,33 +301,81 @@ public :
 	bool mpi_SDCheckDelta(SDData& solutionData, double dh, std::vector<int>& numCores);
 	void mpi_SDCommunicateSolution(SDData& solutionData, double imbalance, double dh);
 	void mpi_setSubGridDepth();										// Method to initialise the rankGrids variable
+	void mpi_updateHierarchy();										// Rebuild the communicators, buffers and IBM set up after the hierarchy changes
+
+	// Non-uniform decomposition
+	void mpi_getSiteCosts(std::vector<double>& costs);				// Cost of each coarse site used by the decompositions
+	void mpi_bisectionDecompose(int numBlocks, 
+		std::vector<double>& costs, std::vector<int>& owner);		// Decompose by recursive coordinate bisection
+	void mpi_bisect(int *lo, int *hi, int firstBlock, int numBlocks,
+		std::vector<double>& costs, std::vector<int>& owner);		// Recursively bisect a box of coarse sites
+	void mpi_curveDecompose(int numBlocks, 
+		std::vector<double>& costs, std::vector<int>& owner);		// Decompose along a Hilbert curve
+	static unsigned long long mpi_getHilbertKey(int i, int j, int k, int bits);	// Position of a site along a Hilbert curve
+	double mpi_evaluateDecomposition(int numBlocks, std::vector<double>& costs, std::vector<int>& owner,
+		std::vector<std::vector<int>>& neighbours, double& heaviestCost);	// Imbalance and neighbour lists of a decomposition
+#ifdef L_MPI_COST_MODEL
+	void mpi_buildCostModel();										// Build the cost model on the master before decomposition
+	void mpi_measureCostFeatures();									// Measure the cost features of the grids and bodies on this rank
+	void mpi_writeCostMap();										// Calibrate (if required) and write the cost map for future runs
+#endif
+#ifdef L_MPI_REBALANCE
+	double mpi_getRankTime();										// Total time spent updating the grids of this rank
+	bool mpi_rebalance(GridObj *&Grids);							// Check the step times and rebalance the decomposition if required
+	GridObj* mpi_rebuildGrids(GridObj *oldGrids);					// Build the grids of the new decomposition and migrate the site data
+#endif
 
 	// Helper functions
 	std::vector<int> mpi_mapRankLevelToWorld(int level);			// Map rank numbers from level communicator to world communcator
 	std::vector<int> mpi_mapRankWorldToLevel(int level);			// Map rank numbers from world communicator to level communicator
+	void mpi_passSitesToRanks(std::vector<double>& sites, int nValues,
+		std::vector<double>& recvBuffer);							// Pass packed sites to every rank whose core or halo contains them
 
 	// Buffer methods
 	void mpi_buffer_pack(int dir, GridObj* const g);		// Pack the buffer ready for data transfer on the supplied grid in specified direction
 	void mpi_buffer_unpack(int dir, GridObj* const g);		// Unpack the buffer back to the grid given
+#ifdef L_USE_AA_STREAMING
+	void mpi_buffer_packReverse(int dir, GridObj* const g);		// Pack the recv layer to be returned to its owner
+	void mpi_buffer_unpackReverse(int dir, GridObj* const g);	// Unpack populations returned from the recv layer of a neighbour
+#endif
 	void mpi_buffer_size();									// Set buffer size information for grids in hierarchy given and 
 															// set pointer to hierarchy for subsequent access
-	void mpi_buffer_size_send( GridObj* const g );			// Routine to find the size of the sending buffer on supplied grid
-	void mpi_buffer_size_recv( GridObj* const g );			// Routine to find the size of the receiving buffer on supplied grid
+	void mpi_buffer_size_send( GridObj* const g );			// Routine to find the sites and size of the sending buffer on supplied grid
+	void mpi_buffer_size_recv( GridObj* const g );			// Routine to find the sites and size of the receiving buffer on supplied grid
+	void mpi_buffer_findSites(GridObj* const g, int dir, bool bSender, std::vector<int> &sites);	// Find the sites of a sender or receiver layer
+	BufferSizeStruct* mpi_findBufferInfo(std::vector<BufferSizeStruct> &info, GridObj const * const g);	// Get the buffer info of the supplied grid
+	int mpi_getSitePayload(int dir);						// Number of values passed per site in specified direction
 
 	// IO
 	void mpi_writeout_buf(std::string filename, int dir);		// Write out the buffers of direction dir to file
 
 	// Comms
 	void mpi_communicate( int level, int regnum );		// Wrapper routine for communication between grids of given level/region
+	void mpi_communicateStart( int level, int regnum );	// Pack and post the non-blocking exchange for the grid of given level/region
+	void mpi_communicateFinish( int level, int regnum );	// Complete the exchange and unpack into the halo
+	void mpi_communicateComplete( GridObj* const g );		// Wait for the exchange of the supplied grid and unpack into the halo
+	HaloExchangeStruct* mpi_getHaloExchange(GridObj* const g);	// Get the exchange of the supplied grid
 	int mpi_getOpposite(int direction);					// Version of GridUtils::getOpposite for MPI_directions rather than lattice directions
+#ifdef L_MPI_PERSISTENT
+	PersistentCommStruct* mpi_getPersistentComms(GridObj* const g);	// Get (creating if necessary) the persistent exchange of the supplied grid
+	void mpi_freePersistentComms();										// Free all persistent requests and buffers
+#endif
+#ifdef L_MPI_NEIGHBOUR_COLLECTIVES
+	void mpi_buildNeighbourComms();						// Create the graph topologies of the communicating ranks for every grid
+	void mpi_freeNeighbourComms();						// Free the graph topologies
+	void mpi_neighbourExchangeStart(GridObj* const g);	// Post the neighbourhood collective on the packed buffers of the supplied grid
+#endif
+#ifdef L_MPI_BENCHMARK
+	void mpi_benchmarkExchange();						// Time the halo exchange of the coarse grid for each transport
+#endif
 
 	// IBM
 	void mpi_buildMarkerComms(int level);												// Build comms required for epsilon calculation
 	void mpi_buildSupportComms(int level);												// Build comms required for support communication
 	void mpi_epsilonCommGather(int level);												// Do communication required for epsilon calculation
 	void mpi_epsilonCommScatter(int level);												// Do communication required for epsilon calculation
-	void mpi_uniEpsilonCommGather(int level, int rootRank, IBBody &iBodyTmp);			// Do communication required for universal epsilon calculation
-	void mpi_uniEpsilonCommScatter(int level, int rootRank, IBBody &iBodyTmp);			// Do communication required for universal epsilon calculation
+	void mpi_uniEpsilonCommGather(int level, std::vector<double> &cols, std::vector<int> &rowCounts);	// Do communication required for universal epsilon calculation
+	void mpi_uniEpsilonCommScatter(int level);											// Do communication required for universal epsilon calculation
 	void mpi_interpolateComm(int level, std::vector<std::vector<double>> &interpVels);	// Do communication required for velocity interpolation
 	void mpi_spreadComm(int level, std::vector<std::vector<double>> &spreadForces);		// Do communication required for force spreading
 	void mpi_dsCommScatter(int level);													// Spread the ds values from owner to other ranks
@@ -253,7 +384,7 @@ public :
 
 	// FEM
 	void mpi_forceCommGather(int level);
-	void mpi_spreadNewMarkers(int level, std::vector<std::vector<int>> &markerIDs, std::vector<std::vector<std::vector<double>>> &positions, std::vector<std::vector<std::vector<double>>> &vels);
+	void mpi_spreadNewMarkers(int level, std::vector<int> &ownedBodies, std::vector<std::vector<int>> &markerIDs, std::vector<std::vector<std::vector<double>>> &positions, std::vector<std::vector<std::vector<double>>> &vels);
 };
 
 #endif
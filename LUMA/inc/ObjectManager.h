@@ -86,6 +86,36 @@ class ObjectManager
 
 	};
 
+	/// \brief	Packed IBM support stencils for a grid level.
+	///
+	///			Rows are the valid markers on this rank and entries are their 
+	///			on-rank support sites with the weights prefolded so that 
+	///			interpolation and spreading are sparse matrix-vector products. 
+	///			The spreading entries are also stored transposed (by site) so 
+	///			each site is only written by one thread. Rebuilt with epsilon.
+	class IBStencil
+	{
+	public:
+
+		// Rows (markers)
+		std::vector<int> rowBody;			///< Index of the body in iBody
+		std::vector<int> rowMarker;			///< Index of the marker in its body
+		std::vector<GridObj*> rowGrid;		///< Grid owning the body
+		std::vector<int> rowStart;			///< Offset of the first entry of each row (rows + 1)
+		std::vector<double> rowForce;		///< Packed marker forces
+
+		// Entries in marker order
+		std::vector<int> site;				///< Flattened grid site index
+		std::vector<double> wInterp;		///< Interpolation weight (deltaval * local_area)
+
+		// Entries in site order
+		std::vector<int> uniqueSite;		///< Flattened index of each support site
+		std::vector<GridObj*> siteGrid;		///< Grid owning each support site
+		std::vector<int> siteStart;			///< Offset of the first entry of each site (sites + 1)
+		std::vector<int> siteRow;			///< Row of each entry
+		std::vector<double> wSpread;		///< Spreading weight (deltaval * epsilon * ds, times ds in 3D)
+	};
+
 	/* Members */
 
 private:
@@ -94,11 +124,9 @@ private:
 	std::ofstream debugstream;
 
 	// Bounce-back object fields
-	double bbbForceOnObjectX = 0.0;			///< Instantaneous X-direction force on BB bodies in domain
-	double bbbForceOnObjectY = 0.0;			///< Instantaneous Y-direction force on BB bodies in domain
-	double bbbForceOnObjectZ = 0.0;			///< Instantaneous Z-direction force on BB bodies in domain
-	int bbbOnGridLevel = -1;				///< Grid level on which the BB body resides
-	int bbbOnGridReg = -1;					///< Grid region on which the BB body resides
+	std::vector<double> bbbForce;			///< Instantaneous force on each BB body (X, Y and Z components)
+	std::vector<int> bbbOnGridLevel;		///< Grid level on which each BB body resides
+	std::vector<int> bbbOnGridReg;			///< Grid region on which each BB body resides
 
 	// Objects (could be stored in a single Body array if we use pointers)
 	std::vector<IBBody> iBody;				///< Array of immersed boundary bodies
@@ -120,6 +148,9 @@ private:
 	// Vector of indices for iBody vector for which this rank owns and is flexible
 	std::vector<int> idxFEM;
 
+	// Packed support stencils for each grid level
+	std::vector<IBStencil> ibmStencil;
+
 	// Subiteration loop parameters
 	double timeav_subResidual;
 	double timeav_subIterations;
@@ -150,12 +181,20 @@ public:
 	void ibm_computeForce(int level);												// Compute restorative force at each marker in ib-th body.
 	void ibm_findEpsilon(int level);												// Method to find epsilon weighting parameter for ib-th body.
 	void ibm_computeDs(int level);
+	void ibm_buildStencils(int level);												// Pack the on-rank support stencils of a level into a flat table.
 	void ibm_moveBodies(int level);													// Update all IBBody positions and support.
 	void ibm_finaliseReadIn(int iBodyID);											// Do some house-keeping after geometry read in
-	void ibm_universalEpsilonGather(int level, IBBody &iBodyTmp);					// Gather all the markers into the temporary iBody vector
-	void ibm_universalEpsilonScatter(int level, IBBody &iBodyTmp);					// Gather all the markers into the temporary iBody vector
+	void ibm_universalEpsilonGather(int level, std::vector<IBMarker*> &rows, std::vector<double> &cols, std::vector<int> &rowCounts);	// Gather the markers of a level for the epsilon system
+	void ibm_universalEpsilonScatter(int level);									// Send epsilon values to the owning ranks
+	void ibm_buildEpsilonMatrix(const std::vector<IBMarker*> &rows, const std::vector<double> &cols, double dh,
+		std::vector<int> &rowPtr, std::vector<int> &colIdx, std::vector<double> &val);	// Assemble the sparse epsilon matrix
 	void ibm_subIterate(GridObj *g);												// Subiterate to enforce correct kinematic conditions at interface
 	double ibm_checkVelDiff(int level);												// Check residual from sub-iteration step
+#ifdef L_ADAPTIVE_REFINEMENT
+	void ibm_tagSites(std::vector<unsigned char> &tags, const int *size, double dh);	// Tag coarse sites near the markers for adaptive refinement
+	bool ibm_insideSubGrids();														// Check bodies on sub-grids lie inside the edges of their grid
+	void ibm_updateOwners(GridObj *Grids);											// Point bodies on sub-grids at the grids of a new hierarchy
+#endif
 
 	// IBM Debug methods //
 	void ibm_debug_epsilon(int ib);
@@ -170,13 +209,13 @@ public:
 	void ibm_updateMPIComms(int level);
 	void ibm_interpolateOffRankVels(int level);
 	void ibm_spreadOffRankForces(int level);
-	void ibm_updateMarkers(int level);
+	void ibm_updateMarkers(int level, bool bAllBodies = false);
 
 	// Bounceback Body Methods
 	void addBouncebackObject(GeomPacked *geom, PCpts *_PCpts);				// Override method to add BBB from cloud reader.
 	void addBouncebackObject(GridObj *g, GeomPacked *geom, PCpts *_PCpts);	// Method to add a BBB from the cloud reader.
-	void computeLiftDrag(int i, int j, int k, GridObj *g);			// Compute force using Momentum Exchange for BBB on supplied grid.
-	void computeLiftDrag(int v, int id, GridObj *g, int markerID);	// Compute force using Momentum Exchange for BFL on supplied grid.
+	void computeLiftDrag(GridObj *g);								// Compute force using Momentum Exchange for BBB on supplied grid.
+	void computeLiftDrag(int v, int id, GridObj *g, int bodyID, int markerID);	// Compute force using Momentum Exchange for BFL on supplied grid.
 	void resetMomexBodyForces(GridObj * grid);						// Reset the force stores for Momentum Exchange
 
 	// IO methods //
@@ -0,0 +1,154 @@
+/*
+* --------------------------------------------------------------
+*
+* ------ Lattice Boltzmann @ The University of Manchester ------
+*
+* -------------------------- L-U-M-A ---------------------------
+*
+* Copyright 2019 The University of Manchester
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.*
+*/
+
+#ifndef SIMDDOUBLE_H
+#define SIMDDOUBLE_H
+
+// Select the widest instruction set enabled by the compiler flags
+#if defined(__AVX512F__)
+#include <immintrin.h>
+#define L_SIMD_WIDTH 8		///< Number of doubles processed together (AVX-512)
+#elif defined(__AVX__)
+#include <immintrin.h>
+#define L_SIMD_WIDTH 4		///< Number of doubles processed together (AVX/AVX2)
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define L_SIMD_WIDTH 2		///< Number of doubles processed together (SSE2)
+#else
+#define L_SIMD_WIDTH 1		///< Number of doubles processed together (scalar fallback)
+#endif
+
+/// \brief	Packed vector of doubles.
+///
+///			Thin wrapper around the SIMD register type for the instruction set 
+///			selected at compile time so that kernels can be written once and 
+///			process L_SIMD_WIDTH lattice sites at a time. Falls back to a 
+///			single double if no instruction set is available. Only the 
+///			arithmetic required by the collision kernels is provided and 
+///			operations map one-to-one onto the scalar ones so results are 
+///			identical to the scalar kernels.
+class SimdDouble
+{
+public:
+
+#if (L_SIMD_WIDTH == 8)
+	typedef __m512d RegType;
+#elif (L_SIMD_WIDTH == 4)
+	typedef __m256d RegType;
+#elif (L_SIMD_WIDTH == 2)
+	typedef __m128d RegType;
+#else
+	typedef double RegType;
+#endif
+
+	RegType r;		///< Register holding the packed values
+
+	/// Default constructor (uninitialised)
+	SimdDouble() {};
+
+#if (L_SIMD_WIDTH > 1)
+	/// Construct from register
+	SimdDouble(RegType reg) : r(reg) {};
+#endif
+
+	/// Broadcast a scalar to all lanes
+	SimdDouble(double val)
+	{
+#if (L_SIMD_WIDTH == 8)
+		r = _mm512_set1_pd(val);
+#elif (L_SIMD_WIDTH == 4)
+		r = _mm256_set1_pd(val);
+#elif (L_SIMD_WIDTH == 2)
+		r = _mm_set1_pd(val);
+#else
+		r = val;
+#endif
+	};
+
+	/// Load L_SIMD_WIDTH contiguous values (no alignment required)
+	static SimdDouble load(const double *p)
+	{
+#if (L_SIMD_WIDTH == 8)
+		return SimdDouble(_mm512_loadu_pd(p));
+#elif (L_SIMD_WIDTH == 4)
+		return SimdDouble(_mm256_loadu_pd(p));
+#elif (L_SIMD_WIDTH == 2)
+		return SimdDouble(_mm_loadu_pd(p));
+#else
+		return SimdDouble(*p);
+#endif
+	};
+
+	/// Store L_SIMD_WIDTH contiguous values (no alignment required)
+	void store(double *p) const
+	{
+#if (L_SIMD_WIDTH == 8)
+		_mm512_storeu_pd(p, r);
+#elif (L_SIMD_WIDTH == 4)
+		_mm256_storeu_pd(p, r);
+#elif (L_SIMD_WIDTH == 2)
+		_mm_storeu_pd(p, r);
+#else
+		*p = r;
+#endif
+	};
+
+	/// Lane-wise square root
+	SimdDouble sqrt() const
+	{
+#if (L_SIMD_WIDTH == 8)
+		return SimdDouble(_mm512_sqrt_pd(r));
+#elif (L_SIMD_WIDTH == 4)
+		return SimdDouble(_mm256_sqrt_pd(r));
+#elif (L_SIMD_WIDTH == 2)
+		return SimdDouble(_mm_sqrt_pd(r));
+#else
+		return SimdDouble(std::sqrt(r));
+#endif
+	};
+
+	// Arithmetic operators
+#if (L_SIMD_WIDTH == 8)
+	SimdDouble operator+(const SimdDouble& b) const { return SimdDouble(_mm512_add_pd(r, b.r)); };
+	SimdDouble operator-(const SimdDouble& b) const { return SimdDouble(_mm512_sub_pd(r, b.r)); };
+	SimdDouble operator*(const SimdDouble& b) const { return SimdDouble(_mm512_mul_pd(r, b.r)); };
+	SimdDouble operator/(const SimdDouble& b) const { return SimdDouble(_mm512_div_pd(r, b.r)); };
+#elif (L_SIMD_WIDTH == 4)
+	SimdDouble operator+(const SimdDouble& b) const { return SimdDouble(_mm256_add_pd(r, b.r)); };
+	SimdDouble operator-(const SimdDouble& b) const { return SimdDouble(_mm256_sub_pd(r, b.r)); };
+	SimdDouble operator*(const SimdDouble& b) const { return SimdDouble(_mm256_mul_pd(r, b.r)); };
+	SimdDouble operator/(const SimdDouble& b) const { return SimdDouble(_mm256_div_pd(r, b.r)); };
+#elif (L_SIMD_WIDTH == 2)
+	SimdDouble operator+(const SimdDouble& b) const { return SimdDouble(_mm_add_pd(r, b.r)); };
+	SimdDouble operator-(const SimdDouble& b) const { return SimdDouble(_mm_sub_pd(r, b.r)); };
+	SimdDouble operator*(const SimdDouble& b) const { return SimdDouble(_mm_mul_pd(r, b.r)); };
+	SimdDouble operator/(const SimdDouble& b) const { return SimdDouble(_mm_div_pd(r, b.r)); };
+#else
+	SimdDouble operator+(const SimdDouble& b) const { return SimdDouble(r + b.r); };
+	SimdDouble operator-(const SimdDouble& b) const { return SimdDouble(r - b.r); };
+	SimdDouble operator*(const SimdDouble& b) const { return SimdDouble(r * b.r); };
+	SimdDouble operator/(const SimdDouble& b) const { return SimdDouble(r / b.r); };
+#endif
+
+};
+
+#endif
@@ -21,7 +21,7 @@
 */
 
 /// LUMA version
-#define LUMA_VERSION "1.7.11"
+#define LUMA_VERSION "1.7.33"
 
 
 // Header guard
@@ -81,9 +81,15 @@
 
 // Using MPI?
 //#define L_BUILD_FOR_MPI				///< Enable MPI features in build
+//#define L_MPI_OVERLAP				///< Update sender layers first and overlap the halo exchange with the update of the interior
+//#define L_MPI_PERSISTENT			///< Use persistent requests bound to fixed per-grid buffers for the halo exchange
+//#define L_MPI_NEIGHBOUR_COLLECTIVES	///< Use a neighbourhood collective on a graph of the communicating ranks for the halo exchange
+//#define L_MPI_ASYNC_SUBCYCLING		///< Sub-cycle the regions of a level together and complete their halo exchanges behind the update of the parent grid
+//#define L_MPI_BENCHMARK 100			///< Time this many halo exchanges on the coarse grid for each available transport at start-up and report to log
 
 // Enable OMP support?
-//#define L_ENABLE_OPENMP				///< Enable OpenMP features (experimental)
+//#define L_ENABLE_OPENMP				///< Enable OpenMP threading of the time step (can be combined with MPI)
+//#define L_OMP_BENCHMARK 20				///< Time the kernel over this many sweeps for increasing thread counts at start-up and report to log
 
 // Output Options
 #define L_GRID_OUT_FREQ 20					///< How many timesteps before whole grid output
@@ -124,6 +130,11 @@
 // LBM configuration
 //#define L_USE_KBC_COLLISION					///< Use KBC collision operator instead of LBGK by default
 //#define L_USE_BGKSMAG
+//#define L_USE_FUSED_KERNEL					///< Stream and collide in a single sweep using a structure-of-arrays population layout
+//#define L_USE_AA_STREAMING					///< Stream in place on a single population array (AA pattern) to halve population storage
+//#define L_USE_SIMD_COLLISION				///< Collide several sites at once using SIMD instructions (widest set enabled by compiler flags e.g. -mavx2)
+//#define L_COLLISION_BENCHMARK 100			///< Time scalar and SIMD collision kernels over this many sweeps at start-up and report to log
+//#define L_USE_SPARSE_LATTICE				///< Only store populations of active (non-solid, non-refined) sites and skip inactive sites in the kernels
 #define L_CSMAG 0.3
 
 /// Compute the time-averaged values of velocity, density and the velocity products.
@@ -153,6 +164,19 @@
 // Decomposition strategy
 #define L_MPI_SMART_DECOMPOSE		///< Use smart decomposition to improve load balancing
 #define L_MPI_SD_MAX_ITER 1600		///< Max number of iterations to be used for smart decomposition algorithm
+//#define L_MPI_COST_MODEL			///< Balance smart decomposition on a per-site cost model rather than the operation count
+//#define L_MPI_COST_MAP_FILE		///< Read the cost map written by a previous run from ./input/cost_map.in
+//#define L_MPI_COST_CALIBRATE		///< Fit the cost weights to the measured step times and use fitted weights from the cost map file
+#define L_COST_FLUID 1.0			///< Cost of a fluid site update
+#define L_COST_SOLID 0.1			///< Cost of a solid or refined site
+#define L_COST_BOUNDARY 1.5			///< Cost of a boundary condition site
+#define L_COST_BFL_LINK 0.2			///< Cost of a BFL link
+#define L_COST_IBM_SUPPORT 0.5		///< Cost of an IBM support site
+
+// Dynamic load balancing
+//#define L_MPI_REBALANCE				///< Rebalance the decomposition at run time when the measured step times drift apart (uses the cost model)
+#define L_MPI_REBALANCE_FREQ 500		///< Frequency (in coarse time steps) at which the step times of the ranks are compared
+#define L_MPI_REBALANCE_THRESHOLD 20.0	///< Measured imbalance (%) above which the domain is rebalanced
 
 // Topology report
 //#define L_MPI_TOPOLOGY_REPORT		///< Have the MPI Manager report on different combinations of X Y Z cores
@@ -218,6 +242,8 @@
 // IBM //
 #define L_IBM_ON						///< Turn on IBM
 //#define L_UNIVERSAL_EPSILON_CALC		///< Do universal epsilon calculation (should be used if supports from different bodies overlap)
+#define L_EPSILON_TOL 1e-12			///< Relative residual at which the sparse epsilon solver stops
+#define L_EPSILON_MAXIT 500				///< Maximum number of iterations of the sparse epsilon solver
 
 // FEM //
 #define L_NB_ALPHA 0.25					///< Parameter for Newmark-Beta time integration (0.25 for 2nd order)
@@ -262,6 +288,15 @@
 #define L_NUM_LEVELS 0		///< Levels of refinement (0 = coarse grid only)
 #define L_NUM_REGIONS 0		///< Number of refined regions (can be arbitrary if L_NUM_LEVELS = 0)
 //#define L_AUTO_SUBGRIDS		///< Activate auto sub-grid generation using the padding parameters below
+//#define L_REFINEMENT_INTERPOLATION	///< Reconstruct populations exploded onto sub-grids linearly across the parent cell instead of copying
+//#define L_ADAPTIVE_REFINEMENT		///< Move, resize, create and delete the level 1 sub-grids at run time to follow the flow
+
+// Adaptive refinement configuration (requires L_AUTO_SUBGRIDS if L_NUM_LEVELS > 1)
+#define L_AMR_FREQ 100					///< Frequency (in coarse time steps) at which the sub-grids are adapted
+#define L_AMR_CRITERION eAmrVorticity	///< Criterion used to tag coarse sites for refinement (see eAmrCriterion)
+#define L_AMR_THRESHOLD 1.0				///< Non-dimensional vorticity / gradient magnitude or distance above (below for distance) which sites are tagged
+#define L_AMR_PADDING 3					///< Number of coarse sites added around the tagged sites on each side of a sub-grid
+#define L_AMR_EFFICIENCY 0.7			///< Fraction of tagged sites in a box below which it is split
 
 // Auto-sub-grid configuration (if you want coincident edges then set to (-2.0 * dh))
 #define L_PADDING_X_MIN (-2.0 * dh)		///< Padding between X start of each sub-grid and its child edge
@@ -336,6 +371,26 @@ const static double cProbeLimsZ[2] = { L_PROBE_MIN_Z, L_PROBE_MAX_Z };	///< Limi
 
 #endif
 
+// KBC collisions are not vectorised
+#ifdef L_USE_KBC_COLLISION
+#undef L_USE_SIMD_COLLISION
+#endif
+
+// Neighbourhood collectives replace the point-to-point requests
+#ifdef L_MPI_NEIGHBOUR_COLLECTIVES
+#undef L_MPI_PERSISTENT
+#endif
+
+// Rebalancing decomposes on the cost model
+#if (defined L_MPI_REBALANCE && !defined L_MPI_COST_MODEL)
+#define L_MPI_COST_MODEL
+#endif
+
+// Binary restart file format
+#define L_RESTART_ID 0x4C554D41		///< Identifier at the start of restart files ("LUMA")
+#define L_RESTART_VERSION 1			///< Version of the restart file format
+#define L_RESTART_HEADER_SIZE 9		///< Number of 64-bit integers in the LBM restart file header
+
 #if L_NUM_LEVELS == 0
 // Set region info to default as no refinement
 static double cRefStartX[1][1] = { 0.0 };
@@ -196,7 +196,10 @@ void hdf5_writeDataSet(hid_t& memspace, hid_t& filespace, hid_t& dataset_id,
 		/* One variable per grid site */
 
 #if (L_DIMS == 3)
-		// Copy data a 2D slice at a time for 3D cases
+		// Copy data a 2D slice at a time for 3D cases (slices are independent)
+#ifdef L_ENABLE_OPENMP
+#pragma omp parallel for private(m_offset, m_block, m_count, m_stride)
+#endif
 		for (i = i_start; i <= i_end; i++)
 #endif
 		{
@@ -236,7 +239,10 @@ void hdf5_writeDataSet(hid_t& memspace, hid_t& filespace, hid_t& dataset_id,
 		/* L_DIMS variables per grid site */
 
 #if (L_DIMS == 3)
-		// Copy data a 2D slice at a time for 3D cases
+		// Copy data a 2D slice at a time for 3D cases (slices are independent)
+#ifdef L_ENABLE_OPENMP
+#pragma omp parallel for private(m_offset, m_block, m_count, m_stride)
+#endif
 		for (int i = i_start; i <= i_end; i++)
 #endif
 		{
@@ -288,7 +294,10 @@ void hdf5_writeDataSet(hid_t& memspace, hid_t& filespace, hid_t& dataset_id,
 
 
 #if (L_DIMS == 3)
-		// Copy data a 2D slice at a time for 3D cases
+		// Copy data a 2D slice at a time for 3D cases (slices are independent)
+#ifdef L_ENABLE_OPENMP
+#pragma omp parallel for private(m_offset, m_block, m_count, m_stride)
+#endif
 		for (int i = i_start; i <= i_end; i++)
 #endif
 		{
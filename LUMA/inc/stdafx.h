@@ -201,6 +201,9 @@ inline void debugfcn(const std::string &msg, std::ofstream *logfile)
 
 // Include definitions, singletons and headers to be made available everywhere for convenience.
 #include "definitions.h"
+#ifdef L_ENABLE_OPENMP
+#include <omp.h>
+#endif
 #include "GridManager.h"
 #include <mpi.h>
 #include "MpiManager.h"
@@ -75,6 +75,7 @@ void BFLBody::initialise()
 		// Label as BFL site
 		_Owner->LatTyp(m.supp_i[0], m.supp_j[0], m.supp_k[0], M_lim, K_lim) = eBFL;
 	}
+	_Owner->LBM_invalidateStreamTables();
 
 	// Close Body //
 	*GridUtils::logfile << "ObjectManagerBFL: Checking surface integrity..." << std::endl;
@@ -697,6 +698,7 @@ void BFLBody::enforceSurfaceClosure()
 									// Add new marker to the end of the array
 									addMarker(av_pos_x, av_pos_y, av_pos_z, static_cast<int>(markers.size()));
 									_Owner->LatTyp(markers.back().supp_i[0], markers.back().supp_j[0], markers.back().supp_k[0], M_lim, K_lim) = eBFL;
+									_Owner->LBM_invalidateStreamTables();
 								}
 
 
@@ -0,0 +1,382 @@
+/*
+* --------------------------------------------------------------
+*
+* ------ Lattice Boltzmann @ The University of Manchester ------
+*
+* -------------------------- L-U-M-A ---------------------------
+*
+* Copyright 2019 The University of Manchester
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.*
+*/
+#include "../inc/stdafx.h"
+#include "../inc/CostModel.h"
+
+// *****************************************************************************
+/// Default constructor.
+CostModel::CostModel()
+{
+	weights.resize(eCostNumFeatures);
+	weights[eCostFluid] = L_COST_FLUID;
+	weights[eCostSolid] = L_COST_SOLID;
+	weights[eCostBoundary] = L_COST_BOUNDARY;
+	weights[eCostBFLLink] = L_COST_BFL_LINK;
+	weights[eCostIBMSupport] = L_COST_IBM_SUPPORT;
+
+	dims[eXDirection] = L_N;
+	dims[eYDirection] = L_M;
+	dims[eZDirection] = L_K;
+}
+
+/// Default destructor.
+CostModel::~CostModel()
+{
+}
+
+// *****************************************************************************
+/// \brief	Estimate the features of each coarse site before the grids exist.
+///
+///			Each coarse site is given the fluid updates of the finest grid 
+///			covering it, refined site updates for the coarser grids above it
+///			and the boundary type of any domain wall it lies in. Bodies are not
+///			known at this stage so a measured map is required to include them.
+void CostModel::buildAnalytic()
+{
+	GridManager *gm = GridManager::getInstance();
+	double dh = L_COARSE_SITE_WIDTH;
+
+	features.assign(static_cast<size_t>(dims[eXDirection]) * dims[eYDirection] * dims[eZDirection] * eCostNumFeatures, 0.0);
+
+	for (int i = 0; i < dims[eXDirection]; ++i)
+	{
+		for (int j = 0; j < dims[eYDirection]; ++j)
+		{
+			for (int k = 0; k < dims[eZDirection]; ++k)
+			{
+				double x = (i + 0.5) * dh;
+				double y = (j + 0.5) * dh;
+				double z = (k + 0.5) * dh;
+
+				// Finest grid covering the site
+				int finest = getFinestLevel(x, y, z);
+
+				// Wall type (later walls override earlier ones as in the grid labelling)
+				eType type = eFluid;
+				if (x <= L_WALL_THICKNESS_LEFT) type = L_WALL_LEFT;
+				if (x >= gm->global_edges[eXMax][0] - L_WALL_THICKNESS_RIGHT) type = L_WALL_RIGHT;
+#if (L_DIMS == 3)
+				if (z <= L_WALL_THICKNESS_FRONT) type = L_WALL_FRONT;
+				if (z >= gm->global_edges[eZMax][0] - L_WALL_THICKNESS_BACK) type = L_WALL_BACK;
+#endif
+				if (y <= L_WALL_THICKNESS_BOTTOM) type = L_WALL_BOTTOM;
+				if (y >= gm->global_edges[eYMax][0] - L_WALL_THICKNESS_TOP) type = L_WALL_TOP;
+
+				// Site updates per coarse time step on each level
+				double *f = &features[(k + dims[eZDirection] * (j + dims[eYDirection] * static_cast<size_t>(i))) * eCostNumFeatures];
+				for (int lev = 0; lev <= finest; ++lev)
+				{
+					double ops = std::pow(2.0, lev * (L_DIMS + 1));
+					if (lev < finest) f[eCostSolid] += ops;
+					else f[getFeature(type)] += ops;
+				}
+			}
+		}
+	}
+
+	updateCosts();
+}
+
+// *****************************************************************************
+/// \brief	Read a cost map.
+///
+///			The file starts with the number of coarse sites in each direction 
+///			followed by the weights and then the features of each site with 
+///			k changing fastest.
+///
+/// \param	filename		path to the file.
+/// \param	bReadWeights	flag to replace the current weights with those in the file.
+/// \return	true if the map was read and matches the coarse grid.
+bool CostModel::read(const std::string &filename, bool bReadWeights)
+{
+	std::ifstream file;
+	file.open(filename.c_str(), std::ios::in);
+	if (!file.is_open()) return false;
+
+	// Check size
+	int fileDims[3];
+	file >> fileDims[eXDirection] >> fileDims[eYDirection] >> fileDims[eZDirection];
+	if (fileDims[eXDirection] != dims[eXDirection] || 
+		fileDims[eYDirection] != dims[eYDirection] || 
+		fileDims[eZDirection] != dims[eZDirection]) return false;
+
+	// Weights
+	std::vector<double> fileWeights(eCostNumFeatures);
+	for (int n = 0; n < eCostNumFeatures; ++n) file >> fileWeights[n];
+
+	// Features
+	features.resize(static_cast<size_t>(dims[eXDirection]) * dims[eYDirection] * dims[eZDirection] * eCostNumFeatures);
+	for (size_t n = 0; n < features.size(); ++n) file >> features[n];
+	if (file.fail()) return false;
+
+	if (bReadWeights) weights = fileWeights;
+	updateCosts();
+
+	return true;
+}
+
+// *****************************************************************************
+/// \brief	Write the cost map in the format expected by read().
+///
+/// \param	filename	path to the file.
+void CostModel::write(const std::string &filename) const
+{
+	std::ofstream file;
+	file.open(filename.c_str(), std::ios::out);
+	file.precision(10);
+
+	file << dims[eXDirection] << "\t" << dims[eYDirection] << "\t" << dims[eZDirection] << std::endl;
+	for (int n = 0; n < eCostNumFeatures; ++n) file << weights[n] << "\t";
+	file << std::endl;
+
+	for (size_t s = 0; s < features.size(); s += eCostNumFeatures)
+	{
+		for (int n = 0; n < eCostNumFeatures; ++n) file << features[s + n] << "\t";
+		file << std::endl;
+	}
+
+	file.close();
+}
+
+// *****************************************************************************
+/// \brief	Build the summed-volume table of site costs.
+///
+///			Allows the cost of any block of coarse sites to be found in 
+///			constant time during the decomposition iterations.
+void CostModel::updateCosts()
+{
+	int N = dims[eXDirection], M = dims[eYDirection], K = dims[eZDirection];
+	_sums.assign(static_cast<size_t>(N + 1) * (M + 1) * (K + 1), 0.0);
+
+	for (int i = 0; i < N; ++i)
+	{
+		for (int j = 0; j < M; ++j)
+		{
+			for (int k = 0; k < K; ++k)
+			{
+				double cost = getSiteCost(i, j, k);
+				_sums[_sumIdx(i + 1, j + 1, k + 1)] = cost
+					+ _sums[_sumIdx(i, j + 1, k + 1)] + _sums[_sumIdx(i + 1, j, k + 1)] + _sums[_sumIdx(i + 1, j + 1, k)]
+					- _sums[_sumIdx(i, j, k + 1)] - _sums[_sumIdx(i, j + 1, k)] - _sums[_sumIdx(i + 1, j, k)]
+					+ _sums[_sumIdx(i, j, k)];
+			}
+		}
+	}
+}
+
+// *****************************************************************************
+/// \brief	Cost of the coarse sites within a block.
+///
+///			Bounds are snapped to the nearest coarse site edges.
+///
+/// \param	bounds	block limits (access using eCartMinMax).
+/// \return	cost of the block.
+double CostModel::getBlockCost(const double *bounds) const
+{
+	double dh = L_COARSE_SITE_WIDTH;
+	int lo[3], hi[3];
+	for (int d = 0; d < 3; ++d)
+	{
+		lo[d] = static_cast<int>(std::round(bounds[2 * d] / dh));
+		hi[d] = static_cast<int>(std::round(bounds[2 * d + 1] / dh));
+		lo[d] = std::min(std::max(lo[d], 0), dims[d]);
+		hi[d] = std::min(std::max(hi[d], lo[d]), dims[d]);
+	}
+#if (L_DIMS == 2)
+	// Z bounds are not set in 2D
+	lo[eZDirection] = 0;
+	hi[eZDirection] = dims[eZDirection];
+#endif
+
+	return _sums[_sumIdx(hi[0], hi[1], hi[2])]
+		- _sums[_sumIdx(lo[0], hi[1], hi[2])] - _sums[_sumIdx(hi[0], lo[1], hi[2])] - _sums[_sumIdx(hi[0], hi[1], lo[2])]
+		+ _sums[_sumIdx(lo[0], lo[1], hi[2])] + _sums[_sumIdx(lo[0], hi[1], lo[2])] + _sums[_sumIdx(hi[0], lo[1], lo[2])]
+		- _sums[_sumIdx(lo[0], lo[1], lo[2])];
+}
+
+// *****************************************************************************
+/// \brief	Cost of a set of features.
+///
+/// \param	siteFeatures	pointer to eCostNumFeatures feature counts.
+/// \return	weighted cost.
+double CostModel::getCost(const double *siteFeatures) const
+{
+	double cost = 0.0;
+	for (int n = 0; n < eCostNumFeatures; ++n) cost += weights[n] * siteFeatures[n];
+	return cost;
+}
+
+// *****************************************************************************
+/// \brief	Check whether the cost sums have been built.
+///
+/// \return	true if costs are available.
+bool CostModel::isBuilt() const
+{
+	return !_sums.empty();
+}
+
+// *****************************************************************************
+/// \brief	Fit the weights to measured times.
+///
+///			Solves the least squares problem relating the features of each rank
+///			to its measured time per coarse step with non-negative weights. The
+///			problem is regularised towards the current weights (scaled to the 
+///			measured times) so features which do not vary between ranks keep 
+///			their current relative cost. Weights are normalised so that the 
+///			fluid weight is unchanged.
+///
+/// \param	rankFeatures	features of each rank (feature fastest).
+/// \param	rankTimes		measured time per coarse step of each rank.
+/// \return	true if the fit succeeded and the weights were updated.
+bool CostModel::fitWeights(const std::vector<double> &rankFeatures, const std::vector<double> &rankTimes)
+{
+	const int F = eCostNumFeatures;
+	size_t numRanks = rankTimes.size();
+
+	// Scale of the current weights which best matches the total time
+	double predicted = 0.0, measured = 0.0;
+	for (size_t r = 0; r < numRanks; ++r)
+	{
+		predicted += getCost(&rankFeatures[r * F]);
+		measured += rankTimes[r];
+	}
+	if (predicted <= 0.0 || measured <= 0.0) return false;
+	double scale = measured / predicted;
+
+	// Normal equations with regularisation towards the scaled weights
+	std::vector<double> A(F * F, 0.0), b(F, 0.0);
+	for (size_t r = 0; r < numRanks; ++r)
+	{
+		for (int m = 0; m < F; ++m)
+		{
+			b[m] += rankFeatures[r * F + m] * rankTimes[r];
+			for (int n = 0; n < F; ++n)
+				A[m * F + n] += rankFeatures[r * F + m] * rankFeatures[r * F + n];
+		}
+	}
+	for (int m = 0; m < F; ++m)
+	{
+		double lambda = (A[m * F + m] > 0.0 ? 0.1 * A[m * F + m] : 1.0);
+		A[m * F + m] += lambda;
+		b[m] += lambda * scale * weights[m];
+	}
+
+	// Projected Gauss-Seidel for non-negative solution
+	std::vector<double> w(F);
+	for (int m = 0; m < F; ++m) w[m] = scale * weights[m];
+	for (int it = 0; it < 500; ++it)
+	{
+		for (int m = 0; m < F; ++m)
+		{
+			double res = b[m];
+			for (int n = 0; n < F; ++n)
+				if (n != m) res -= A[m * F + n] * w[n];
+			w[m] = std::max(0.0, res / A[m * F + m]);
+		}
+	}
+
+	if (w[eCostFluid] <= 0.0) return false;
+
+	// Keep the fluid weight as the reference
+	double norm = weights[eCostFluid] / w[eCostFluid];
+	for (int m = 0; m < F; ++m) weights[m] = w[m] * norm;
+	updateCosts();
+
+	return true;
+}
+
+// *****************************************************************************
+/// \brief	Cost of a single coarse site.
+///
+/// \param	i	x-index of coarse site.
+/// \param	j	y-index of coarse site.
+/// \param	k	z-index of coarse site.
+/// \return	weighted cost of the site.
+double CostModel::getSiteCost(int i, int j, int k) const
+{
+	return getCost(&features[(k + dims[eZDirection] * (j + dims[eYDirection] * static_cast<size_t>(i))) * eCostNumFeatures]);
+}
+
+// *****************************************************************************
+/// \brief	Get the finest grid level covering a position.
+///
+/// \param	x	x-position.
+/// \param	y	y-position.
+/// \param	z	z-position.
+/// \return	finest level of refinement at the position.
+int CostModel::getFinestLevel(double x, double y, double z)
+{
+	GridManager *gm = GridManager::getInstance();
+
+	int finest = 0;
+	for (int lev = 1; lev <= L_NUM_LEVELS; ++lev)
+	{
+		for (int reg = 0; reg < L_NUM_REGIONS; ++reg)
+		{
+			int idx = lev + reg * L_NUM_LEVELS;
+			if (x < gm->global_edges[eXMin][idx] || x > gm->global_edges[eXMax][idx] ||
+				y < gm->global_edges[eYMin][idx] || y > gm->global_edges[eYMax][idx]
+#if (L_DIMS == 3)
+				|| z < gm->global_edges[eZMin][idx] || z > gm->global_edges[eZMax][idx]
+#endif
+				) continue;
+			finest = std::max(finest, lev);
+		}
+	}
+
+	return finest;
+}
+
+// *****************************************************************************
+/// \brief	Get the cost feature associated with a site type.
+///
+/// \param	type	site type.
+/// \return	cost feature.
+eCostFeature CostModel::getFeature(eType type)
+{
+	switch (type)
+	{
+	case eSolid:
+	case eRefined:
+		return eCostSolid;
+
+	case eFluid:
+	case eTransitionToCoarser:
+	case eTransitionToFiner:
+		return eCostFluid;
+
+	default:
+		return eCostBoundary;
+	}
+}
+
+// *****************************************************************************
+/// \brief	Index into the summed-volume table.
+///
+/// \param	i	x-index of table.
+/// \param	j	y-index of table.
+/// \param	k	z-index of table.
+/// \return	flattened index.
+size_t CostModel::_sumIdx(int i, int j, int k) const
+{
+	return k + (dims[eZDirection] + 1) * (j + (dims[eYDirection] + 1) * static_cast<size_t>(i));
+}
@@ -39,6 +39,8 @@ FEMBody::FEMBody () {
 	timeav_FEMIterations = 0.0;
 	timeav_FEMResidual = 0.0;
 	BC_DOFs = 0;
+	bandWidth = 0;
+	bandRows = 0;
 }
 
 // *****************************************************************************
@@ -116,9 +118,15 @@ FEMBody::FEMBody (IBBody *iBody, std::vector<double> &start_position, double len
 	// Compute IBM-FEM conforming parameters
 	computeNodeMapping(nIBMNodes, nFEMNodes);
 
+	// Elements couple the DOFs of two neighbouring nodes
+	bandWidth = DOFsPerElement - 1;
+	bandRows = 3 * bandWidth + 1;
+
 	// Resize the matrices and set to zero
-	M.resize(systemDOFs, std::vector<double>(systemDOFs, 0.0));
-	K.resize(systemDOFs, std::vector<double>(systemDOFs, 0.0));
+	M.resize(bandRows * systemDOFs, 0.0);
+	K.resize(bandRows * systemDOFs, 0.0);
+	ipiv.resize(systemDOFs, 0);
+	Meff_hat.resize(systemDOFs, 0.0);
 	R.resize(systemDOFs, 0.0);
 	F.resize(systemDOFs, 0.0);
 	U.resize(systemDOFs, 0.0);
@@ -184,10 +192,8 @@ void FEMBody::newtonRaphsonIterator () {
 
 	// Set matrices to zero
 	fill(F.begin(), F.end(), 0.0);
-	for (int i = 0; i < systemDOFs; i++) {
-		fill(M[i].begin(), M[i].end(), 0.0);
-		fill(K[i].begin(), K[i].end(), 0.0);
-	}
+	fill(M.begin(), M.end(), 0.0);
+	fill(K.begin(), K.end(), 0.0);
 
 	// Loop through and build global matrices
 	for (size_t el = 0; el < elements.size(); el++) {
@@ -205,8 +211,9 @@ void FEMBody::newtonRaphsonIterator () {
 	// Apply Newmark scheme (using Newmark coefficients)
 	setNewmark();
 
-	// Solve linear system using LAPACK library
-	delU = GridUtils::solveLinearSystem(K, F, BC_DOFs);
+	// Solve banded linear system using LAPACK library
+	delU = F;
+	GridUtils::solveBandedSystem(K, bandWidth, bandWidth, delU, ipiv, BC_DOFs);
 
 	// Add deltaU to U
 	for (int i = 0; i < systemDOFs; i++) {
@@ -271,24 +278,25 @@ void FEMBody::setNewmark () {
 	a3 = 1.0 / (2.0 * L_NB_ALPHA) - 1.0;
 
 	// Calculate effective load vector
-	std::vector<double> Meff_hat(systemDOFs, 0.0);
 	for (int i = 0; i < systemDOFs; i++) {
 		Meff_hat[i] = a0 * (U_n[i] - U[i]) + a2 * Udot[i] + a3 * Udotdot[i];
 	}
 
-	// Multiply with mass matrix to get inertia forces
-	std::vector<double> MF_hat = GridUtils::matrix_multiply(M, Meff_hat);
-
 	// Calculate effective load vector and stiffness matrix
 	for (int i = 0; i < systemDOFs; i++) {
 
+		// Multiply with mass matrix to get inertia forces
+		double MF_hat = 0.0;
+		for (int j = std::max(i - bandWidth, 0); j <= std::min(i + bandWidth, systemDOFs - 1); j++)
+			MF_hat += bandEntry(M, i, j) * Meff_hat[j];
+
 		// Effective load
-		F[i] = R[i] - F[i] + MF_hat[i];
+		F[i] = R[i] - F[i] + MF_hat;
+	}
 
-		// Effective stiffness
-		for (int j = 0; j < systemDOFs; j++) {
-			K[i][j] += a0 * M[i][j];
-		}
+	// Effective stiffness (same band layout so done on the whole storage)
+	for (size_t i = 0; i < K.size(); i++) {
+		K[i] += a0 * M[i];
 	}
 }
 
@@ -319,17 +319,17 @@ void FEMElement::assembleGlobalMat (const std::vector<double> &localVec, std::ve
 ///	\brief	Assemble global matrix from local elemental matrix
 ///
 ///	\param	localMat			elemental matrix
-///	\param	globalMat			global matrix
-void FEMElement::assembleGlobalMat (const std::vector<std::vector<double>> &localMat, std::vector<std::vector<double>> &globalMat) {
+///	\param	globalMat			global matrix (banded storage)
+void FEMElement::assembleGlobalMat (const std::vector<std::vector<double>> &localMat, std::vector<double> &globalMat) {
 
 	// Get rows and cols
 	size_t rows = localMat.size();
 	size_t cols = localMat[0].size();
 
-	// Now loop through and set
+	// Now loop through and add into the band
 	for (size_t i = 0; i < rows; i++) {
 		for (size_t j = 0; j < cols; j++) {
-			globalMat[DOFs[i]][DOFs[j]] += localMat[i][j];
+			fPtr->bandEntry(globalMat, DOFs[i], DOFs[j]) += localMat[i][j];
 		}
 	}
 }
@@ -65,7 +65,7 @@ GridManager::GridManager()
 	* must perform the correct rounding and sizing explicitly. Logic is to round
 	* loose boundaries up and down depending on their position relative to the
 	* discrete voxel centre of the previous grid built. */
-	int idx, idx_parent;
+	int idx;
 	
 	// Loop over every sub-grid
 	for (int reg = 0; reg < L_NUM_REGIONS; ++reg)
@@ -75,156 +75,7 @@ GridManager::GridManager()
 
 		for (int lev = 1; lev <= L_NUM_LEVELS; ++lev)
 		{
-			// Get index of grid in special array
-			idx = lev + reg * L_NUM_LEVELS;
-
-			// Get index of its parent
-			if (lev == 1)
-				idx_parent = 0;			// L1 links back to idx 0 for L0 grid
-			else
-				idx_parent = idx - 1;
-
-			// Set periodic flags to false by default
-			periodic_flags[eXDirection][idx] = false;
-			periodic_flags[eYDirection][idx] = false;
-			periodic_flags[eZDirection][idx] = false;
-
-			/* If using auto sub-grid generation, the padding from the definitions 
-			 * file will be used to define the grid edges. */
-#ifdef L_AUTO_SUBGRIDS
-			if (lev > 1)
-			{
-				// Use padding parameters to specify relative to TL of parent
-				global_edges[eXMin][idx] = global_edges[eXMin][idx_parent] + (2.0 * dh) + std::round(L_PADDING_X_MIN / dh) * dh;
-				global_edges[eXMax][idx] = global_edges[eXMax][idx_parent] - (2.0 * dh) - std::round(L_PADDING_X_MAX / dh) * dh;
-				global_edges[eYMin][idx] = global_edges[eYMin][idx_parent] + (2.0 * dh) + std::round(L_PADDING_Y_MIN / dh) * dh;
-				global_edges[eYMax][idx] = global_edges[eYMax][idx_parent] - (2.0 * dh) - std::round(L_PADDING_Y_MAX / dh) * dh;
-#if (L_DIMS == 3)
-				global_edges[eZMin][idx] = global_edges[eZMin][idx_parent] + (2.0 * dh) + std::round(L_PADDING_Z_MIN / dh) * dh;
-				global_edges[eZMax][idx] = global_edges[eZMax][idx_parent] - (2.0 * dh) - std::round(L_PADDING_Z_MAX / dh) * dh;
-#else
-				global_edges[eZMin][idx] = 0.0;
-				global_edges[eZMax][idx] = 0.0;
-#endif
-
-			}
-			else
-				// Level 1 must be placed based on the user-defined value //
-#endif
-			{
-				// Round definitions file values to voxel resolution on parent level
-				global_edges[eXMin][idx] = std::round(cRefStartX[lev - 1][reg] / dh) * dh;
-				global_edges[eXMax][idx] = std::round(cRefEndX[lev - 1][reg] / dh) * dh;
-				global_edges[eYMin][idx] = std::round(cRefStartY[lev - 1][reg] / dh) * dh;
-				global_edges[eYMax][idx] = std::round(cRefEndY[lev - 1][reg] / dh) * dh;
-				global_edges[eZMin][idx] = std::round(cRefStartZ[lev - 1][reg] / dh) * dh;
-				global_edges[eZMax][idx] = std::round(cRefEndZ[lev - 1][reg] / dh) * dh;
-
-			}
-
-			// Print warnings for grids sizes that are coincident with parent edge
-			if (lev > 0)
-			{
-				// Standard prefix
-				const std::string msg = "Level " + std::to_string(lev) + " Region " + std::to_string(reg);
-
-#ifdef L_INIT_VERBOSE
-				if (abs(global_edges[eXMin][idx] - global_edges[eXMin][idx_parent]) < L_SMALL_NUMBER)
-					L_WARN(msg + " X grid start is coincident with its parent grid!", GridUtils::logfile);
-				if (abs(global_edges[eXMax][idx] - global_edges[eXMax][idx_parent]) < L_SMALL_NUMBER)
-					L_WARN(msg + " X grid end is coincident with its parent grid!", GridUtils::logfile);
-				if (abs(global_edges[eYMin][idx] - global_edges[eYMin][idx_parent]) < L_SMALL_NUMBER)
-					L_WARN(msg + " Y grid start is coincident with its parent grid!", GridUtils::logfile);
-				if (abs(global_edges[eYMax][idx] - global_edges[eYMax][idx_parent]) < L_SMALL_NUMBER)
-					L_WARN(msg + " Y grid end is coincident with its parent grid!", GridUtils::logfile);
-#if (L_DIMS == 3)
-				if (abs(global_edges[eZMin][idx] - global_edges[eZMin][idx_parent]) < L_SMALL_NUMBER)
-					L_WARN(msg + " Z grid start is coincident with its parent grid!", GridUtils::logfile);
-				if (abs(global_edges[eZMax][idx] - global_edges[eZMax][idx_parent]) < L_SMALL_NUMBER)
-					L_WARN(msg + " Z grid end is coincident with its parent grid!", GridUtils::logfile);
-#endif
-#endif
-
-				// Errors if outside				
-				if (global_edges[eXMin][idx] < global_edges[eXMin][idx_parent])
-					L_ERROR(msg + " X grid start is outside its parent grid!", GridUtils::logfile);
-				if (global_edges[eXMax][idx] > global_edges[eXMax][idx_parent])
-					L_ERROR(msg + " X grid end is outside its parent grid!", GridUtils::logfile);
-				if (global_edges[eYMin][idx] < global_edges[eYMin][idx_parent])
-					L_ERROR(msg + " Y grid start is outside its parent grid!", GridUtils::logfile);
-				if (global_edges[eYMax][idx] > global_edges[eYMax][idx_parent])
-					L_ERROR(msg + " Y grid end is outside its parent grid!", GridUtils::logfile);
-#if (L_DIMS == 3)
-				if (global_edges[eZMin][idx] < global_edges[eZMin][idx_parent])
-					L_ERROR(msg + " Z grid start is outside its parent grid!", GridUtils::logfile);
-				if (global_edges[eZMax][idx] > global_edges[eZMax][idx_parent])
-					L_ERROR(msg + " Z grid end is outside its parent grid!", GridUtils::logfile);
-#endif
-			}
-
-
-			// Populate sizes
-			global_size[eXDirection][idx] = static_cast<int>(2.0 * std::round((global_edges[eXMax][idx] - global_edges[eXMin][idx]) / dh));
-			global_size[eYDirection][idx] = static_cast<int>(2.0 * std::round((global_edges[eYMax][idx] - global_edges[eYMin][idx]) / dh));
-#if (L_DIMS == 3)
-			global_size[eZDirection][idx] = static_cast<int>(2.0 * std::round((global_edges[eZMax][idx] - global_edges[eZMin][idx]) / dh));
-#else
-			global_size[eZDirection][idx] = 1;
-#endif
-
-			/* If the start and end edges are the same, assume the user is trying to 
-			 * make the sub-grid periodic so size of sub-grid is just double the 
-			 * parent grid size in that direction and set the edges as the grid edges. */
-			if (global_edges[eXMin][idx] == global_edges[eXMax][idx])
-			{
-				global_size[eXDirection][idx] = global_size[eXDirection][idx_parent] * 2;
-				global_edges[eXMin][idx] = global_edges[eXMin][idx_parent];
-				global_edges[eXMax][idx] = global_edges[eXMax][idx_parent];
-#ifdef L_INIT_VERBOSE
-				L_WARN("Level " + std::to_string(lev) + " Region " + std::to_string(reg) +
-					" X grid assumed to be periodic.", GridUtils::logfile);
-#endif
-				periodic_flags[eXDirection][idx] = true;
-			}
-			else if (global_size[eXDirection][idx] < 0)
-			{
-				L_ERROR("Level " + std::to_string(lev) + " Region " + std::to_string(reg) +
-					" sub-grid has size < 0 in X-direction -- not enough base resolution to support this level!", GridUtils::logfile);
-			}
-
-			if (global_edges[eYMin][idx] == global_edges[eYMax][idx])
-			{
-				global_size[eYDirection][idx] = global_size[eYDirection][idx_parent] * 2;
-				global_edges[eYMin][idx] = global_edges[eYMin][idx_parent];
-				global_edges[eYMax][idx] = global_edges[eYMax][idx_parent];
-#ifdef L_INIT_VERBOSE
-				L_WARN("Level " + std::to_string(lev) + " Region " + std::to_string(reg) +
-					" Y grid assumed to be periodic.", GridUtils::logfile);
-#endif
-				periodic_flags[eYDirection][idx] = true;
-			}
-			else if (global_size[eYDirection][idx] < 0)
-			{
-				L_ERROR("Level " + std::to_string(lev) + " Region " + std::to_string(reg) +
-					" sub-grid has size < 0 in Y-direction -- not enough base resolution to support this level!", GridUtils::logfile);
-			}
-
-			if (global_edges[eZMin][idx] == global_edges[eZMax][idx])
-			{
-				global_size[eZDirection][idx] = global_size[eZDirection][idx_parent] * 2;
-				global_edges[eZMin][idx] = global_edges[eZMin][idx_parent];
-				global_edges[eZMax][idx] = global_edges[eZMax][idx_parent];
-#ifdef L_INIT_VERBOSE
-				L_WARN("Level " + std::to_string(lev) + " Region " + std::to_string(reg) +
-					" Z grid assumed to be periodic.", GridUtils::logfile);
-#endif
-				periodic_flags[eZDirection][idx] = true;
-			}
-			else if (global_size[eZDirection][idx] < 0)
-			{
-				L_ERROR("Level " + std::to_string(lev) + " Region " + std::to_string(reg) +
-					" sub-grid has size < 0 in Z-direction -- not enough base resolution to support this level!", GridUtils::logfile);
-			}
+			setSubGridEdges(lev, reg, dh);
 
 			// Get resolution for next level
 			dh /= 2.0;
@@ -265,6 +116,178 @@ GridManager::GridManager()
 	L_INFO("Approximate number of active cells = " + std::to_string(activeCellCount), GridUtils::logfile);
 }
 
+/// \brief	Compute the edges and size of a sub-grid.
+///
+///			Level 1 grids are placed using the values in the definitions file
+///			and lower levels either the same way or, when using auto sub-grid
+///			generation, relative to their parent. Edges are rounded to the 
+///			voxels of the parent and checked against the parent edges.
+///
+///	\param	lev		level of the sub-grid.
+///	\param	reg		region of the sub-grid.
+///	\param	dh		lattice spacing of the parent grid.
+///	\param	bPlaced	flag to indicate the edges have already been set.
+void GridManager::setSubGridEdges(int lev, int reg, double dh, bool bPlaced)
+{
+	int idx, idx_parent;
+
+	// Get index of grid in special array
+	idx = lev + reg * L_NUM_LEVELS;
+
+	// Get index of its parent
+	if (lev == 1)
+		idx_parent = 0;			// L1 links back to idx 0 for L0 grid
+	else
+		idx_parent = idx - 1;
+
+	// Set periodic flags to false by default
+	periodic_flags[eXDirection][idx] = false;
+	periodic_flags[eYDirection][idx] = false;
+	periodic_flags[eZDirection][idx] = false;
+
+	/* Edges may already have been placed by the caller (e.g. by the adaptive
+	 * refinement) in which case they are only checked and sized here. */
+	if (!bPlaced)
+	{
+		/* If using auto sub-grid generation, the padding from the definitions 
+		 * file will be used to define the grid edges. */
+#ifdef L_AUTO_SUBGRIDS
+		if (lev > 1)
+		{
+			// Use padding parameters to specify relative to TL of parent
+			global_edges[eXMin][idx] = global_edges[eXMin][idx_parent] + (2.0 * dh) + std::round(L_PADDING_X_MIN / dh) * dh;
+			global_edges[eXMax][idx] = global_edges[eXMax][idx_parent] - (2.0 * dh) - std::round(L_PADDING_X_MAX / dh) * dh;
+			global_edges[eYMin][idx] = global_edges[eYMin][idx_parent] + (2.0 * dh) + std::round(L_PADDING_Y_MIN / dh) * dh;
+			global_edges[eYMax][idx] = global_edges[eYMax][idx_parent] - (2.0 * dh) - std::round(L_PADDING_Y_MAX / dh) * dh;
+#if (L_DIMS == 3)
+			global_edges[eZMin][idx] = global_edges[eZMin][idx_parent] + (2.0 * dh) + std::round(L_PADDING_Z_MIN / dh) * dh;
+			global_edges[eZMax][idx] = global_edges[eZMax][idx_parent] - (2.0 * dh) - std::round(L_PADDING_Z_MAX / dh) * dh;
+#else
+			global_edges[eZMin][idx] = 0.0;
+			global_edges[eZMax][idx] = 0.0;
+#endif
+
+		}
+		else
+			// Level 1 must be placed based on the user-defined value //
+#endif
+		{
+			// Round definitions file values to voxel resolution on parent level
+			global_edges[eXMin][idx] = std::round(cRefStartX[lev - 1][reg] / dh) * dh;
+			global_edges[eXMax][idx] = std::round(cRefEndX[lev - 1][reg] / dh) * dh;
+			global_edges[eYMin][idx] = std::round(cRefStartY[lev - 1][reg] / dh) * dh;
+			global_edges[eYMax][idx] = std::round(cRefEndY[lev - 1][reg] / dh) * dh;
+			global_edges[eZMin][idx] = std::round(cRefStartZ[lev - 1][reg] / dh) * dh;
+			global_edges[eZMax][idx] = std::round(cRefEndZ[lev - 1][reg] / dh) * dh;
+
+		}
+	}
+
+	// Print warnings for grids sizes that are coincident with parent edge
+	if (lev > 0)
+	{
+		// Standard prefix
+		const std::string msg = "Level " + std::to_string(lev) + " Region " + std::to_string(reg);
+
+#ifdef L_INIT_VERBOSE
+		if (abs(global_edges[eXMin][idx] - global_edges[eXMin][idx_parent]) < L_SMALL_NUMBER)
+			L_WARN(msg + " X grid start is coincident with its parent grid!", GridUtils::logfile);
+		if (abs(global_edges[eXMax][idx] - global_edges[eXMax][idx_parent]) < L_SMALL_NUMBER)
+			L_WARN(msg + " X grid end is coincident with its parent grid!", GridUtils::logfile);
+		if (abs(global_edges[eYMin][idx] - global_edges[eYMin][idx_parent]) < L_SMALL_NUMBER)
+			L_WARN(msg + " Y grid start is coincident with its parent grid!", GridUtils::logfile);
+		if (abs(global_edges[eYMax][idx] - global_edges[eYMax][idx_parent]) < L_SMALL_NUMBER)
+			L_WARN(msg + " Y grid end is coincident with its parent grid!", GridUtils::logfile);
+#if (L_DIMS == 3)
+		if (abs(global_edges[eZMin][idx] - global_edges[eZMin][idx_parent]) < L_SMALL_NUMBER)
+			L_WARN(msg + " Z grid start is coincident with its parent grid!", GridUtils::logfile);
+		if (abs(global_edges[eZMax][idx] - global_edges[eZMax][idx_parent]) < L_SMALL_NUMBER)
+			L_WARN(msg + " Z grid end is coincident with its parent grid!", GridUtils::logfile);
+#endif
+#endif
+
+		// Errors if outside				
+		if (global_edges[eXMin][idx] < global_edges[eXMin][idx_parent])
+			L_ERROR(msg + " X grid start is outside its parent grid!", GridUtils::logfile);
+		if (global_edges[eXMax][idx] > global_edges[eXMax][idx_parent])
+			L_ERROR(msg + " X grid end is outside its parent grid!", GridUtils::logfile);
+		if (global_edges[eYMin][idx] < global_edges[eYMin][idx_parent])
+			L_ERROR(msg + " Y grid start is outside its parent grid!", GridUtils::logfile);
+		if (global_edges[eYMax][idx] > global_edges[eYMax][idx_parent])
+			L_ERROR(msg + " Y grid end is outside its parent grid!", GridUtils::logfile);
+#if (L_DIMS == 3)
+		if (global_edges[eZMin][idx] < global_edges[eZMin][idx_parent])
+			L_ERROR(msg + " Z grid start is outside its parent grid!", GridUtils::logfile);
+		if (global_edges[eZMax][idx] > global_edges[eZMax][idx_parent])
+			L_ERROR(msg + " Z grid end is outside its parent grid!", GridUtils::logfile);
+#endif
+	}
+
+
+	// Populate sizes
+	global_size[eXDirection][idx] = static_cast<int>(2.0 * std::round((global_edges[eXMax][idx] - global_edges[eXMin][idx]) / dh));
+	global_size[eYDirection][idx] = static_cast<int>(2.0 * std::round((global_edges[eYMax][idx] - global_edges[eYMin][idx]) / dh));
+#if (L_DIMS == 3)
+	global_size[eZDirection][idx] = static_cast<int>(2.0 * std::round((global_edges[eZMax][idx] - global_edges[eZMin][idx]) / dh));
+#else
+	global_size[eZDirection][idx] = 1;
+#endif
+
+	/* If the start and end edges are the same, assume the user is trying to 
+	 * make the sub-grid periodic so size of sub-grid is just double the 
+	 * parent grid size in that direction and set the edges as the grid edges. */
+	if (global_edges[eXMin][idx] == global_edges[eXMax][idx])
+	{
+		global_size[eXDirection][idx] = global_size[eXDirection][idx_parent] * 2;
+		global_edges[eXMin][idx] = global_edges[eXMin][idx_parent];
+		global_edges[eXMax][idx] = global_edges[eXMax][idx_parent];
+#ifdef L_INIT_VERBOSE
+		L_WARN("Level " + std::to_string(lev) + " Region " + std::to_string(reg) +
+			" X grid assumed to be periodic.", GridUtils::logfile);
+#endif
+		periodic_flags[eXDirection][idx] = true;
+	}
+	else if (global_size[eXDirection][idx] < 0)
+	{
+		L_ERROR("Level " + std::to_string(lev) + " Region " + std::to_string(reg) +
+			" sub-grid has size < 0 in X-direction -- not enough base resolution to support this level!", GridUtils::logfile);
+	}
+
+	if (global_edges[eYMin][idx] == global_edges[eYMax][idx])
+	{
+		global_size[eYDirection][idx] = global_size[eYDirection][idx_parent] * 2;
+		global_edges[eYMin][idx] = global_edges[eYMin][idx_parent];
+		global_edges[eYMax][idx] = global_edges[eYMax][idx_parent];
+#ifdef L_INIT_VERBOSE
+		L_WARN("Level " + std::to_string(lev) + " Region " + std::to_string(reg) +
+			" Y grid assumed to be periodic.", GridUtils::logfile);
+#endif
+		periodic_flags[eYDirection][idx] = true;
+	}
+	else if (global_size[eYDirection][idx] < 0)
+	{
+		L_ERROR("Level " + std::to_string(lev) + " Region " + std::to_string(reg) +
+			" sub-grid has size < 0 in Y-direction -- not enough base resolution to support this level!", GridUtils::logfile);
+	}
+
+	if (global_edges[eZMin][idx] == global_edges[eZMax][idx])
+	{
+		global_size[eZDirection][idx] = global_size[eZDirection][idx_parent] * 2;
+		global_edges[eZMin][idx] = global_edges[eZMin][idx_parent];
+		global_edges[eZMax][idx] = global_edges[eZMax][idx_parent];
+#ifdef L_INIT_VERBOSE
+		L_WARN("Level " + std::to_string(lev) + " Region " + std::to_string(reg) +
+			" Z grid assumed to be periodic.", GridUtils::logfile);
+#endif
+		periodic_flags[eZDirection][idx] = true;
+	}
+	else if (global_size[eZDirection][idx] < 0)
+	{
+		L_ERROR("Level " + std::to_string(lev) + " Region " + std::to_string(reg) +
+			" sub-grid has size < 0 in Z-direction -- not enough base resolution to support this level!", GridUtils::logfile);
+	}
+}
+
 /// Default destructor
 GridManager::~GridManager()
 {
@@ -297,7 +297,7 @@ void GridObj::LBM_initGrid() {
 		force_xyz[L_GRAVITY_DIRECTION + id * L_DIMS] = rho[id] * gravity * refinement_ratio;
 
 	// Lattice force vector
-	force_i.resize(N_lim * M_lim * K_lim * L_NUM_VELS, 0.0);
+	force_i.resize(N_lim * M_lim * K_lim * L_NUM_VELS);
 #endif
 
 	// Time averaged quantities
@@ -307,12 +307,22 @@ void GridObj::LBM_initGrid() {
 
 
 	// Initialise L0 POPULATION matrices (f, feq)
+#ifdef L_USE_SPARSE_LATTICE
+	_LBM_initSparseStorage();
+#endif
 	f.resize(N_lim * M_lim * K_lim * L_NUM_VELS);
+#if (defined L_USE_KBC_COLLISION || defined L_TEXTOUT)
 	feq.resize(N_lim * M_lim * K_lim * L_NUM_VELS);
+#endif
+#ifndef L_USE_AA_STREAMING
 	fNew.resize(N_lim * M_lim * K_lim * L_NUM_VELS);
+#endif
 
 
-	// Loop over grid
+	// Loop over grid (in parallel so each page is first touched by the thread which updates it)
+#ifdef L_ENABLE_OPENMP
+#pragma omp parallel for
+#endif
 	for (int i = 0; i < N_lim; i++)
 	{
 		for (int j = 0; j < M_lim; j++)
@@ -322,15 +332,21 @@ void GridObj::LBM_initGrid() {
 				for (int v = 0; v < L_NUM_VELS; v++)
 				{
 					// Initialise f to feq
-					f(i, j, k, v, M_lim, K_lim, L_NUM_VELS) = 
+					f[fIdx(i, j, k, v)] = 
 						_LBM_equilibrium_opt(k + j * K_lim + i * M_lim * K_lim, v);
-
+#if (defined L_USE_KBC_COLLISION || defined L_TEXTOUT)
+					feq[fIdx(i, j, k, v)] = f[fIdx(i, j, k, v)];
+#endif
+#ifndef L_USE_AA_STREAMING
+					fNew[fIdx(i, j, k, v)] = f[fIdx(i, j, k, v)];
+#endif
+#if (defined L_GRAVITY_ON || defined L_IBM_ON)
+					force_i[fIdx(i, j, k, v)] = 0.0;
+#endif
 				}
 			}
 		}
 	}
-	feq = f; // Make feq = feq too
-	fNew = f;
 
 
 #ifdef L_NU
@@ -483,7 +499,7 @@ void GridObj::LBM_initSubGrid (GridObj& pGrid)
 		force_xyz[L_GRAVITY_DIRECTION + id * L_DIMS] = rho[id] * gravity * refinement_ratio;
 
 	// Lattice force vector
-	force_i.resize(N_lim * M_lim * K_lim * L_NUM_VELS, 0.0);
+	force_i.resize(N_lim * M_lim * K_lim * L_NUM_VELS);
 
 #endif
 
@@ -497,31 +513,46 @@ void GridObj::LBM_initSubGrid (GridObj& pGrid)
 
 	// Generate POPULATION MATRICES for lower levels
 	// Resize
+#ifdef L_USE_SPARSE_LATTICE
+	_LBM_initSparseStorage();
+#endif
 	f.resize(N_lim * M_lim * K_lim * L_NUM_VELS);
+#if (defined L_USE_KBC_COLLISION || defined L_TEXTOUT)
 	feq.resize(N_lim * M_lim * K_lim * L_NUM_VELS);
+#endif
+#ifndef L_USE_AA_STREAMING
 	fNew.resize(N_lim * M_lim * K_lim * L_NUM_VELS);
+#endif
 
 
-	// Loop over grid
-	for (int i = 0; i < N_lim; ++i)
+	// Loop over grid (in parallel so each page is first touched by the thread which updates it)
+#ifdef L_ENABLE_OPENMP
+#pragma omp parallel for
+#endif
+	for (int i = 0; i < N_lim; i++)
 	{
-		for (int j = 0; j < M_lim; ++j)
+		for (int j = 0; j < M_lim; j++)
 		{
-			for (int k = 0; k < K_lim; ++k)
+			for (int k = 0; k < K_lim; k++)
 			{
 				for (int v = 0; v < L_NUM_VELS; v++)
 				{
-					
 					// Initialise f to feq
-					f(i, j, k, v, M_lim, K_lim, L_NUM_VELS) = 
+					f[fIdx(i, j, k, v)] = 
 						_LBM_equilibrium_opt(k + j * K_lim + i * M_lim * K_lim, v);
-
+#if (defined L_USE_KBC_COLLISION || defined L_TEXTOUT)
+					feq[fIdx(i, j, k, v)] = f[fIdx(i, j, k, v)];
+#endif
+#ifndef L_USE_AA_STREAMING
+					fNew[fIdx(i, j, k, v)] = f[fIdx(i, j, k, v)];
+#endif
+#if (defined L_GRAVITY_ON || defined L_IBM_ON)
+					force_i[fIdx(i, j, k, v)] = 0.0;
+#endif
 				}
 			}
 		}
 	}
-	feq = f; // Set feq to feq
-	fNew = f;
 
 	// Compute relaxation time from coarser level assume refinement by factor of 2
 	omega = 1.0 / ( ( (1.0 / pGrid.omega - 0.5) * 2.0) + 0.5);
@@ -879,6 +910,34 @@ void GridObj::LBM_initGridToGridMappings(GridObj& pGrid)
 	if (dir != "")
 		L_ERROR("Refined region wraps periodically in " + dir + "-direction but is not connected which is not supported. Exiting.", GridUtils::logfile);
 
+	/* Flatten the mappings into per-direction index arrays so that explosion 
+	 * and coalescence do not need to recompute the indices on every link. The
+	 * refinement ratio of 2 means each parent index covers two indices here. */
+	int *coarseLims[3] = { CoarseLimsX, CoarseLimsY, CoarseLimsZ };
+	std::vector<int> *coarseIdx[3] = { &CoarseIdxX, &CoarseIdxY, &CoarseIdxZ };
+	std::vector<int> *fineIdx[3] = { &FineIdxX, &FineIdxY, &FineIdxZ };
+	int parentSize[3] = { pGrid.N_lim, pGrid.M_lim, pGrid.K_lim };
+	for (int d = 0; d < 3; ++d)
+	{
+		// Number of indices on this grid in this direction
+		int nFine = (d < L_DIMS) ? 2 * (coarseLims[d][eMaximum] - coarseLims[d][eMinimum] + 1) : 1;
+		int nCoarse = parentSize[d];
+		int ratio = (d < L_DIMS) ? 2 : 1;
+
+		// Fine to coarse
+		coarseIdx[d]->resize(nFine);
+		for (int fi = 0; fi < nFine; ++fi)
+			(*coarseIdx[d])[fi] = fi / ratio + coarseLims[d][eMinimum];
+
+		// Coarse to fine
+		fineIdx[d]->assign(nCoarse, -1);
+		for (int ci = 0; ci < nCoarse; ++ci)
+		{
+			int fi = ratio * (ci - coarseLims[d][eMinimum]);
+			if (fi >= 0 && fi < nFine) (*fineIdx[d])[ci] = fi;
+		}
+	}
+
 #ifdef L_INIT_VERBOSE
 	*GridUtils::logfile << "Local Coarse Lims are " <<
 		CoarseLimsX[eMinimum] << "-" << CoarseLimsX[eMaximum] << ", " <<
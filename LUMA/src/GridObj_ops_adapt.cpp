@@ -0,0 +1,967 @@
+/*
+* --------------------------------------------------------------
+*
+* ------ Lattice Boltzmann @ The University of Manchester ------
+*
+* -------------------------- L-U-M-A ---------------------------
+*
+* Copyright 2019 The University of Manchester
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.*
+*/
+
+/* This file contains the methods which adapt the sub-grids to the flow at run
+ * time. Coarse sites are tagged using the flow on the finest grid covering
+ * them, the tags are clustered into at most L_NUM_REGIONS boxes and the level
+ * 1 sub-grids (and those beneath them) are rebuilt if the boxes have changed. */
+
+#include "../inc/stdafx.h"
+#include "../inc/GridObj.h"
+#include "../inc/ObjectManager.h"
+
+#ifdef L_ADAPTIVE_REFINEMENT
+
+// Number of values making up the state of a site
+#ifdef L_COMPUTE_TIME_AVERAGED_QUANTITIES
+static const int _nState = 2 * L_NUM_VELS + 1 + L_DIMS + 1 + L_DIMS + (3 * L_DIMS - 3);
+#else
+static const int _nState = 2 * L_NUM_VELS + 1 + L_DIMS;
+#endif
+
+// ****************************************************************************
+/// \brief	Number of sites in a box.
+///
+///			Boxes are stored as six indices on L0 ordered as eCartMinMax with
+///			the maximum indices being one past the last site in the box.
+///
+/// \param	box		indices of the box.
+/// \return	number of sites in the box.
+static long _boxVolume(const int *box)
+{
+	return static_cast<long>(box[eXMax] - box[eXMin]) *
+		(box[eYMax] - box[eYMin]) * (box[eZMax] - box[eZMin]);
+}
+
+// ****************************************************************************
+/// \brief	Number of sites shared by two boxes.
+/// \param	boxA	indices of the first box.
+/// \param	boxB	indices of the second box.
+/// \return	number of sites in the intersection of the boxes.
+static long _boxOverlap(const int *boxA, const int *boxB)
+{
+	long overlap = 1;
+	for (int d = 0; d < L_DIMS; ++d)
+	{
+		int len = std::min(boxA[2 * d + 1], boxB[2 * d + 1]) - std::max(boxA[2 * d], boxB[2 * d]);
+		if (len <= 0) return 0;
+		overlap *= len;
+	}
+	return overlap;
+}
+
+// ****************************************************************************
+/// \brief	Shrink a box to the tagged sites it contains.
+/// \param	tags	tag of each site on L0.
+/// \param	size	global size of L0.
+/// \param	box		indices of the box (updated).
+/// \return	number of tagged sites in the box.
+static long _shrinkToTags(const std::vector<unsigned char> &tags, const int *size, int *box)
+{
+	int lo[3] = { box[eXMax], box[eYMax], box[eZMax] };
+	int hi[3] = { box[eXMin] - 1, box[eYMin] - 1, box[eZMin] - 1 };
+	long count = 0;
+
+	for (int i = box[eXMin]; i < box[eXMax]; ++i)
+	{
+		for (int j = box[eYMin]; j < box[eYMax]; ++j)
+		{
+			for (int k = box[eZMin]; k < box[eZMax]; ++k)
+			{
+				if (!tags[k + size[2] * (j + size[1] * i)]) continue;
+				++count;
+				lo[0] = std::min(lo[0], i); hi[0] = std::max(hi[0], i);
+				lo[1] = std::min(lo[1], j); hi[1] = std::max(hi[1], j);
+				lo[2] = std::min(lo[2], k); hi[2] = std::max(hi[2], k);
+			}
+		}
+	}
+
+	if (count)
+	{
+		for (int d = 0; d < 3; ++d)
+		{
+			box[2 * d] = lo[d];
+			box[2 * d + 1] = hi[d] + 1;
+		}
+	}
+	return count;
+}
+
+// ****************************************************************************
+/// \brief	Split a box in two using the signatures of its tags.
+///
+///			Following Berger & Rigoutsos (1991), the box is cut at a hole in
+///			the number of tags in each plane (the signature) nearest the middle
+///			of the box. Without a hole it is cut at the strongest inflection of
+///			the Laplacian of the signature and failing that the longest side is
+///			bisected.
+///
+/// \param	tags	tag of each site on L0.
+/// \param	size	global size of L0.
+/// \param	box		indices of the box to split.
+/// \param	boxA	indices of the lower half.
+/// \param	boxB	indices of the upper half.
+/// \return	false if the box cannot be split.
+static bool _splitBox(const std::vector<unsigned char> &tags, const int *size,
+	const int *box, int *boxA, int *boxB)
+{
+	int len[3] = { box[eXMax] - box[eXMin], box[eYMax] - box[eYMin], box[eZMax] - box[eZMin] };
+	int dir = -1, cut = -1;
+
+	// Signatures in each direction
+	std::vector<long> sig[3];
+	for (int d = 0; d < 3; ++d) sig[d].assign(len[d], 0);
+	for (int i = box[eXMin]; i < box[eXMax]; ++i)
+	{
+		for (int j = box[eYMin]; j < box[eYMax]; ++j)
+		{
+			for (int k = box[eZMin]; k < box[eZMax]; ++k)
+			{
+				if (!tags[k + size[2] * (j + size[1] * i)]) continue;
+				++sig[0][i - box[eXMin]];
+				++sig[1][j - box[eYMin]];
+				++sig[2][k - box[eZMin]];
+			}
+		}
+	}
+
+	// Hole nearest the middle of the box
+	int bestDistance = -1;
+	for (int d = 0; d < L_DIMS; ++d)
+	{
+		for (int p = 1; p < len[d] - 1; ++p)
+		{
+			int distance = len[d] - std::abs(2 * p - len[d]);
+			if (sig[d][p] == 0 && distance > bestDistance)
+			{
+				bestDistance = distance;
+				dir = d;
+				cut = p;
+			}
+		}
+	}
+
+	// Strongest inflection of the Laplacian
+	if (dir < 0)
+	{
+		long bestStrength = 0;
+		for (int d = 0; d < L_DIMS; ++d)
+		{
+			for (int p = 1; p < len[d] - 2; ++p)
+			{
+				long lap = sig[d][p - 1] - 2 * sig[d][p] + sig[d][p + 1];
+				long lapNext = sig[d][p] - 2 * sig[d][p + 1] + sig[d][p + 2];
+				if ((lap < 0) == (lapNext < 0) || lap == 0 || lapNext == 0) continue;
+				if (std::abs(lapNext - lap) > bestStrength)
+				{
+					bestStrength = std::abs(lapNext - lap);
+					dir = d;
+					cut = p + 1;
+				}
+			}
+		}
+	}
+
+	// Bisect the longest side
+	if (dir < 0)
+	{
+		dir = 0;
+		for (int d = 1; d < L_DIMS; ++d)
+		{
+			if (len[d] > len[dir]) dir = d;
+		}
+		if (len[dir] < 2) return false;
+		cut = len[dir] / 2;
+	}
+
+	std::copy(box, box + 6, boxA);
+	std::copy(box, box + 6, boxB);
+	boxA[2 * dir + 1] = box[2 * dir] + cut;
+	boxB[2 * dir] = box[2 * dir] + cut;
+	return true;
+}
+
+// ****************************************************************************
+/// \brief	Cluster the tagged sites into boxes.
+///
+///			Starting from the box bounding all the tags, the least efficient box
+///			(fraction of its sites which are tagged) is split until there are
+///			L_NUM_REGIONS boxes or all boxes are at least L_AMR_EFFICIENCY.
+///
+/// \param	tags	tag of each site on L0.
+/// \param	size	global size of L0.
+/// \param	boxes	indices of the boxes tightly bounding the tags.
+static void _clusterTags(const std::vector<unsigned char> &tags, const int *size, std::vector<int> &boxes)
+{
+	std::vector<long> counts;
+	std::vector<bool> bFinal;
+	int box[6] = { 0, size[0], 0, size[1], 0, size[2] };
+
+	boxes.clear();
+	long count = _shrinkToTags(tags, size, box);
+	if (count == 0) return;
+	boxes.insert(boxes.end(), box, box + 6);
+	counts.push_back(count);
+	bFinal.push_back(false);
+
+	while (static_cast<int>(counts.size()) < L_NUM_REGIONS)
+	{
+		// Find the least efficient box
+		int worst = -1;
+		double worstEfficiency = L_AMR_EFFICIENCY;
+		for (size_t b = 0; b < counts.size(); ++b)
+		{
+			double efficiency = static_cast<double>(counts[b]) / _boxVolume(&boxes[6 * b]);
+			if (!bFinal[b] && efficiency < worstEfficiency)
+			{
+				worstEfficiency = efficiency;
+				worst = static_cast<int>(b);
+			}
+		}
+		if (worst < 0) break;
+
+		// Split it and shrink the halves to their tags
+		int boxA[6], boxB[6];
+		if (!_splitBox(tags, size, &boxes[6 * worst], boxA, boxB))
+		{
+			bFinal[worst] = true;
+			continue;
+		}
+		long countA = _shrinkToTags(tags, size, boxA);
+		long countB = _shrinkToTags(tags, size, boxB);
+		if (countA == 0 || countB == 0)
+		{
+			bFinal[worst] = true;
+			continue;
+		}
+		std::copy(boxA, boxA + 6, boxes.begin() + 6 * worst);
+		counts[worst] = countA;
+		boxes.insert(boxes.end(), boxB, boxB + 6);
+		counts.push_back(countB);
+		bFinal.push_back(false);
+	}
+}
+
+// ****************************************************************************
+/// \brief	Pad the boxes and merge any which overlap or touch.
+///
+///			Boxes are padded by L_AMR_PADDING sites and kept one site inside
+///			L0. Boxes closer than one site are merged so that the transition
+///			layers of neighbouring sub-grids never meet.
+///
+/// \param	boxes		indices of the boxes (padded on return).
+/// \param	tagBoxes	indices of the boxes bounding the tags of each padded box.
+/// \param	size		global size of L0.
+static void _padBoxes(std::vector<int> &boxes, std::vector<int> &tagBoxes, const int *size)
+{
+	tagBoxes = boxes;
+	for (size_t b = 0; b < boxes.size(); b += 6)
+	{
+		for (int d = 0; d < L_DIMS; ++d)
+		{
+			boxes[b + 2 * d] = std::max(boxes[b + 2 * d] - L_AMR_PADDING, 1);
+			boxes[b + 2 * d + 1] = std::min(boxes[b + 2 * d + 1] + L_AMR_PADDING, size[d] - 1);
+		}
+	}
+
+	bool bMerged = true;
+	while (bMerged)
+	{
+		bMerged = false;
+		for (size_t a = 0; a < boxes.size() && !bMerged; a += 6)
+		{
+			for (size_t b = a + 6; b < boxes.size() && !bMerged; b += 6)
+			{
+				bool bSeparate = false;
+				for (int d = 0; d < L_DIMS; ++d)
+				{
+					if (boxes[a + 2 * d + 1] + 1 <= boxes[b + 2 * d] ||
+						boxes[b + 2 * d + 1] + 1 <= boxes[a + 2 * d])
+						bSeparate = true;
+				}
+				if (bSeparate) continue;
+
+				// Replace the first with the union of the two
+				for (int d = 0; d < 3; ++d)
+				{
+					boxes[a + 2 * d] = std::min(boxes[a + 2 * d], boxes[b + 2 * d]);
+					boxes[a + 2 * d + 1] = std::max(boxes[a + 2 * d + 1], boxes[b + 2 * d + 1]);
+					tagBoxes[a + 2 * d] = std::min(tagBoxes[a + 2 * d], tagBoxes[b + 2 * d]);
+					tagBoxes[a + 2 * d + 1] = std::max(tagBoxes[a + 2 * d + 1], tagBoxes[b + 2 * d + 1]);
+				}
+				boxes.erase(boxes.begin() + b, boxes.begin() + b + 6);
+				tagBoxes.erase(tagBoxes.begin() + b, tagBoxes.begin() + b + 6);
+				bMerged = true;
+			}
+		}
+	}
+}
+
+// ****************************************************************************
+/// \brief	Adapt the sub-grids to the flow.
+///
+///			Must be called on L0 by all ranks. Coarse sites are tagged by
+///			L_AMR_CRITERION using the flow on the finest grid covering them and
+///			the tags clustered into at most L_NUM_REGIONS padded boxes. Each box
+///			is assigned to the level 1 region it overlaps most; regions without
+///			a box are deleted and a region keeps its current box while this
+///			still covers its tags comfortably to avoid regridding every time.
+///			Lower levels are placed relative to level 1 using the auto sub-grid
+///			padding. Sites on the new grids take their state from the old grid
+///			on the same level where one existed and from their parent otherwise.
+///			Coarse sites which are no longer refined take the average of the
+///			sites which covered them.
+///
+/// \return	true if the sub-grids were changed.
+bool GridObj::LBM_adaptSubGrids()
+{
+	GridManager *gm = GridManager::getInstance();
+	ObjectManager *objMan = ObjectManager::getInstance();
+#ifdef L_BUILD_FOR_MPI
+	MpiManager *mpim = MpiManager::getInstance();
+#endif
+
+	// Bodies which label sites on a sub-grid cannot be moved to another grid
+	int bLabelledBodies = 0;
+	for (int lev : objMan->bbbOnGridLevel)
+	{
+		if (lev > 0) bLabelledBodies = 1;
+	}
+	for (BFLBody &body : objMan->pBody)
+	{
+		if (body._Owner->level > 0) bLabelledBodies = 1;
+	}
+#ifdef L_BUILD_FOR_MPI
+	MPI_Allreduce(MPI_IN_PLACE, &bLabelledBodies, 1, MPI_INT, MPI_MAX, mpim->world_comm);
+#endif
+	if (bLabelledBodies)
+	{
+		L_WARN("Bounce-back and BFL bodies on sub-grids cannot be adapted -- sub-grids left unchanged.", GridUtils::logfile);
+		return false;
+	}
+
+	// Tag the coarse sites
+	int size[3] = { gm->global_size[eXDirection][0], gm->global_size[eYDirection][0], gm->global_size[eZDirection][0] };
+	std::vector<unsigned char> tags(static_cast<size_t>(size[0]) * size[1] * size[2], 0);
+	_LBM_restrictMacros();
+	_LBM_tagSites(tags, size);
+
+	// Cluster the tags into padded boxes
+	std::vector<int> boxes, tagBoxes;
+	_clusterTags(tags, size, boxes);
+	_padBoxes(boxes, tagBoxes, size);
+	int nBoxes = static_cast<int>(boxes.size() / 6);
+
+	// Current level 1 boxes
+	std::vector<int> oldBoxes(6 * L_NUM_REGIONS, 0);
+	std::vector<bool> bWasActive(L_NUM_REGIONS);
+	for (int reg = 0; reg < L_NUM_REGIONS; ++reg)
+	{
+		int idx = 1 + reg * L_NUM_LEVELS;
+		bWasActive[reg] = (gm->global_size[eXDirection][idx] > 0);
+		for (int e = 0; e < 6; ++e)
+			oldBoxes[e + 6 * reg] = static_cast<int>(std::round(gm->global_edges[e][idx] / dh));
+	}
+
+	// Assign boxes to the regions they overlap most then the rest to free regions
+	std::vector<int> boxOfReg(L_NUM_REGIONS, -1), regOfBox(nBoxes, -1);
+	while (true)
+	{
+		long best = 0;
+		int bestBox = -1, bestReg = -1;
+		for (int b = 0; b < nBoxes; ++b)
+		{
+			if (regOfBox[b] >= 0) continue;
+			for (int reg = 0; reg < L_NUM_REGIONS; ++reg)
+			{
+				if (boxOfReg[reg] >= 0 || !bWasActive[reg]) continue;
+				long overlap = _boxOverlap(&boxes[6 * b], &oldBoxes[6 * reg]);
+				if (overlap > best)
+				{
+					best = overlap;
+					bestBox = b;
+					bestReg = reg;
+				}
+			}
+		}
+		if (bestBox < 0) break;
+		regOfBox[bestBox] = bestReg;
+		boxOfReg[bestReg] = bestBox;
+	}
+	for (int b = 0; b < nBoxes; ++b)
+	{
+		if (regOfBox[b] >= 0) continue;
+		int freeReg = -1;
+		for (int reg = L_NUM_REGIONS - 1; reg >= 0; --reg)
+		{
+			if (boxOfReg[reg] < 0 && (freeReg < 0 || !bWasActive[reg])) freeReg = reg;
+		}
+		regOfBox[b] = freeReg;
+		boxOfReg[freeReg] = b;
+	}
+
+	// New box of each region keeping the current one if it still fits the tags
+	std::vector<int> newBoxes(6 * L_NUM_REGIONS, 0);
+	bool bChanged = false;
+	for (int reg = 0; reg < L_NUM_REGIONS; ++reg)
+	{
+		int b = boxOfReg[reg];
+		if (b < 0)
+		{
+			if (bWasActive[reg]) bChanged = true;
+			continue;
+		}
+		std::copy(&boxes[6 * b], &boxes[6 * b] + 6, &newBoxes[6 * reg]);
+
+		if (bWasActive[reg])
+		{
+			bool bKeep = (_boxVolume(&oldBoxes[6 * reg]) <= 2 * _boxVolume(&boxes[6 * b]));
+			for (int d = 0; d < L_DIMS; ++d)
+			{
+				if (tagBoxes[6 * b + 2 * d] < oldBoxes[6 * reg + 2 * d] + 1 ||
+					tagBoxes[6 * b + 2 * d + 1] > oldBoxes[6 * reg + 2 * d + 1] - 1)
+					bKeep = false;
+			}
+			if (bKeep) std::copy(&oldBoxes[6 * reg], &oldBoxes[6 * reg] + 6, &newBoxes[6 * reg]);
+		}
+
+		if (!bWasActive[reg]) bChanged = true;
+		for (int d = 0; d < L_DIMS; ++d)
+		{
+			if (newBoxes[6 * reg + 2 * d] != oldBoxes[6 * reg + 2 * d] ||
+				newBoxes[6 * reg + 2 * d + 1] != oldBoxes[6 * reg + 2 * d + 1])
+				bChanged = true;
+		}
+	}
+	if (!bChanged) return false;
+
+
+	// Snapshot the grid manager so the hierarchy can be restored
+	int oldSize[3][L_NUM_LEVELS * L_NUM_REGIONS + 1];
+	double oldEdges[6][L_NUM_LEVELS * L_NUM_REGIONS + 1];
+	bool oldPeriodic[3][L_NUM_LEVELS * L_NUM_REGIONS + 1];
+	bool oldKey[sizeof(gm->subgrid_tlayer_key) / sizeof(bool)];
+	std::memcpy(oldSize, gm->global_size, sizeof(oldSize));
+	std::memcpy(oldEdges, gm->global_edges, sizeof(oldEdges));
+	std::memcpy(oldPeriodic, gm->periodic_flags, sizeof(oldPeriodic));
+	std::memcpy(oldKey, gm->subgrid_tlayer_key, sizeof(oldKey));
+
+	// Place the new grids
+	for (int reg = 0; reg < L_NUM_REGIONS; ++reg)
+	{
+		double dhLev = dh;
+		for (int lev = 1; lev <= L_NUM_LEVELS; ++lev)
+		{
+			int idx = lev + reg * L_NUM_LEVELS;
+			if (boxOfReg[reg] < 0)
+			{
+				// Region is not required so give it no extent
+				for (int e = 0; e < 6; ++e) gm->global_edges[e][idx] = 0.0;
+				for (int d = 0; d < 3; ++d)
+				{
+					gm->global_size[d][idx] = 0;
+					gm->periodic_flags[d][idx] = false;
+				}
+				continue;
+			}
+
+			if (lev == 1)
+			{
+				for (int d = 0; d < L_DIMS; ++d)
+				{
+					gm->global_edges[2 * d][idx] = newBoxes[6 * reg + 2 * d] * dh;
+					gm->global_edges[2 * d + 1][idx] = newBoxes[6 * reg + 2 * d + 1] * dh;
+				}
+#if (L_DIMS != 3)
+				gm->global_edges[eZMin][idx] = std::round(cRefStartZ[0][reg] / dh) * dh;
+				gm->global_edges[eZMax][idx] = std::round(cRefEndZ[0][reg] / dh) * dh;
+#endif
+			}
+			gm->setSubGridEdges(lev, reg, dhLev, lev == 1);
+			dhLev /= 2.0;
+		}
+	}
+
+	// Immersed bodies on sub-grids must stay inside their grid
+	int bOutside = 0;
+#ifdef L_IBM_ON
+	if (!objMan->ibm_insideSubGrids()) bOutside = 1;
+#endif
+#ifdef L_BUILD_FOR_MPI
+	MPI_Allreduce(MPI_IN_PLACE, &bOutside, 1, MPI_INT, MPI_MAX, mpim->world_comm);
+#endif
+	if (bOutside)
+	{
+		std::memcpy(gm->global_size, oldSize, sizeof(oldSize));
+		std::memcpy(gm->global_edges, oldEdges, sizeof(oldEdges));
+		std::memcpy(gm->periodic_flags, oldPeriodic, sizeof(oldPeriodic));
+		L_WARN("Adapted sub-grids would not contain the immersed bodies on them -- sub-grids left unchanged.", GridUtils::logfile);
+		return false;
+	}
+
+	/* Average the old sub-grids onto the coarse sites they cover. Refined 
+	 * sites in the halo may not be covered by a sub-grid on this rank so their
+	 * populations are set to the equilibrium of the exchanged macroscopic 
+	 * quantities instead. */
+	std::vector<int> restrictedSlot(N_lim * M_lim * K_lim, -1);
+	std::vector<double> restricted, state(_nState);
+	for (int id = 0; id < N_lim * M_lim * K_lim; ++id)
+	{
+		if (LatTyp[id] != eRefined) continue;
+		if (!_LBM_restrictSite(id, &state[0]))
+		{
+			_LBM_getSiteState(id, &state[0]);
+			for (int v = 0; v < L_NUM_VELS; ++v)
+				state[v] = state[v + L_NUM_VELS] = _LBM_equilibrium_opt(id, v);
+		}
+		restrictedSlot[id] = static_cast<int>(restricted.size() / _nState);
+		restricted.insert(restricted.end(), state.begin(), state.end());
+	}
+
+	// Keep the old hierarchy and labels then build the new one
+	std::vector<GridObj*> oldSubGrid = subGrid, oldGrids;
+	for (GridObj *g : oldSubGrid) g->_LBM_gatherGrids(oldGrids);
+	IVector<eType> oldLatTyp = LatTyp;
+	subGrid.clear();
+	for (eType &type : LatTyp)
+	{
+		if (type == eRefined || type == eTransitionToFiner) type = eFluid;
+	}
+#ifndef L_BUILD_FOR_MPI
+	gm->p_data.clear();
+	gm->createWritableDataStore(this);
+#endif
+	for (int reg = 0; reg < L_NUM_REGIONS; ++reg)
+		LBM_addSubGrid(reg);
+
+#if (defined L_BUILD_FOR_MPI && defined L_IBM_ON)
+	// Grids carrying immersed bodies must stay on the same ranks
+	int bMoved = 0;
+	for (int lev = 1; lev <= L_NUM_LEVELS; ++lev)
+	{
+		int hasBodies = objMan->hasIBMBodies[lev] ? 1 : 0;
+		MPI_Allreduce(MPI_IN_PLACE, &hasBodies, 1, MPI_INT, MPI_MAX, mpim->world_comm);
+		if (!hasBodies) continue;
+
+		for (int reg = 0; reg < L_NUM_REGIONS; ++reg)
+		{
+			bool bOld = false, bNew = false;
+			for (GridObj *g : oldGrids)
+			{
+				if (g->level == lev && g->region_number == reg) bOld = true;
+			}
+			GridObj *gNew = nullptr;
+			GridUtils::getGrid(this, lev, reg, gNew);
+			bNew = (gNew != nullptr);
+			if (bOld != bNew) bMoved = 1;
+		}
+	}
+	MPI_Allreduce(MPI_IN_PLACE, &bMoved, 1, MPI_INT, MPI_MAX, mpim->world_comm);
+	if (bMoved)
+	{
+		for (GridObj *g : subGrid) delete g;
+		subGrid = oldSubGrid;
+		LatTyp = oldLatTyp;
+		std::memcpy(gm->global_size, oldSize, sizeof(oldSize));
+		std::memcpy(gm->global_edges, oldEdges, sizeof(oldEdges));
+		std::memcpy(gm->periodic_flags, oldPeriodic, sizeof(oldPeriodic));
+		std::memcpy(gm->subgrid_tlayer_key, oldKey, sizeof(oldKey));
+		L_WARN("Adapted sub-grids would move immersed bodies between ranks -- sub-grids left unchanged.", GridUtils::logfile);
+		return false;
+	}
+#endif
+
+	// Fill the new grids then update the coarse sites no longer refined
+	for (GridObj *g : subGrid) g->_LBM_adaptFill(oldGrids, restrictedSlot, restricted);
+	bStreamTablesValid = false;
+	_LBM_buildStreamTables();
+	for (int id = 0; id < N_lim * M_lim * K_lim; ++id)
+	{
+		if (restrictedSlot[id] >= 0 && LatTyp[id] != eRefined && LatTyp[id] != eSolid)
+			_LBM_setSiteState(id, &restricted[restrictedSlot[id] * _nState]);
+	}
+
+	// Point the bodies at their new grids and remove the old ones
+#ifdef L_IBM_ON
+	objMan->ibm_updateOwners(this);
+#endif
+	for (GridObj *g : oldSubGrid) delete g;
+
+#ifdef L_BUILD_FOR_MPI
+	mpim->mpi_updateHierarchy();
+#elif defined L_IBM_ON
+	objMan->ibm_initialise();
+#endif
+	gm->updateGlobalCellCount();
+
+	int nActive = 0;
+	for (int reg = 0; reg < L_NUM_REGIONS; ++reg)
+	{
+		if (boxOfReg[reg] >= 0) ++nActive;
+	}
+	L_INFO("Sub-grids adapted at time step " + std::to_string(t) + " (" +
+		std::to_string(nActive) + " of " + std::to_string(L_NUM_REGIONS) + " regions refined).", GridUtils::logfile);
+	return true;
+}
+
+// ****************************************************************************
+/// \brief	Set the macroscopic quantities of refined sites from their children.
+///
+///			Refined sites are not updated by the kernel so before they are used
+///			to tag sites their density and velocity are set to the average of
+///			the sites covering them, working up from the finest grids.
+void GridObj::_LBM_restrictMacros()
+{
+	for (GridObj *g : subGrid)
+	{
+		g->_LBM_restrictMacros();
+
+		for (int i = 0; i < N_lim; ++i)
+		{
+			if (g->FineIdxX[i] < 0) continue;
+			for (int j = 0; j < M_lim; ++j)
+			{
+				if (g->FineIdxY[j] < 0) continue;
+				for (int k = 0; k < K_lim; ++k)
+				{
+					if (g->FineIdxZ[k] < 0) continue;
+					int id = k + j * K_lim + i * K_lim * M_lim;
+					if (LatTyp[id] != eRefined) continue;
+
+					double rhoSum = 0.0, uSum[L_DIMS] = { 0.0 };
+					int n = 0;
+					for (int di = 0; di < 2; ++di)
+					{
+						for (int dj = 0; dj < 2; ++dj)
+						{
+							for (int dk = 0; dk < (L_DIMS == 3 ? 2 : 1); ++dk)
+							{
+								int fi = g->FineIdxX[i] + di, fj = g->FineIdxY[j] + dj, fk = g->FineIdxZ[k] + dk;
+								if (fi >= g->N_lim || fj >= g->M_lim || fk >= g->K_lim) continue;
+								int cid = fk + fj * g->K_lim + fi * g->K_lim * g->M_lim;
+								rhoSum += g->rho[cid];
+								for (int d = 0; d < L_DIMS; ++d) uSum[d] += g->u[d + cid * L_DIMS];
+								++n;
+							}
+						}
+					}
+					if (n == 0) continue;
+					rho[id] = rhoSum / n;
+					for (int d = 0; d < L_DIMS; ++d) u[d + id * L_DIMS] = uSum[d] / n;
+				}
+			}
+		}
+	}
+}
+
+// ****************************************************************************
+/// \brief	Tag the coarse sites which require refinement.
+///
+///			Each rank tags the core sites of its L0 grid and the tags are then
+///			combined across all ranks. Vorticity and velocity gradients are in
+///			non-dimensional units. Sites near the markers of immersed bodies on
+///			sub-grids are always tagged so the bodies remain refined.
+///
+/// \param	tags	tag of each site on L0 (global ijk flattened as k + K * (j + M * i)).
+/// \param	size	global size of L0.
+void GridObj::_LBM_tagSites(std::vector<unsigned char> &tags, const int *size)
+{
+	double grad[L_DIMS * L_DIMS];
+
+	if (L_AMR_CRITERION != eAmrBodyDistance)
+	{
+		for (int i = 0; i < N_lim; ++i)
+		{
+			for (int j = 0; j < M_lim; ++j)
+			{
+				for (int k = 0; k < K_lim; ++k)
+				{
+#ifdef L_BUILD_FOR_MPI
+					if (GridUtils::isOnRecvLayer(XPos[i], YPos[j], ZPos[k])) continue;
+#endif
+					int id = k + j * K_lim + i * K_lim * M_lim;
+					if (LatTyp[id] == eSolid) continue;
+
+					// Magnitude of the chosen quantity
+					_LBM_velocityGradient(i, j, k, grad);
+					double magnitude = 0.0;
+					if (L_AMR_CRITERION == eAmrVorticity)
+					{
+#if (L_DIMS == 3)
+						double wx = grad[2 + 1 * L_DIMS] - grad[1 + 2 * L_DIMS];
+						double wy = grad[0 + 2 * L_DIMS] - grad[2 + 0 * L_DIMS];
+						double wz = grad[1 + 0 * L_DIMS] - grad[0 + 1 * L_DIMS];
+						magnitude = sqrt(wx * wx + wy * wy + wz * wz);
+#else
+						magnitude = fabs(grad[1 + 0 * L_DIMS] - grad[0 + 1 * L_DIMS]);
+#endif
+					}
+					else
+					{
+						for (int n = 0; n < L_DIMS * L_DIMS; ++n) magnitude += grad[n] * grad[n];
+						magnitude = sqrt(magnitude);
+					}
+					if (magnitude <= L_AMR_THRESHOLD) continue;
+
+					int gi = std::min(std::max(static_cast<int>(std::floor(XPos[i] / dh)), 0), size[0] - 1);
+					int gj = std::min(std::max(static_cast<int>(std::floor(YPos[j] / dh)), 0), size[1] - 1);
+					int gk = std::min(std::max(static_cast<int>(std::floor(ZPos[k] / dh)), 0), size[2] - 1);
+					tags[gk + size[2] * (gj + size[1] * gi)] = 1;
+				}
+			}
+		}
+	}
+
+#ifdef L_IBM_ON
+	// Sites near the markers
+	ObjectManager::getInstance()->ibm_tagSites(tags, size, dh);
+#endif
+
+#ifdef L_BUILD_FOR_MPI
+	// Combine the tags of all ranks
+	MPI_Allreduce(MPI_IN_PLACE, &tags[0], static_cast<int>(tags.size()),
+		MPI_UNSIGNED_CHAR, MPI_MAX, MpiManager::getInstance()->world_comm);
+#endif
+}
+
+// ****************************************************************************
+/// \brief	Non-dimensional velocity gradient at a site.
+///
+///			Central differences are used in the interior and one-sided
+///			differences at the edges of the local grid. Neighbouring solid
+///			sites are treated as stationary walls.
+///
+/// \param	i		x-index of site.
+/// \param	j		y-index of site.
+/// \param	k		z-index of site.
+/// \param	grad	gradient with du_b/dx_a stored at b + a * L_DIMS.
+void GridObj::_LBM_velocityGradient(int i, int j, int k, double *grad)
+{
+	int lims[3] = { N_lim, M_lim, K_lim };
+	for (int a = 0; a < L_DIMS; ++a)
+	{
+		int lo[3] = { i, j, k }, hi[3] = { i, j, k };
+		if (lo[a] > 0) --lo[a];
+		if (hi[a] < lims[a] - 1) ++hi[a];
+		int idLo = lo[2] + lo[1] * K_lim + lo[0] * K_lim * M_lim;
+		int idHi = hi[2] + hi[1] * K_lim + hi[0] * K_lim * M_lim;
+		for (int b = 0; b < L_DIMS; ++b)
+		{
+			// Solid sites are taken to be at rest as their velocity is not updated
+			double uLo = (LatTyp[idLo] == eSolid) ? 0.0 : u[b + idLo * L_DIMS];
+			double uHi = (LatTyp[idHi] == eSolid) ? 0.0 : u[b + idHi * L_DIMS];
+			grad[b + a * L_DIMS] = (hi[a] == lo[a]) ? 0.0 : (uHi - uLo) / ((hi[a] - lo[a]) * dt);
+		}
+	}
+}
+
+// ****************************************************************************
+/// \brief	Copy the state of a site into a buffer.
+/// \param	id		flattened ijk index.
+/// \param	state	buffer of _nState values.
+void GridObj::_LBM_getSiteState(int id, double *state)
+{
+	int n = 0;
+	for (int v = 0; v < L_NUM_VELS; ++v) state[n++] = f[fIdx(v, id)];
+	for (int v = 0; v < L_NUM_VELS; ++v) state[n++] = fNew[fIdx(v, id)];
+	state[n++] = rho[id];
+	for (int d = 0; d < L_DIMS; ++d) state[n++] = u[d + id * L_DIMS];
+#ifdef L_COMPUTE_TIME_AVERAGED_QUANTITIES
+	state[n++] = rho_timeav[id];
+	for (int d = 0; d < L_DIMS; ++d) state[n++] = ui_timeav[d + id * L_DIMS];
+	for (int p = 0; p < 3 * L_DIMS - 3; ++p) state[n++] = uiuj_timeav[p + id * (3 * L_DIMS - 3)];
+#endif
+}
+
+// ****************************************************************************
+/// \brief	Set the state of a site from a buffer.
+/// \param	id		flattened ijk index.
+/// \param	state	buffer of _nState values.
+void GridObj::_LBM_setSiteState(int id, const double *state)
+{
+	int n = 0;
+	for (int v = 0; v < L_NUM_VELS; ++v) f[fIdx(v, id)] = state[n++];
+	for (int v = 0; v < L_NUM_VELS; ++v) fNew[fIdx(v, id)] = state[n++];
+	rho[id] = state[n++];
+	for (int d = 0; d < L_DIMS; ++d) u[d + id * L_DIMS] = state[n++];
+#ifdef L_COMPUTE_TIME_AVERAGED_QUANTITIES
+	rho_timeav[id] = state[n++];
+	for (int d = 0; d < L_DIMS; ++d) ui_timeav[d + id * L_DIMS] = state[n++];
+	for (int p = 0; p < 3 * L_DIMS - 3; ++p) uiuj_timeav[p + id * (3 * L_DIMS - 3)] = state[n++];
+#endif
+}
+
+// ****************************************************************************
+/// \brief	Average the state of the sites covering a refined site.
+///
+///			The populations of the children are only averaged if they are all
+///			active, otherwise the equilibrium of the averaged macroscopic 
+///			quantities is used.
+///
+/// \param	id		flattened ijk index of the refined site.
+/// \param	state	buffer of _nState values.
+/// \return	false if the site is not covered by a sub-grid.
+bool GridObj::_LBM_restrictSite(int id, double *state)
+{
+	int i = id / (K_lim * M_lim), j = (id / K_lim) % M_lim, k = id % K_lim;
+	GridObj *g = _LBM_getChildGrid(i, j, k);
+	if (g == nullptr) return false;
+
+	std::vector<double> childState(_nState);
+	std::fill(state, state + _nState, 0.0);
+	bool bActive = true;
+	int n = 0;
+	for (int di = 0; di < 2; ++di)
+	{
+		for (int dj = 0; dj < 2; ++dj)
+		{
+			for (int dk = 0; dk < (L_DIMS == 3 ? 2 : 1); ++dk)
+			{
+				int fi = g->FineIdxX[i] + di, fj = g->FineIdxY[j] + dj, fk = g->FineIdxZ[k] + dk;
+				if (fi >= g->N_lim || fj >= g->M_lim || fk >= g->K_lim) continue;
+				int cid = fk + fj * g->K_lim + fi * g->K_lim * g->M_lim;
+				if (g->LatTyp[cid] == eSolid || g->LatTyp[cid] == eRefined) bActive = false;
+				g->_LBM_getSiteState(cid, &childState[0]);
+				for (int s = 0; s < _nState; ++s) state[s] += childState[s];
+				++n;
+			}
+		}
+	}
+	if (n == 0) return false;
+	for (int s = 0; s < _nState; ++s) state[s] /= n;
+
+	// Populations of inactive sites are not kept up to date
+	if (!bActive)
+	{
+		for (int v = 0; v < L_NUM_VELS; ++v)
+			state[v] = state[v + L_NUM_VELS] = _LBM_equilibrium_opt(id, v);
+	}
+	return true;
+}
+
+// ****************************************************************************
+/// \brief	Find the site on this grid at a position.
+/// \param	x	x-position.
+/// \param	y	y-position.
+/// \param	z	z-position.
+/// \return	flattened ijk index of the site or -1 if not on this grid.
+int GridObj::_LBM_findSite(double x, double y, double z)
+{
+	double pos[3] = { x, y, z };
+	const std::vector<double> *positions[3] = { &XPos, &YPos, &ZPos };
+	int ijk[3] = { 0, 0, 0 };
+
+	for (int d = 0; d < L_DIMS; ++d)
+	{
+		const std::vector<double> &p = *positions[d];
+		ijk[d] = static_cast<int>(std::floor((pos[d] - p[0]) / dh + 0.5));
+		if (ijk[d] < 0 || ijk[d] >= static_cast<int>(p.size())) return -1;
+		if (fabs(p[ijk[d]] - pos[d]) > 0.25 * dh) return -1;
+	}
+	return ijk[2] + ijk[1] * K_lim + ijk[0] * K_lim * M_lim;
+}
+
+// ****************************************************************************
+/// \brief	Add this grid and all the grids beneath it to a list.
+/// \param	grids	list of grids.
+void GridObj::_LBM_gatherGrids(std::vector<GridObj*> &grids)
+{
+	grids.push_back(this);
+	for (GridObj *g : subGrid) g->_LBM_gatherGrids(grids);
+}
+
+// ****************************************************************************
+/// \brief	Fill a newly adapted grid and those beneath it.
+///
+///			Each site takes its state from an old grid on the same level on
+///			which it was active, otherwise from its parent site. The upper 
+///			transition layer of the old grids is not used as only some of its
+///			populations are kept up to date. Parent sites on L0 which were 
+///			refined take their averaged state.
+///
+/// \param	oldGrids		old grids below L0.
+/// \param	restrictedSlot	slot of each L0 site in the averaged states (-1 if none).
+/// \param	restricted		averaged states of the previously refined L0 sites.
+void GridObj::_LBM_adaptFill(const std::vector<GridObj*> &oldGrids,
+	const std::vector<int> &restrictedSlot, const std::vector<double> &restricted)
+{
+	std::vector<double> state(_nState);
+	for (int i = 0; i < N_lim; ++i)
+	{
+		for (int j = 0; j < M_lim; ++j)
+		{
+			for (int k = 0; k < K_lim; ++k)
+			{
+				int id = k + j * K_lim + i * K_lim * M_lim;
+
+				// Old grid on this level (averaging its children if it was refined)
+				bool bFound = false;
+				for (GridObj *g : oldGrids)
+				{
+					if (g->level != level) continue;
+					int oldId = g->_LBM_findSite(XPos[i], YPos[j], ZPos[k]);
+					if (oldId < 0 || g->LatTyp[oldId] == eSolid ||
+						g->LatTyp[oldId] == eTransitionToCoarser) continue;
+					if (g->LatTyp[oldId] == eRefined)
+						bFound = g->_LBM_restrictSite(oldId, &state[0]);
+					else
+					{
+						g->_LBM_getSiteState(oldId, &state[0]);
+						bFound = true;
+					}
+					break;
+				}
+
+				// Otherwise the parent site
+				if (!bFound)
+				{
+					int pId = CoarseIdxZ[k] + CoarseIdxY[j] * parentGrid->K_lim +
+						CoarseIdxX[i] * parentGrid->K_lim * parentGrid->M_lim;
+					if (parentGrid->level == 0 && restrictedSlot[pId] >= 0)
+						std::copy(&restricted[restrictedSlot[pId] * _nState], &restricted[restrictedSlot[pId] * _nState] + _nState, state.begin());
+					else
+						parentGrid->_LBM_getSiteState(pId, &state[0]);
+				}
+				_LBM_setSiteState(id, &state[0]);
+			}
+		}
+	}
+
+	// Bring the grid up to the current time
+	t = parentGrid->t * 2;
+	for (GridObj *g : oldGrids)
+	{
+		if (g->level == level && g->region_number == region_number)
+		{
+			timeav_mpi_overhead = g->timeav_mpi_overhead;
+			timeav_timestep = g->timeav_timestep;
+		}
+	}
+#ifdef L_IBM_ON
+	u_n = u;
+#endif
+
+	for (GridObj *g : subGrid) g->_LBM_adaptFill(oldGrids, restrictedSlot, restricted);
+}
+
+#endif
@@ -165,7 +165,7 @@ void GridObj::io_textout(std::string output_tag) {
 					for (size_t i = 0; i < N_lim; i++) {
 
 						// Output
-						gridoutput << f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) << "\t";
+						gridoutput << f[fIdx(i, j, k, v)] << "\t";
 
 					}
 				}
@@ -188,7 +188,7 @@ void GridObj::io_textout(std::string output_tag) {
 					for (size_t i = 0; i < N_lim; i++) {
 
 						// Output
-						gridoutput << feq(i,j,k,v,M_lim,K_lim,L_NUM_VELS) << "\t";
+						gridoutput << feq[fIdx(i, j, k, v)] << "\t";
 
 					}
 				}
@@ -389,93 +389,184 @@ void GridObj::_io_fgaout(int timeStepL0) {
 // *****************************************************************************
 /// \brief	Restart file read-writer.
 ///
-///			This routine writes/reads the current rank's particle distribution functions
-///			in the custom restart file format. If the file already exists, data is appended. 
-///			IB body data are also written out but no other body information at present. 
-///			It writes the restart data following the procedure in: 
-///			"Physically based Animation of Free Surface Flows with the Lattice Boltzmann Method" by N. Thuerey, 
-///			section 6.1. 
-///			This implementation allows to restart the simulation with a different time step value. 
-///         The data written for each cell is: 
-///			- Global position 
-///         - Dimensionless velocity
-///         - Density in LBM units
-///         - Time-scaled non equilibrium distribution functions: ((f - f_eq) * omega) / (f_eq*dt)
+///			This routine writes/reads the particle distribution functions of 
+///			this grid and all its sub-grids to/from a single binary restart 
+///			file. It must be called on the coarsest grid by all ranks. The file
+///			starts with a header of L_RESTART_HEADER_SIZE 64-bit integers:
+///			- Identifier and format version
+///			- L_DIMS and L_NUM_VELS
+///			- Coarse lattice size (L_N, L_M, L_K)
+///			- Time step at which the file was written
+///			- Number of site records
+///
+///			followed by one fixed-size record per site (native byte order):
+///			- Grid level and region (32-bit integers)
+///			- Global index of the site on the lattice of its level (64-bit)
+///			- Dimensionless velocity
+///			- Density in LBM units
+///			- Time-scaled non equilibrium distribution functions: ((f - f_eq) * omega) / (f_eq*dt)
+///
+///			The scaling follows the procedure in: "Physically based Animation 
+///			of Free Surface Flows with the Lattice Boltzmann Method" by 
+///			N. Thuerey, section 6.1, which allows the simulation to be restarted
+///			with a different time step value. In MPI builds each rank writes 
+///			its core sites as a contiguous block using collective MPI-IO. On 
+///			reading, each rank reads an equal share of the records and passes 
+///			them to the ranks on which the sites lie so the file may be read 
+///			with any number of ranks or decomposition. IB body data are 
+///			written/read by the object manager.
 ///
 /// \param IO_flag	flag to indicate whether a write or read
 void GridObj::io_restart(eIOFlag IO_flag) {
 
-	// Get GM Instance
-	GridManager *gm = GridManager::getInstance();
+	// Record layout
+	const int nData = L_DIMS + 1 + L_NUM_VELS;
+	const int recordBytes = 2 * sizeof(int) + sizeof(long long) + nData * sizeof(double);
+	const int headerBytes = L_RESTART_HEADER_SIZE * sizeof(long long);
+	long long header[L_RESTART_HEADER_SIZE];
 
-	// Rank string
-	std::string rnk_str = std::to_string(GridUtils::safeGetRank());
+	// Counters
+	int i, j, k, v;
+
+#ifdef L_BUILD_FOR_MPI
+	MpiManager *mpim = MpiManager::getInstance();
+	MPI_File fh;
+	MPI_Datatype recordType;
+	MPI_Type_contiguous(recordBytes, MPI_BYTE, &recordType);
+	MPI_Type_commit(&recordType);
+#endif
 
 
 	if (IO_flag == eWrite) {
 
-		// Restart file stream
-		std::ofstream file;
-		*GridUtils::logfile << "Writing grid level " << level << " region " << region_number << " to restart file..." << endl;
+		L_INFO("Writing grids to restart file...", GridUtils::logfile);
+#ifdef L_USE_AA_STREAMING
+		if (t % 2 != 0) L_WARN("Restart file written after an odd number of in-place steps will not restart exactly.", GridUtils::logfile);
+#endif
 
 
 		///////////////////////
 		// LBM Data -- WRITE //
 		///////////////////////
 
-		if (level == 0) {
-			// New file
-			file.open(GridUtils::path_str + "/restart_LBM_Rnk" + rnk_str + ".out", std::ios::out);
-		}
-		else {
-			// Append
-			file.open(GridUtils::path_str + "/restart_LBM_Rnk" + rnk_str + ".out", std::ios::out | std::ios::app);
-		}
+		// Pack the core sites of every grid in the hierarchy
+		std::vector<char> records;
+		for (int lev = 0; lev <= L_NUM_LEVELS; ++lev)
+		{
+			for (int reg = 0; reg < L_NUM_REGIONS; ++reg)
+			{
+				GridObj *g = nullptr;
+				GridUtils::getGrid(this, lev, reg, g);
+				if (!g) continue;
 
-		// Counters
-		int i,j,k,v;
+				// Size of the lattice covering the whole domain at the resolution of this grid
+				long long scale = 1LL << g->level;
+				long long sizeX = static_cast<long long>(L_N) * scale;
+				long long sizeY = static_cast<long long>(L_M) * scale;
 
-		// Write out global grid indices and then the values of f, u and rho
-		for (k = 0; k < K_lim; k++) {
-			for (j = 0; j < M_lim; j++) {
-				for (i = 0; i < N_lim; i++) {
-					
-#ifdef L_BUILD_FOR_MPI
-					// Don't write out the receiver layer sites to avoid duplication
-					if (GridUtils::isOnRecvLayer(XPos[i],YPos[j],ZPos[k])) continue;
-#endif
+				int ids[2] = { g->level, g->region_number };
+				double data[nData];
 
-					// Grid level and region
-					file << level << "\t" << region_number << "\t";
+				for (k = 0; k < g->K_lim; k++) {
+					for (j = 0; j < g->M_lim; j++) {
+						for (i = 0; i < g->N_lim; i++) {
 
-					// Global Position
-					file << XPos[i] << "\t" << YPos[j] << "\t" << ZPos[k] << "\t";
+#ifdef L_BUILD_FOR_MPI
+							// Don't write out the receiver layer sites to avoid duplication
+							if (GridUtils::isOnRecvLayer(g->XPos[i], g->YPos[j], g->ZPos[k])) continue;
+#endif
 
-					// Dimensionless u values
-					for (v = 0; v < L_DIMS; v++) {
-						file << GridUnits::ulbm2ud(u(i, j, k, v, M_lim, K_lim, L_DIMS), this) << "\t";
+							// Global index from the position of the site
+							long long gi = std::llround(g->XPos[i] / g->dh - 0.5);
+							long long gj = std::llround(g->YPos[j] / g->dh - 0.5);
+#if (L_DIMS == 3)
+							long long gk = std::llround(g->ZPos[k] / g->dh - 0.5);
+#else
+							long long gk = 0;
+#endif
+							long long globalIdx = gi + sizeX * (gj + sizeY * gk);
+
+							// Dimensionless u values
+							for (v = 0; v < L_DIMS; v++)
+								data[v] = GridUnits::ulbm2ud(g->u(i, j, k, v, g->M_lim, g->K_lim, L_DIMS), g);
+
+							// rho in lbm units (rho does not depend on dt). 
+							data[L_DIMS] = g->rho(i, j, k, g->M_lim, g->K_lim);
+
+							// time - scaled fneq values
+							int id = k + j * g->K_lim + i * g->K_lim * g->M_lim;
+							for (v = 0; v < L_NUM_VELS; v++) {
+								double f_eq = g->_LBM_equilibrium_opt(id, v);
+#ifdef L_USE_AA_STREAMING
+								/* After an even number of steps the populations are stored in the
+								 * order the first step reads them from so are written as they are */
+								double f_val = (g->t % 2 == 0 ? g->f[g->fIdx(i, j, k, v)] : g->_LBM_aaGetPopulation(i, j, k, v));
+#else
+								double f_val = g->f[g->fIdx(i, j, k, v)];
+#endif
+								data[L_DIMS + 1 + v] = ((f_val - f_eq) * g->omega) / (f_eq * g->dt);
+							}
+
+							// Append record
+							size_t pos = records.size();
+							records.resize(pos + recordBytes);
+							std::memcpy(&records[pos], ids, sizeof(ids));
+							std::memcpy(&records[pos + sizeof(ids)], &globalIdx, sizeof(globalIdx));
+							std::memcpy(&records[pos + sizeof(ids) + sizeof(globalIdx)], data, sizeof(data));
+						}
 					}
+				}
+			}
+		}
 
-					// rho in lbm units (rho does not depend on dt). 
-					file << rho(i, j, k, M_lim, K_lim) << "\t";
+		// Header
+		long long nLocal = static_cast<long long>(records.size() / recordBytes);
+		header[0] = L_RESTART_ID;
+		header[1] = L_RESTART_VERSION;
+		header[2] = L_DIMS;
+		header[3] = L_NUM_VELS;
+		header[4] = L_N;
+		header[5] = L_M;
+		header[6] = L_K;
+		header[7] = t;
+		header[8] = nLocal;
 
-					int id = k + j * K_lim + i * K_lim * M_lim;
-					// time - scaled fneq values
-					for (v = 0; v < L_NUM_VELS; v++) {
-						double f_eq = _LBM_equilibrium_opt(id, v);
-						double f_neq_restart = ((f(i, j, k, v, M_lim, K_lim, L_NUM_VELS) - f_eq) * omega) / (f_eq*dt);
-						file << f_neq_restart << "\t";
-					}
+		std::string fileName = GridUtils::path_str + "/restart_LBM.bin";
 
-					file << std::endl;
+#ifdef L_BUILD_FOR_MPI
 
-				}
-			}
-		}
+		// Offset of the block of this rank and total number of records
+		long long nBefore = 0;
+		MPI_Exscan(&nLocal, &nBefore, 1, MPI_LONG_LONG, MPI_SUM, mpim->world_comm);
+		if (mpim->my_rank == 0) nBefore = 0;
+		MPI_Allreduce(&nLocal, &header[8], 1, MPI_LONG_LONG, MPI_SUM, mpim->world_comm);
+
+		// Replace any existing file
+		if (mpim->my_rank == 0) MPI_File_delete(fileName.c_str(), MPI_INFO_NULL);
+		MPI_Barrier(mpim->world_comm);
+		if (MPI_File_open(mpim->world_comm, fileName.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS)
+			L_ERROR("Error opening LBM restart file for writing. Exiting.", GridUtils::logfile);
+
+		// Header from master then collective write of the site blocks
+		if (mpim->my_rank == 0)
+			MPI_File_write_at(fh, 0, header, L_RESTART_HEADER_SIZE, MPI_LONG_LONG, MPI_STATUS_IGNORE);
+		MPI_File_write_at_all(fh, static_cast<MPI_Offset>(headerBytes) + nBefore * recordBytes,
+			records.data(), static_cast<int>(nLocal), recordType, MPI_STATUS_IGNORE);
+		MPI_File_close(&fh);
 
-		// Close file
+#else
+
+		std::ofstream file(fileName, std::ios::out | std::ios::binary);
+		if (!file.is_open())
+			L_ERROR("Error opening LBM restart file for writing. Exiting.", GridUtils::logfile);
+		file.write(reinterpret_cast<const char*>(header), headerBytes);
+		file.write(records.data(), records.size());
 		file.close();
 
+#endif
+
+		*GridUtils::logfile << "Written " << header[8] << " sites to restart file." << std::endl;
+
 
 		///////////////////////
 		// IBM Data -- WRITE //
@@ -487,18 +578,9 @@ void GridObj::io_restart(eIOFlag IO_flag) {
 
 #endif
 
-		// Call write recursively for subgrids
-		if (level < L_NUM_LEVELS && subGrid.size()) {
-			for (size_t g = 0; g < subGrid.size(); g++) {
-				subGrid[g]->io_restart(IO_flag);
-			}
-		}
-
 
 	} else {
 
-		// Input stream
-		std::ifstream file;
 		L_INFO("Initialising grids from restart file...", GridUtils::logfile);
 
 
@@ -506,73 +588,124 @@ void GridObj::io_restart(eIOFlag IO_flag) {
 		// LBM Data -- READ //
 		//////////////////////
 
-		file.open("./input/restart_LBM_Rnk" + rnk_str + ".out", std::ios::in);
+		std::string fileName = "./input/restart_LBM.bin";
+		std::vector<char> records;
+		long long nFirst, nLocal;
+
+#ifdef L_BUILD_FOR_MPI
+
+		if (MPI_File_open(mpim->world_comm, fileName.c_str(), MPI_MODE_RDONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS)
+			L_ERROR("Error opening LBM restart file. Exiting.", GridUtils::logfile);
+		MPI_File_read_at_all(fh, 0, header, L_RESTART_HEADER_SIZE, MPI_LONG_LONG, MPI_STATUS_IGNORE);
+
+#else
+
+		std::ifstream file(fileName, std::ios::in | std::ios::binary);
 		if (!file.is_open())
 			L_ERROR("Error opening LBM restart file. Exiting.", GridUtils::logfile);
+		file.read(reinterpret_cast<char*>(header), headerBytes);
 
-		// Counters, sizes and indices
-		int i,j,k,v;
-		double x, y, z;
-		int in_level, in_regnum;
-		std::vector<int> ind;
+#endif
 
-		// Read in one line of file at a time
-		std::string line_in;	// String to store line
-		std::istringstream iss;	// Buffer stream
+		// Check the file is compatible with this build
+		if (header[0] != L_RESTART_ID || header[1] != L_RESTART_VERSION)
+			L_ERROR("LBM restart file is not a valid restart file. Exiting.", GridUtils::logfile);
+		if (header[2] != L_DIMS || header[3] != L_NUM_VELS || header[4] != L_N || header[5] != L_M || header[6] != L_K)
+			L_ERROR("LBM restart file was written for a different lattice. Exiting.", GridUtils::logfile);
+		*GridUtils::logfile << "Restart file written at time step " << header[7] << " contains " << header[8] << " sites." << std::endl;
 
-		while(!file.eof())
+#ifdef L_BUILD_FOR_MPI
+
+		// Each rank reads an equal share of the records
+		nFirst = header[8] * mpim->my_rank / mpim->num_ranks;
+		nLocal = header[8] * (mpim->my_rank + 1) / mpim->num_ranks - nFirst;
+		records.resize(nLocal * recordBytes);
+		MPI_File_read_at_all(fh, static_cast<MPI_Offset>(headerBytes) + nFirst * recordBytes,
+			records.data(), static_cast<int>(nLocal), recordType, MPI_STATUS_IGNORE);
+		MPI_File_close(&fh);
+
+#else
+
+		nFirst = 0;
+		nLocal = header[8];
+		records.resize(nLocal * recordBytes);
+		file.read(records.data(), records.size());
+		if (!file)
+			L_ERROR("LBM restart file is incomplete. Exiting.", GridUtils::logfile);
+		file.close();
+
+#endif
+
+		// Unpack records to level, region, position and data
+		const int nValues = 5 + nData;
+		std::vector<double> sites(nLocal * nValues);
+		for (long long r = 0; r < nLocal; ++r)
 		{
+			int ids[2];
+			long long globalIdx;
+			double *site = &sites[r * nValues];
+			std::memcpy(ids, &records[r * recordBytes], sizeof(ids));
+			std::memcpy(&globalIdx, &records[r * recordBytes + sizeof(ids)], sizeof(globalIdx));
+			std::memcpy(site + 5, &records[r * recordBytes + sizeof(ids) + sizeof(globalIdx)], nData * sizeof(double));
+
+			// Position from the global index
+			long long scale = 1LL << ids[0];
+			long long sizeX = static_cast<long long>(L_N) * scale;
+			long long sizeY = static_cast<long long>(L_M) * scale;
+			double dhLev = L_COARSE_SITE_WIDTH / static_cast<double>(scale);
+			site[0] = ids[0];
+			site[1] = ids[1];
+			site[2] = (static_cast<double>(globalIdx % sizeX) + 0.5) * dhLev;
+			site[3] = (static_cast<double>((globalIdx / sizeX) % sizeY) + 0.5) * dhLev;
+#if (L_DIMS == 3)
+			site[4] = (static_cast<double>(globalIdx / (sizeX * sizeY)) + 0.5) * dhLev;
+#else
+			site[4] = 0.0;
+#endif
+		}
+		std::vector<char>().swap(records);
 
-			// Get line and put in buffer
-			std::getline(file,line_in,'\n');
-			iss.str(line_in);
-			iss.seekg(0); // Reset buffer position to start of buffer
+		// Pass the sites to the ranks on which they lie
+		std::vector<double> recvBuffer;
+#ifdef L_BUILD_FOR_MPI
+		mpim->mpi_passSitesToRanks(sites, nValues, recvBuffer);
+#else
+		recvBuffer.swap(sites);
+#endif
 
-			// Read in level and region
-			iss >> in_level >> in_regnum;
+		// Set the sites on the grids of this rank
+		std::vector<int> ijk;
+		for (size_t s = 0; s < recvBuffer.size(); s += nValues)
+		{
+			const double *site = &recvBuffer[s];
 
 			// Get grid
 			GridObj *g = nullptr;
-			GridUtils::getGrid(gm->Grids, in_level, in_regnum, g);
-			if (!g) L_ERROR("Could not retrieve grid level " + std::to_string(in_level) + 
-				" region " + std::to_string(in_regnum) + ". Is restart file correct?", GridUtils::logfile);
-
-			// Read in positions
-			iss >> x >> y >> z;
-
-			// Get indices
-			eLocationOnRank *loc = nullptr;
-			std::vector<int> ijk;
-			if (!GridUtils::isOnThisRank(x, y, z, loc, g, &ijk)) continue;
-			i = ijk[0];
-			j = ijk[1];
-			k = ijk[2];
-			int id = k + j * K_lim + i * K_lim * M_lim;
+			GridUtils::getGrid(this, static_cast<int>(site[0]), static_cast<int>(site[1]), g);
+			if (!g || !GridUtils::isOnThisRank(site[2], site[3], site[4], nullptr, g, &ijk)) continue;
+			i = ijk[eXDirection];
+			j = ijk[eYDirection];
+			k = ijk[eZDirection];
+			int id = k + j * g->K_lim + i * g->K_lim * g->M_lim;
+			site += 5;
 
 			// Read in u values and convert them to lbm units
-			for (v = 0; v < L_DIMS; v++) {
-				double u_temp;
-				iss >> u_temp;
-				g->u(i, j, k, v, g->M_lim, g->K_lim, L_DIMS) = GridUnits::ud2ulbm(u_temp, g);
-			}
+			for (v = 0; v < L_DIMS; v++)
+				g->u(i, j, k, v, g->M_lim, g->K_lim, L_DIMS) = GridUnits::ud2ulbm(*site++, g);
 
 			// Read in rho value (it is already written in lbm units, since rho doesn't depend on dt)
-			iss >> g->rho(i, j, k, g->M_lim, g->K_lim);
+			g->rho(i, j, k, g->M_lim, g->K_lim) = *site++;
 
 			// Read in f values and convert them to the new dt
 			for (v = 0; v < L_NUM_VELS; v++) {
-				double f_temp;
-				double f_eq = _LBM_equilibrium_opt(id, v);
-				iss >> f_temp;
-				g->f(i, j, k, v, g->M_lim, g->K_lim, L_NUM_VELS) = f_eq*(1 + (g->dt*f_temp) / omega);
-				g->fNew(i, j, k, v, g->M_lim, g->K_lim, L_NUM_VELS) = g->f(i, j, k, v, g->M_lim, g->K_lim, L_NUM_VELS);
+				double f_eq = g->_LBM_equilibrium_opt(id, v);
+				g->f[g->fIdx(i, j, k, v)] = f_eq * (1 + (g->dt * *site++) / g->omega);
+#ifndef L_USE_AA_STREAMING
+				g->fNew[g->fIdx(i, j, k, v)] = g->f[g->fIdx(i, j, k, v)];
+#endif
 			}
-
 		}
 
-		// Reached end of file so close file
-		file.close();
-
 		L_INFO("Restart complete.", GridUtils::logfile);
 
 
@@ -586,6 +719,10 @@ void GridObj::io_restart(eIOFlag IO_flag) {
 
 	}
 
+#ifdef L_BUILD_FOR_MPI
+	MPI_Type_free(&recordType);
+#endif
+
 }
 
 // *****************************************************************************
@@ -753,12 +890,22 @@ void GridObj::io_lite(double tval, std::string TAG) {
 #endif
 
 					// Write out F and Feq
+#ifdef L_USE_AA_STREAMING
+					// Only a single population array when streaming in place
+					for (v = 0; v < L_NUM_VELS; v++) {
+						litefile << _LBM_aaGetPopulation(i, j, k, v) << "\t";
+					}
 					for (v = 0; v < L_NUM_VELS; v++) {
-						litefile << f(i,j,k,v,M_lim,K_lim,L_NUM_VELS) << "\t";
+						litefile << _LBM_aaGetPopulation(i, j, k, v) << "\t";
 					}
+#else
 					for (v = 0; v < L_NUM_VELS; v++) {
-						litefile << fNew(i,j,k,v,M_lim,K_lim,L_NUM_VELS) << "\t";
+						litefile << f[fIdx(i, j, k, v)] << "\t";
 					}
+					for (v = 0; v < L_NUM_VELS; v++) {
+						litefile << fNew[fIdx(i, j, k, v)] << "\t";
+					}
+#endif
 				
 #ifdef L_COMPUTE_TIME_AVERAGED_QUANTITIES
 					// Write out time averaged rho and u
@@ -0,0 +1,343 @@
+/*
+* --------------------------------------------------------------
+*
+* ------ Lattice Boltzmann @ The University of Manchester ------
+*
+* -------------------------- L-U-M-A ---------------------------
+*
+* Copyright 2019 The University of Manchester
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.*
+*/
+
+#include "../inc/stdafx.h"
+#include "../inc/GridObj.h"
+#include "../inc/ObjectManager.h"
+
+#ifdef L_USE_AA_STREAMING
+
+/* In-place streaming following the AA pattern of Bailey et al. 2009.
+ * https://doi.org/10.1109/ICPP.2009.38
+ *
+ * Only a single population array is stored. On even time steps a site reads 
+ * its populations from its own slots, collides and writes them back to its own
+ * slots in the opposite direction. On odd time steps a site reads the 
+ * populations streamed towards it from the slots of its neighbours, collides 
+ * and writes them to the slots of its neighbours in the direction they are 
+ * travelling. In both cases a site only ever touches its own set of slots so 
+ * the update can be performed in place and in any order. After an even time 
+ * step the array holds the post-collision populations of each site in reverse
+ * order; after an odd time step it holds the post-stream populations in the
+ * usual order. */
+
+// *****************************************************************************
+/// \brief	In-place stream-collide sweep.
+///
+///			Performs the stream, macroscopic update, forcing and collision of 
+///			each site in a single pass over the grid using the AA pattern. If
+///			there are IBM bodies on this grid then the macroscopic quantities 
+///			are computed in a first pass so the IBM force can be computed before
+///			collision.
+///
+///	\param	subcycle	sub-cycle to be performed if called from a subgrid.
+void GridObj::_LBM_aaStreamCollide_opt(int subcycle)
+{
+	// Get object manager instance
+	ObjectManager *objman = ObjectManager::getInstance();
+
+	// Parity of this time step
+	bool bOddStep = (t % 2 != 0);
+
+	// IBM //
+	bool bIBMStep = false;
+#ifdef L_IBM_ON
+	bIBMStep = objman->hasIBMBodies[level];
+#endif
+
+	// Compute the macroscopic quantities of the whole grid before the IBM step
+	if (bIBMStep)
+	{
+#ifdef L_ENABLE_OPENMP
+#pragma omp parallel for
+#endif
+		for (int i = 0; i < N_lim; ++i)
+		{
+#ifdef L_USE_SPARSE_LATTICE
+			// Only visit active sites
+			for (int s = sparsePlaneStart[i]; s < sparsePlaneStart[i + 1]; ++s)
+			{
+				{
+					// Local index and type
+					int id = sparseSites[s];
+					int j = (id / K_lim) % M_lim;
+					int k = id % K_lim;
+#else
+			for (int j = 0; j < M_lim; ++j)
+			{
+				for (int k = 0; k < K_lim; ++k)
+				{
+					// Local index and type
+					int id = k + j * K_lim + i * K_lim * M_lim;
+#endif
+					eType type_local = LatTyp[id];
+
+					// IGNORE THESE SITES //
+					if (type_local == eRefined || type_local == eSolid
+#ifndef L_REGULARISED_BOUNDARIES
+						|| type_local == eVelocity
+#endif
+						) continue;
+
+					// STREAM //
+					double fSite[L_NUM_VELS];
+					_LBM_aaGather_opt(i, j, k, id, bOddStep, fSite);
+
+					// REGULARISED BCs //
+#ifdef L_REGULARISED_BOUNDARIES
+					if (type_local == eVelocity || type_local == ePressure)
+						_LBM_regularised_opt(i, j, k, id, type_local, subcycle, fSite);
+#endif
+
+					// MACROSCOPIC //
+					_LBM_macro_opt(i, j, k, id, type_local, fSite);
+				}
+			}
+		}
+
+		// Set post-LBM macros
+		if (objman->hasFlexibleBodies[level])
+			u_n = u;
+
+		// Perform IBM steps (interpolate, force calc, spread and update macro)
+		objman->ibm_apply(this, true);
+	}
+
+	/* Loop over grid. Extrapolation at regularised corners reads the slots of
+	 * sites in other planes before they are updated so cannot be threaded. */
+#if (defined L_ENABLE_OPENMP && !defined L_REGULARISED_BOUNDARIES)
+#pragma omp parallel for
+#endif
+	for (int i = 0; i < N_lim; ++i)
+	{
+#ifdef L_USE_SPARSE_LATTICE
+		// Only visit active sites
+		for (int s = sparsePlaneStart[i]; s < sparsePlaneStart[i + 1]; ++s)
+		{
+			{
+				// Local index and type
+				int id = sparseSites[s];
+				int j = (id / K_lim) % M_lim;
+				int k = id % K_lim;
+#else
+		for (int j = 0; j < M_lim; ++j)
+		{
+			for (int k = 0; k < K_lim; ++k)
+			{
+				// Local index and type
+				int id = k + j * K_lim + i * K_lim * M_lim;
+#endif
+				eType type_local = LatTyp[id];
+
+				// IGNORE THESE SITES //
+				if (type_local == eRefined || type_local == eSolid
+#ifndef L_REGULARISED_BOUNDARIES
+					|| type_local == eVelocity
+#endif
+					) continue;
+
+				// Boundaries which need both population arrays are not supported
+				if (type_local == eBFL || type_local == eSlip)
+					L_ERROR("BFL and slip boundaries are not supported with in-place streaming. Exiting.", GridUtils::logfile);
+
+				// STREAM //
+				double fSite[L_NUM_VELS];
+				_LBM_aaGather_opt(i, j, k, id, bOddStep, fSite);
+
+				// REGULARISED BCs //
+#ifdef L_REGULARISED_BOUNDARIES
+				if (type_local == eVelocity || type_local == ePressure)
+					_LBM_regularised_opt(i, j, k, id, type_local, subcycle, fSite);
+#endif
+
+				// MACROSCOPIC //
+				if (!bIBMStep) _LBM_macro_opt(i, j, k, id, type_local, fSite);
+
+				// FORCING //
+#if (defined L_IBM_ON || defined L_GRAVITY_ON)
+				_LBM_forceGrid_opt(id);
+#endif
+
+				// COLLIDE //
+				_LBM_collide_opt(id, fSite);
+
+				// Write back in place
+				_LBM_aaScatter_opt(i, j, k, id, bOddStep, fSite);
+			}
+		}
+	}
+}
+
+// *****************************************************************************
+/// \brief	Read the post-stream populations of a site from the in-place array.
+///
+///			Solid and (non-regularised) velocity sites are handled in the same 
+///			way as in the usual stream operation.
+///
+/// \param	i			x-index of current site.
+/// \param	j			y-index of current site.
+/// \param	k			z-index of current site.
+///	\param	id			flattened ijk index.
+///	\param	bOddStep	parity of the time step being performed.
+///	\param	fSite		array to store the post-stream populations.
+void GridObj::_LBM_aaGather_opt(int i, int j, int k, int id, bool bOddStep, double *fSite)
+{
+	// BULK SITE -- all neighbours are fluid so no checks required
+	if (streamLinkStart[id] < 0)
+	{
+		for (int v = 0; v < L_NUM_VELS; ++v)
+		{
+			fSite[v] = (bOddStep ?
+				f[fIdx(GridUtils::getOpposite(v), id - streamSrcOffset[v])] :
+				f[fIdx(v, id)]);
+		}
+		return;
+	}
+
+	// Loop over velocities
+	for (int v = 0; v < L_NUM_VELS; ++v)
+	{
+		// Get indicies for source site (periodic by default)
+		int src_x = (i - c_opt[v][0] + N_lim) % N_lim;
+		int src_y = (j - c_opt[v][1] + M_lim) % M_lim;
+		int src_z = (k - c_opt[v][2] + K_lim) % K_lim;
+
+		// Source id and type
+		int src_id = src_z + src_y * K_lim + src_x * K_lim * M_lim;
+		eType src_type_local = LatTyp[src_id];
+
+		// BOUNCEBACK -- population was left in own slot by the previous step
+		if (src_type_local == eSolid)
+		{
+			fSite[v] = f[fIdx(v, id)];
+		}
+
+		// VELOCITY BC (forced equilbirium)
+#ifndef L_REGULARISED_BOUNDARIES
+		else if (src_type_local == eVelocity)
+		{
+
+#ifdef L_VELOCITY_RAMP
+			double rampCoefficient = GridUtils::getVelocityRampCoefficient(t * dt);
+			u[0 + src_id * L_DIMS] = ux_in[j] * rampCoefficient;
+			u[1 + src_id * L_DIMS] = uy_in[j] * rampCoefficient;
+#if (L_DIMS == 3)
+			u[2 + src_id * L_DIMS] = uz_in[j] * rampCoefficient;
+#endif
+
+#endif
+			// Set f to equilibrium (forced equilibrium BC)
+			fSite[v] = _LBM_equilibrium_opt(src_id, v);
+		}
+#endif
+
+		// REGULAR STREAM
+		else if (bOddStep)
+		{
+			// Pull population from reversed slot of source site
+			fSite[v] = f[fIdx(GridUtils::getOpposite(v), src_id)];
+		}
+		else
+		{
+			// Already streamed into own slot by the previous step
+			fSite[v] = f[fIdx(v, id)];
+		}
+	}
+}
+
+// *****************************************************************************
+/// \brief	Write the post-collision populations of a site to the in-place array.
+///
+/// \param	i			x-index of current site.
+/// \param	j			y-index of current site.
+/// \param	k			z-index of current site.
+///	\param	id			flattened ijk index.
+///	\param	bOddStep	parity of the time step being performed.
+///	\param	fSite		post-collision populations of the site.
+void GridObj::_LBM_aaScatter_opt(int i, int j, int k, int id, bool bOddStep, const double *fSite)
+{
+	// BULK SITE -- push to neighbours without checks
+	if (bOddStep && streamLinkStart[id] < 0)
+	{
+		for (int v = 0; v < L_NUM_VELS; ++v)
+			f[fIdx(v, id + streamSrcOffset[v])] = fSite[v];
+		return;
+	}
+
+	// Loop over velocities
+	for (int v = 0; v < L_NUM_VELS; ++v)
+	{
+		// Write to reversed slot of this site
+		if (!bOddStep)
+		{
+			f[fIdx(GridUtils::getOpposite(v), id)] = fSite[v];
+			continue;
+		}
+
+		// Get indicies for destination site (periodic by default)
+		int dest_x = (i + c_opt[v][0] + N_lim) % N_lim;
+		int dest_y = (j + c_opt[v][1] + M_lim) % M_lim;
+		int dest_z = (k + c_opt[v][2] + K_lim) % K_lim;
+		int dest_id = dest_z + dest_y * K_lim + dest_x * K_lim * M_lim;
+
+		// BOUNCEBACK -- leave in own slot ready to be bounced back
+		if (LatTyp[dest_id] == eSolid)
+			f[fIdx(GridUtils::getOpposite(v), id)] = fSite[v];
+
+		// Push population to destination site
+		else
+			f[fIdx(v, dest_id)] = fSite[v];
+	}
+}
+
+// *****************************************************************************
+/// \brief	Get the post-collision population of a site.
+///
+///			Returns the value which would be stored in f at the end of the time
+///			step if streaming were not performed in place, regardless of the 
+///			parity of the last time step.
+///
+/// \param	i	x-index of site.
+/// \param	j	y-index of site.
+/// \param	k	z-index of site.
+///	\param	v	lattice direction.
+///	\return	post-collision population.
+double GridObj::_LBM_aaGetPopulation(int i, int j, int k, int v)
+{
+	int id = k + j * K_lim + i * K_lim * M_lim;
+
+	// Initial populations are stored in the usual order and never updated on solid sites
+	if (t == 0 || LatTyp[id] == eSolid) return f[fIdx(v, id)];
+
+	// After an even time step stored in the reversed slot of the site
+	if (t % 2 != 0) return f[fIdx(GridUtils::getOpposite(v), id)];
+
+	// After an odd time step stored in the slot of the destination site
+	int dest_x = (i + c_opt[v][0] + N_lim) % N_lim;
+	int dest_y = (j + c_opt[v][1] + M_lim) % M_lim;
+	int dest_z = (k + c_opt[v][2] + K_lim) % K_lim;
+	int dest_id = dest_z + dest_y * K_lim + dest_x * K_lim * M_lim;
+	if (LatTyp[dest_id] == eSolid) return f[fIdx(GridUtils::getOpposite(v), id)];
+	return f[fIdx(v, dest_id)];
+}
+
+#endif
@@ -0,0 +1,132 @@
+/*
+* --------------------------------------------------------------
+*
+* ------ Lattice Boltzmann @ The University of Manchester ------
+*
+* -------------------------- L-U-M-A ---------------------------
+*
+* Copyright 2019 The University of Manchester
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.*
+*/
+
+#include "../inc/stdafx.h"
+#include "../inc/GridObj.h"
+
+#if (defined L_ENABLE_OPENMP && defined L_OMP_BENCHMARK)
+
+// *****************************************************************************
+/// \brief	Thread-scaling benchmark of the LBM kernel.
+///
+///			Times L_OMP_BENCHMARK stream, macroscopic and collide sweeps over 
+///			the fluid sites of this grid for 1, 2, 4, ... threads up to the 
+///			number available and reports the time per site, MLUPS, speed-up 
+///			and parallel efficiency to the log. Boundary conditions, IBM and 
+///			communication are not included so the result reflects the 
+///			threaded bulk kernel only. The grid state is restored afterwards.
+void GridObj::LBM_benchmarkThreads()
+{
+	// Save state
+	PopVector fSaved = f;
+#ifndef L_USE_AA_STREAMING
+	PopVector fNewSaved = fNew;
+#endif
+	IVector<double> uSaved = u;
+	IVector<double> rhoSaved = rho;
+
+	// Count sites swept
+	long long nSites = 0;
+	for (int id = 0; id < N_lim * M_lim * K_lim; ++id)
+	{
+		if (LatTyp[id] == eFluid) ++nSites;
+	}
+
+	// Make sure the stream tables exist
+	if (!bStreamTablesValid)
+		_LBM_buildStreamTables();
+
+	int maxThreads = omp_get_max_threads();
+	double secsSerial = 0.0;
+
+	L_INFO("Thread-scaling benchmark on level " + std::to_string(level) + " (" + 
+		std::to_string(nSites) + " sites, " + std::to_string(L_OMP_BENCHMARK) + " sweeps):", GridUtils::logfile);
+
+	for (int nThreads = 1; ; nThreads = std::min(2 * nThreads, maxThreads))
+	{
+		omp_set_num_threads(nThreads);
+		double t_start = omp_get_wtime();
+
+		for (int n = 0; n < L_OMP_BENCHMARK; ++n)
+		{
+#ifdef L_USE_AA_STREAMING
+			// Parity follows on from the current time step
+			bool bOddStep = ((t + n) % 2 != 0);
+#endif
+
+#pragma omp parallel for
+			for (int i = 0; i < N_lim; ++i)
+			{
+				for (int j = 0; j < M_lim; ++j)
+				{
+					for (int k = 0; k < K_lim; ++k)
+					{
+						int id = k + j * K_lim + i * K_lim * M_lim;
+						if (LatTyp[id] != eFluid) continue;
+
+#ifdef L_USE_AA_STREAMING
+						double fSite[L_NUM_VELS];
+						_LBM_aaGather_opt(i, j, k, id, bOddStep, fSite);
+						_LBM_macro_opt(i, j, k, id, eFluid, fSite);
+						_LBM_collide_opt(id, fSite);
+						_LBM_aaScatter_opt(i, j, k, id, bOddStep, fSite);
+#else
+						_LBM_stream_opt(i, j, k, id, eFluid, 0);
+						_LBM_macro_opt(i, j, k, id, eFluid);
+#ifdef L_USE_KBC_COLLISION
+						_LBM_kbcCollide_opt(id);
+#else
+						_LBM_collide_opt(id);
+#endif
+#endif
+					}
+				}
+			}
+
+#ifndef L_USE_AA_STREAMING
+			f.swap(fNew);
+#endif
+		}
+
+		double secs = omp_get_wtime() - t_start;
+		if (nThreads == 1) secsSerial = secs;
+
+		L_INFO(std::to_string(nThreads) + " thread(s) = " + 
+			std::to_string(secs * 1.0e9 / (static_cast<double>(nSites) * L_OMP_BENCHMARK)) + " ns/site, " + 
+			std::to_string(static_cast<double>(nSites) * L_OMP_BENCHMARK / (secs * 1.0e6)) + " MLUPS, speed-up = " + 
+			std::to_string(secsSerial / secs) + ", efficiency = " + 
+			std::to_string(100.0 * secsSerial / (secs * nThreads)) + "%", GridUtils::logfile);
+
+		if (nThreads == maxThreads) break;
+	}
+
+	// Restore state
+	omp_set_num_threads(maxThreads);
+	f.swap(fSaved);
+#ifndef L_USE_AA_STREAMING
+	fNew.swap(fNewSaved);
+#endif
+	u.swap(uSaved);
+	rho.swap(rhoSaved);
+}
+
+#endif
@@ -34,6 +34,35 @@
 ///
 ///	\param	subcycle	sub-cycle to be performed if called from a subgrid.
 void GridObj::LBM_multi_opt(int subcycle)
+{
+
+	// Update this grid and its sub-grids and post the halo exchange
+	_LBM_multiStart_opt(subcycle);
+
+#ifdef L_BUILD_FOR_MPI
+	// Complete the halo exchange on this grid
+	MpiManager::getInstance()->mpi_communicateFinish(level, region_number);
+#endif
+
+}
+
+// *****************************************************************************
+/// \brief	Update the grid and post its halo exchange.
+///
+///			Performs the time step of this grid and the sub-cycles of its 
+///			sub-grids. The halo exchange of this grid is posted but is left for
+///			the caller to complete.
+///
+///			With asynchronous sub-cycling the sub-grids are advanced together 
+///			one sub-cycle at a time so the exchange of one region is in flight
+///			while the next is updated. The exchanges posted by the second 
+///			sub-cycle are only completed once this grid has been updated. 
+///			Coalescence only reads the core of the sub-grids and the halo 
+///			populations which are not replaced by the exchange so the core of
+///			every grid is the same as when each sub-grid is completed in turn.
+///
+///	\param	subcycle	sub-cycle to be performed if called from a subgrid.
+void GridObj::_LBM_multiStart_opt(int subcycle)
 {
 
 #ifdef L_REYNOLDS_RAMP
@@ -41,12 +70,28 @@ void GridObj::LBM_multi_opt(int subcycle)
 	_LBM_updateReynolds(static_cast<double>(L_RE) * GridUtils::getReynoldsRampCoefficient((t + 1) * dt));
 #endif
 
+#if (defined L_BUILD_FOR_MPI && defined L_MPI_ASYNC_SUBCYCLING)
+	// Two iterations on sub-grids advanced together
+	for (int i = 0; i < 2; ++i)
+	{
+		// Halo of each sub-grid must be complete before its next sub-cycle
+		if (i > 0)
+		{
+			for (GridObj * sg : subGrid)
+				MpiManager::getInstance()->mpi_communicateFinish(sg->level, sg->region_number);
+		}
+
+		for (GridObj * sg : subGrid)
+			sg->_LBM_multiStart_opt(i);
+	}
+#else
 	// Two iterations on sub-grids
 	for (GridObj * sg : subGrid)
 	{
 		for (int i = 0; i < 2; ++i)
 			sg->LBM_multi_opt(i);
 	}
+#endif
 
 	// Get object manager instance
 	ObjectManager *objman = ObjectManager::getInstance();
@@ -57,36 +102,332 @@ void GridObj::LBM_multi_opt(int subcycle)
 		_LBM_resetForces();
 #endif
 
+	// Rebuild the stream tables if site labels have changed
+	if (!bStreamTablesValid)
+		_LBM_buildStreamTables();
+
 	// Start the clock to time this kernel
 	clock_t secs, t_start = clock();
 
+	// Is the halo exchange overlapped with the update?
+	bool bOverlapComms = false;
+
 #ifdef L_LD_OUT
 	// Reset object forces for momentum exchange force calculation
 	objman->resetMomexBodyForces(this);
+
+	// Momentum exchange on bounce-back bodies from the pre-stream populations
+	objman->computeLiftDrag(this);
+#endif
+
+#ifdef L_USE_AA_STREAMING
+	// Stream and collide in place on a single population array
+	_LBM_aaStreamCollide_opt(subcycle);
+#else
+
+#if (defined L_BUILD_FOR_MPI && defined L_MPI_OVERLAP && !defined L_REGULARISED_BOUNDARIES)
+	/* Overlap the halo exchange with the update of the interior unless an IBM
+	 * step requires the whole grid to be streamed before any site is collided.
+	 * Regularised corners update sites out of turn so are not split. */
+	bOverlapComms = true;
+#ifdef L_IBM_ON
+	if (objman->hasIBMBodies[level]) bOverlapComms = false;
+#endif
+#endif
+
+	// Fill the links which cross a grid transition
+	_LBM_transitionLinks_opt(subcycle);
+
+	// Fill the links which intersect a BFL body
+	_LBM_bflLinks_opt();
+
+	if (bOverlapComms)
+	{
+#ifdef L_BUILD_FOR_MPI
+		// Update sender layers first
+		_LBM_streamCollide_opt(subcycle, eSweepSender);
+
+		// Post the exchange of the new sender layer values (pack reads f so swap round while packing)
+		f.swap(fNew);
+		MpiManager::getInstance()->mpi_communicateStart(level, region_number);
+		f.swap(fNew);
+
+		// Update everything else while the messages are in flight
+		_LBM_streamCollide_opt(subcycle, eSweepInterior);
+#endif
+	}
+	else
+	{
+		// Update all sites
+		_LBM_streamCollide_opt(subcycle, eSweepAll);
+	}
+
+	// Swap distributions
+	f.swap(fNew);
+#endif
+
+#ifdef L_MOMEX_DEBUG
+	if (!solidBody.empty())
+	{
+		// Close file for momentum exchange information (call before t increments)
+		objman->toggleDebugStream(this);
+	}
+#endif
+
+	// Increment internal loop counter
+	++t;
+
+	// Get time of loop
+	secs = clock() - t_start;
+
+	// Update average timestep time on this grid
+	timeav_timestep *= (t - 1);
+	timeav_timestep += ((double)secs) / CLOCKS_PER_SEC;
+	timeav_timestep /= t;
+
+	if (t % L_GRID_OUT_FREQ == 0) {
+		// Performance data to logfile
+		*GridUtils::logfile << "Grid " << level << ": Time stepping taking an average of " << timeav_timestep * 1000 << "ms" << std::endl;
+	}
+
+	// MPI COMMUNICATION //
+#ifdef L_BUILD_FOR_MPI
+
+	// Launch communication on this grid by passing its level and region number
+	if (!bOverlapComms)
+		MpiManager::getInstance()->mpi_communicateStart(level, region_number);
+
+#ifdef L_MPI_ASYNC_SUBCYCLING
+	// Exchanges of the sub-grids have been hidden behind the update of this grid
+	for (GridObj * sg : subGrid)
+		MpiManager::getInstance()->mpi_communicateFinish(sg->level, sg->region_number);
+#endif
+
+#endif
+
+}
+
+
+
+// *****************************************************************************
+/// \brief	Stream-collide update of the grid.
+///
+///			Applies the fused kernel where possible or separate stream and 
+///			collide sweeps with the IBM step in between otherwise. Only visits
+///			the subset of sites requested so that the sender layers can be 
+///			updated ahead of the interior when overlapping communication.
+///
+///	\param	subcycle	sub-cycle to be performed if called from a subgrid.
+///	\param	sweep		subset of sites to update.
+void GridObj::_LBM_streamCollide_opt(int subcycle, eSweepSites sweep)
+{
+	// Get object manager instance
+	ObjectManager *objman = ObjectManager::getInstance();
+
+#ifdef L_USE_FUSED_KERNEL
+	// Only fuse if there is no IBM step to be performed between stream and collide
+	bool bFusedSweep = true;
+#ifdef L_IBM_ON
+	if (objman->hasIBMBodies[level]) bFusedSweep = false;
+#endif
+#if (defined L_ENABLE_OPENMP && defined L_REGULARISED_BOUNDARIES)
+	// Extrapolation at corners updates sites in other planes which may already have been collided
+	bFusedSweep = false;
 #endif
 
+	// Single sweep over the grid
+	if (bFusedSweep)
+	{
+		_LBM_fusedStreamCollide_opt(subcycle, sweep);
+	}
+
+	// Otherwise perform separate stream and collide sweeps
+	else
+#endif
+	{
+		// Loop over grid
+#ifdef L_ENABLE_OPENMP
+#pragma omp parallel for
+#endif
+		for (int i = 0; i < N_lim; ++i)
+		{
+#if (defined L_USE_SIMD_COLLISION && !defined L_IBM_ON)
+			// Sites in this plane to be collided together
+			std::vector<int> collideIds;
+			collideIds.reserve(M_lim * K_lim);
+#endif
+#ifdef L_USE_SPARSE_LATTICE
+			// Only visit active sites
+			for (int s = sparsePlaneStart[i]; s < sparsePlaneStart[i + 1]; ++s)
+			{
+				{
+					// Local index and type
+					int id = sparseSites[s];
+					int j = (id / K_lim) % M_lim;
+					int k = id % K_lim;
+#else
+			for (int j = 0; j < M_lim; ++j)
+			{
+				for (int k = 0; k < K_lim; ++k)
+				{
+					// Local index and type
+					int id = k + j * K_lim + i * K_lim * M_lim;
+#endif
+					// Only visit the sites of this sweep
+					if (!_LBM_inSweep(id, sweep)) continue;
+
+					eType type_local = LatTyp[id];
+
+					// IGNORE THESE SITES //
+					if (type_local == eRefined || type_local == eSolid
+#ifndef L_REGULARISED_BOUNDARIES
+						|| type_local == eVelocity
+#endif
+						) continue;
+
+					// STREAM //
+					_LBM_stream_opt(i, j, k, id, type_local, subcycle);
+
+					// REGULARISED BCs //
+#ifdef L_REGULARISED_BOUNDARIES
+					if (type_local == eVelocity || type_local == ePressure)
+						_LBM_regularised_opt(i, j, k, id, type_local, subcycle);
+#endif
+
+					// MACROSCOPIC //
+					_LBM_macro_opt(i, j, k, id, type_local);
+
+					// If IBM is on then split loop and perform IBM step
+#ifdef L_IBM_ON
+				}
+			}
+		}
+
+		// Set post-LBM macros
+		if (objman->hasFlexibleBodies[level])
+			u_n = u;
+
+		// Perform IBM steps (interpolate, force calc, spread and update macro)
+		if (objman->hasIBMBodies[level])
+			objman->ibm_apply(this, true);
+
+
+		// Loop over grid
+#ifdef L_ENABLE_OPENMP
+#pragma omp parallel for
+#endif
+		for (int i = 0; i < N_lim; ++i)
+		{
+#ifdef L_USE_SIMD_COLLISION
+			// Sites in this plane to be collided together
+			std::vector<int> collideIds;
+			collideIds.reserve(M_lim * K_lim);
+#endif
+#ifdef L_USE_SPARSE_LATTICE
+			// Only visit active sites
+			for (int s = sparsePlaneStart[i]; s < sparsePlaneStart[i + 1]; ++s)
+			{
+				{
+					// Local index and type
+					int id = sparseSites[s];
+					int j = (id / K_lim) % M_lim;
+					int k = id % K_lim;
+#else
+			for (int j = 0; j < M_lim; ++j)
+			{
+				for (int k = 0; k < K_lim; ++k)
+				{
+					// Local index and type
+					int id = k + j * K_lim + i * K_lim * M_lim;
+#endif
+					// Only visit the sites of this sweep
+					if (!_LBM_inSweep(id, sweep)) continue;
+
+					eType type_local = LatTyp[id];
+
+#endif
+
+					// FORCING //
+#if (defined L_IBM_ON || defined L_GRAVITY_ON)
+					// Do not force solid sites
+					if (type_local != eSolid)
+						_LBM_forceGrid_opt(id);
+#endif
+					// COLLIDE //
+					if (type_local != eTransitionToCoarser) // Do not collide on UpperTL
+					{ 
+
+#ifdef L_USE_KBC_COLLISION
+						_LBM_kbcCollide_opt(id);
+#elif defined L_USE_SIMD_COLLISION
+						collideIds.push_back(id);
+#else
+						_LBM_collide_opt(id);
+#endif
+					}
+
+				}
+			}
+
+#ifdef L_USE_SIMD_COLLISION
+			// Collide the sites of this plane in batches
+			_LBM_collideSites_opt(collideIds);
+#endif
+		}
+	}
+
+}
+
+#ifdef L_USE_FUSED_KERNEL
+// *****************************************************************************
+/// \brief	Fused stream-collide sweep.
+///
+///			Performs the pull-stream, macroscopic update, forcing and collision 
+///			of each site in a single pass over the grid so that each population 
+///			is read once and written once per time step. Streaming uses the 
+///			precomputed stream tables so bulk sites pull using fixed offsets 
+///			into the structure-of-arrays layout. Regularised BCs remain a 
+///			separate step applied after streaming. Not used when an IBM step is
+///			required on this level as the IBM force must be computed from the 
+///			post-stream velocity field of the whole grid before any collision.
+///
+///	\param	subcycle	sub-cycle to be performed if called from a subgrid.
+///	\param	sweep		subset of sites to update.
+void GridObj::_LBM_fusedStreamCollide_opt(int subcycle, eSweepSites sweep)
+{
 	// Loop over grid
 #ifdef L_ENABLE_OPENMP
 #pragma omp parallel for
 #endif
 	for (int i = 0; i < N_lim; ++i)
 	{
+#ifdef L_USE_SIMD_COLLISION
+		// Sites in this plane to be collided together
+		std::vector<int> collideIds;
+		collideIds.reserve(M_lim * K_lim);
+#endif
+#ifdef L_USE_SPARSE_LATTICE
+		// Only visit active sites
+		for (int s = sparsePlaneStart[i]; s < sparsePlaneStart[i + 1]; ++s)
+		{
+			{
+				// Local index and type
+				int id = sparseSites[s];
+				int j = (id / K_lim) % M_lim;
+				int k = id % K_lim;
+#else
 		for (int j = 0; j < M_lim; ++j)
 		{
 			for (int k = 0; k < K_lim; ++k)
 			{
 				// Local index and type
 				int id = k + j * K_lim + i * K_lim * M_lim;
+#endif
+				// Only visit the sites of this sweep
+				if (!_LBM_inSweep(id, sweep)) continue;
+
 				eType type_local = LatTyp[id];
 
-				// MOMENTUM EXCHANGE //
-#ifdef L_LD_OUT
-				if (type_local == eSolid)
-				{
-					// Compute lift and drag contribution of this site
-					objman->computeLiftDrag(i, j, k, this);
-				}
-#endif
 				// IGNORE THESE SITES //
 				if (type_local == eRefined || type_local == eSolid
 #ifndef L_REGULARISED_BOUNDARIES
@@ -106,20 +447,251 @@ void GridObj::LBM_multi_opt(int subcycle)
 				// MACROSCOPIC //
 				_LBM_macro_opt(i, j, k, id, type_local);
 
-				// If IBM is on then split loop and perform IBM step
-#ifdef L_IBM_ON
+				// FORCING //
+#ifdef L_GRAVITY_ON
+				_LBM_forceGrid_opt(id);
+#endif
+
+				// COLLIDE //
+				if (type_local != eTransitionToCoarser) // Do not collide on UpperTL
+				{
+
+#ifdef L_USE_KBC_COLLISION
+					_LBM_kbcCollide_opt(id);
+#elif defined L_USE_SIMD_COLLISION
+					collideIds.push_back(id);
+#else
+					_LBM_collide_opt(id);
+#endif
+				}
+
 			}
 		}
+
+#ifdef L_USE_SIMD_COLLISION
+		// Collide the sites of this plane in batches
+		_LBM_collideSites_opt(collideIds);
+#endif
 	}
+}
+#endif
 
-	// Set post-LBM macros
-	if (objman->hasFlexibleBodies[level])
-		u_n = u;
+// *****************************************************************************
+/// \brief	Optimised stream operation.
+///
+///			Uses the precomputed stream tables. Bulk sites pull all populations 
+///			using fixed offsets without any boundary checks. Other sites apply
+///			the stored handler to each link and only those links which require
+///			a BC or refinement operation go through the full stream logic.
+///
+/// \param	i	x-index of current site.
+/// \param	j	y-index of current site.
+/// \param	k	z-index of current site.
+///	\param	id	flattened ijk index.
+///	\param	type_local	type of current site.
+///	\param	subcycle	number of sub-cycle being performed.
+void GridObj::_LBM_stream_opt(int i, int j, int k, int id, eType type_local, int subcycle)
+{
+	// Position of the links of this site in the link lists
+	int link = streamLinkStart[id];
 
-	// Perform IBM steps (interpolate, force calc, spread and update macro)
-	if (objman->hasIBMBodies[level])
-		objman->ibm_apply(this, true);
+	// BULK SITE
+	if (link < 0)
+	{
+		// Pull populations from source sites
+		for (int v = 0; v < L_NUM_VELS; ++v)
+			fNew[fIdx(v, id)] = f[fIdx(v, id - streamSrcOffset[v])];
+		return;
+	}
+
+	// Loop over velocities
+	for (int v = 0; v < L_NUM_VELS; ++v, ++link)
+	{
+		switch (streamLinkKind[link])
+		{
+		case eStreamRegular:
+			// Pull population from source site
+			fNew[fIdx(v, id)] = f[fIdx(v, streamLinkSrc[link])];
+			break;
+
+		case eStreamBounceBack:
+			// F value is its opposite (HWBB)
+			fNew[fIdx(v, id)] = f[fIdx(GridUtils::getOpposite(v), id)];
+			break;
+
+		case eStreamExplode:
+			// Filled from the parent on the first sub-cycle only
+			if (subcycle != 0) fNew[fIdx(v, id)] = f[fIdx(v, streamLinkSrc[link])];
+			break;
+
+		case eStreamCoalesce:
+			// Already filled from the child grid
+			break;
+
+		case eStreamBFL:
+			// Already filled from the BFL link table
+			break;
+
+		default:
+			// Apply BC or refinement operation
+			_LBM_streamLink_opt(i, j, k, id, type_local, subcycle, v);
+			break;
+		}
+	}
+
+}
+
+// *****************************************************************************
+/// \brief	Stream a single link applying any boundary conditions.
+///
+///			Applies the full set of checks on the source and current sites. Only
+///			called for links flagged as special in the stream tables.
+///
+/// \param	i	x-index of current site.
+/// \param	j	y-index of current site.
+/// \param	k	z-index of current site.
+///	\param	id	flattened ijk index.
+///	\param	type_local	type of current site.
+///	\param	subcycle	number of sub-cycle being performed.
+///	\param	v	lattice direction.
+void GridObj::_LBM_streamLink_opt(int i, int j, int k, int id, eType type_local, int subcycle, int v)
+{
+	// Get indicies for source site (periodic by default)
+	int src_x = (i - c_opt[v][0] + N_lim) % N_lim;
+	int src_y = (j - c_opt[v][1] + M_lim) % M_lim;
+	int src_z = (k - c_opt[v][2] + K_lim) % K_lim;
+
+	// Source id and type
+	int src_id = src_z + src_y * K_lim + src_x * K_lim * M_lim;
+	eType src_type_local = LatTyp[src_id];
+
+	// SLIP CONDITIONS //
+	if (type_local == eSlip)
+	{
+		if (_LBM_applySpecReflect_opt(i, j, k, id, v)) return;
+	}
+
+	// BOUNCEBACK
+	if (src_type_local == eSolid)
+	{
+		// F value is its opposite (HWBB)
+		fNew[fIdx(v, id)] =
+			f[fIdx(GridUtils::getOpposite(v), id)];
+	}
+
+	// VELOCITY BC (forced equilbirium)
+#ifndef L_REGULARISED_BOUNDARIES
+	else if (src_type_local == eVelocity)
+	{
+
+#ifdef L_VELOCITY_RAMP
+		double rampCoefficient = GridUtils::getVelocityRampCoefficient(t * dt);
+		u[0 + src_id * L_DIMS] = ux_in[j] * rampCoefficient;
+		u[1 + src_id * L_DIMS] = uy_in[j] * rampCoefficient;
+#if (L_DIMS == 3)
+		u[2 + src_id * L_DIMS] = uz_in[j] * rampCoefficient;
+#endif
+
+#endif
+		// Set f to equilibrium (forced equilibrium BC)
+		fNew[fIdx(v, id)] = _LBM_equilibrium_opt(src_id, v);
+	}
+#endif
+
+#if (L_NUM_LEVELS > 0)	// Only need to check these options when using refinement
+	// EXPLODE
+	else if (src_type_local == eTransitionToCoarser && subcycle == 0)
+	{
+		// Pull value from parent TL site
+		_LBM_explode_opt(id, v, src_x, src_y, src_z);
+	}
+
+	// COALESCE
+	else if (src_type_local == eRefined && type_local == eTransitionToFiner)
+	{
+		// Pull average value from child TL cluster to get value leaving fine grid
+		_LBM_coalesce_opt(i, j, k, id, v);
+	}
+#endif
+
+	// REGULAR STREAM
+	else
+	{
+		// Pull population from source site
+		fNew[fIdx(v, id)] = f[fIdx(v, src_id)];
+	}
+
+}
+
+// *****************************************************************************
+/// \brief	Build the precomputed stream tables.
+///
+///			Classifies every site on the grid once so that streaming does not 
+///			need to compute periodic source indices or check site labels on 
+///			every link. A bulk site is a fluid site whose neighbours are all 
+///			fluid and which does not wrap periodically. For all other sites 
+///			the source site and handler of each link are stored in a compact 
+///			list. Links crossing a grid transition are also gathered into 
+///			flat lists so explosion and coalescence can be applied as batched
+///			passes, and likewise links intersecting a BFL body or used for 
+///			momentum exchange on a bounce-back body. Must be rebuilt 
+///			whenever site labels change, which is requested through 
+///			LBM_invalidateStreamTables().
+void GridObj::_LBM_buildStreamTables()
+{
+	// Offsets of pull source sites from the current site
+	for (int v = 0; v < L_NUM_VELS; ++v)
+		streamSrcOffset[v] = c_opt[v][2] + c_opt[v][1] * K_lim + c_opt[v][0] * K_lim * M_lim;
+
+	// Reset tables
+	streamLinkStart.assign(N_lim * M_lim * K_lim, -1);
+	streamLinkSrc.clear();
+	streamLinkKind.clear();
+	explodeLinkDst.clear();
+	explodeLinkSrc.clear();
+#ifdef L_REFINEMENT_INTERPOLATION
+	explodeLinkSub.clear();
+#endif
+	coalesceLinkDst.clear();
+	coalesceLinkSrc.clear();
+	coalesceLinkGrid.clear();
+	bflLinkDst.clear();
+	bflLinkSrc.clear();
+	bflLinkWeight.clear();
+	bflLinkBody.clear();
+	bflLinkMarker.clear();
+
+	// Map BFL sites to the body and marker they hold
+	std::vector<int> bflSiteBody, bflSiteMarker;
+	std::vector<BFLBody> &pBody = ObjectManager::getInstance()->pBody;
+	for (int b = 0; b < static_cast<int>(pBody.size()); ++b)
+	{
+		// Only bodies on this grid
+		if (pBody[b]._Owner->level != level ||
+			pBody[b]._Owner->region_number != region_number) continue;
+
+		if (bflSiteBody.empty())
+		{
+			bflSiteBody.assign(N_lim * M_lim * K_lim, -1);
+			bflSiteMarker.assign(N_lim * M_lim * K_lim, -1);
+		}
+
+		// First marker found in a voxel takes the site
+		for (int m = 0; m < static_cast<int>(pBody[b].markers.size()); ++m)
+		{
+			const BFLMarker &marker = pBody[b].markers[m];
+			int mId = marker.supp_k[0] + marker.supp_j[0] * K_lim + marker.supp_i[0] * K_lim * M_lim;
+			if (bflSiteBody[mId] < 0)
+			{
+				bflSiteBody[mId] = b;
+				bflSiteMarker[mId] = m;
+			}
+		}
+	}
 
+	// Local link storage
+	int src_id[L_NUM_VELS];
+	eStreamLink kind[L_NUM_VELS];
 
 	// Loop over grid
 	for (int i = 0; i < N_lim; ++i)
@@ -131,161 +703,501 @@ void GridObj::LBM_multi_opt(int subcycle)
 				// Local index and type
 				int id = k + j * K_lim + i * K_lim * M_lim;
 				eType type_local = LatTyp[id];
+				bool bBulkSite = (type_local == eFluid);
+
+				// Sites skipped by the sweep do not need transition links
+				bool bSweptSite = !(type_local == eRefined || type_local == eSolid
+#ifndef L_REGULARISED_BOUNDARIES
+					|| type_local == eVelocity
+#endif
+					);
+
+				// Loop over velocities
+				for (int v = 0; v < L_NUM_VELS; ++v)
+				{
+					// Get indicies for source site (periodic by default)
+					int src_x = (i - c_opt[v][0] + N_lim) % N_lim;
+					int src_y = (j - c_opt[v][1] + M_lim) % M_lim;
+					int src_z = (k - c_opt[v][2] + K_lim) % K_lim;
+
+					// Source id and type
+					src_id[v] = src_z + src_y * K_lim + src_x * K_lim * M_lim;
+					eType src_type_local = LatTyp[src_id[v]];
+
+					// Bulk sites must only pull from fluid sites without wrapping
+					if (src_type_local != eFluid ||
+						src_x != i - c_opt[v][0] ||
+						src_y != j - c_opt[v][1] ||
+						src_z != k - c_opt[v][2]) bBulkSite = false;
+
+					// Links intersecting a BFL body
+					if ((type_local == eBFL || src_type_local == eBFL) && !bflSiteBody.empty() &&
+						_LBM_addBFLLink(i, j, k, id, src_id[v], v, bflSiteBody, bflSiteMarker))
+						kind[v] = eStreamBFL;
+
+					// Links which need the full stream logic
+					else if (type_local == eSlip
+#ifndef L_REGULARISED_BOUNDARIES
+						|| src_type_local == eVelocity
+#endif
+						) kind[v] = eStreamSpecial;
 
+#if (L_NUM_LEVELS > 0)
+					// Explosion links pull from the parent site of the source
+					else if (bSweptSite && src_type_local == eTransitionToCoarser)
+					{
+						kind[v] = eStreamExplode;
+						explodeLinkDst.push_back(v + id * L_NUM_VELS);
+						explodeLinkSrc.push_back(
+							CoarseIdxZ[src_z] + 
+							CoarseIdxY[src_y] * parentGrid->K_lim + 
+							CoarseIdxX[src_x] * parentGrid->K_lim * parentGrid->M_lim);
+#ifdef L_REFINEMENT_INTERPOLATION
+						explodeLinkSub.push_back((src_x % 2) | ((src_y % 2) << 1) | ((src_z % 2) << 2));
+#endif
+					}
+
+					// Coalescence links pull from the child cluster of this site
+					else if (src_type_local == eRefined && type_local == eTransitionToFiner)
+					{
+						GridObj *childGrid = _LBM_getChildGrid(i, j, k);
+						if (!childGrid) L_ERROR("Could not get correct grid for coalesce operation.", GridUtils::logfile);
+
+						kind[v] = eStreamCoalesce;
+						coalesceLinkDst.push_back(v + id * L_NUM_VELS);
+						coalesceLinkSrc.push_back(
+							childGrid->FineIdxZ[k] + 
+							childGrid->FineIdxY[j] * childGrid->K_lim + 
+							childGrid->FineIdxX[i] * childGrid->K_lim * childGrid->M_lim);
+						coalesceLinkGrid.push_back(childGrid);
+					}
+#endif
+
+					// Half-way bounce-back links
+					else if (src_type_local == eSolid) kind[v] = eStreamBounceBack;
+
+					// Regular links
+					else kind[v] = eStreamRegular;
+				}
+
+				// Store the links of non-bulk sites
+				if (!bBulkSite)
+				{
+					streamLinkStart[id] = static_cast<int>(streamLinkSrc.size());
+					for (int v = 0; v < L_NUM_VELS; ++v)
+					{
+						streamLinkSrc.push_back(src_id[v]);
+						streamLinkKind.push_back(kind[v]);
+					}
+				}
+			}
+		}
+	}
+
+#ifdef L_LD_OUT
+	// Links from fluid sites into each bounce-back body on this grid
+	_LBM_buildMomexLinks();
+#endif
+
+#if (defined L_BUILD_FOR_MPI && defined L_MPI_OVERLAP)
+	/* Flag the sites which are packed for the halo exchange. Solid sites are 
+	 * not updated by either sweep so are not flagged. */
+	mpiSenderSite.assign(N_lim * M_lim * K_lim, false);
+	for (int i = 0; i < N_lim; ++i)
+	{
+		for (int j = 0; j < M_lim; ++j)
+		{
+			for (int k = 0; k < K_lim; ++k)
+			{
+				int id = k + j * K_lim + i * K_lim * M_lim;
+				if (LatTyp[id] != eSolid && GridUtils::isOnSenderLayer(XPos[i], YPos[j], ZPos[k]))
+					mpiSenderSite[id] = true;
+			}
+		}
+	}
+#endif
+
+#ifdef L_USE_SPARSE_LATTICE
+	// Compact the population storage to the active sites
+	_LBM_buildSparseLattice();
+#endif
+
+	bStreamTablesValid = true;
+
+	*GridUtils::logfile << "Grid " << level << ": Stream tables built with " <<
+		streamLinkSrc.size() / L_NUM_VELS << " boundary sites out of " <<
+		streamLinkStart.size() << " sites" << std::endl;
+#if (L_NUM_LEVELS > 0)
+	*GridUtils::logfile << "Grid " << level << ": Transition tables built with " <<
+		explodeLinkDst.size() << " explosion links and " <<
+		coalesceLinkDst.size() << " coalescence links" << std::endl;
+#endif
+	if (!bflSiteBody.empty())
+		*GridUtils::logfile << "Grid " << level << ": BFL table built with " <<
+			bflLinkDst.size() << " links" << std::endl;
+}
+
+// *****************************************************************************
+/// \brief	Build the momentum exchange links of the bounce-back bodies.
+///
+///			Gathers the links from fluid sites into the solid sites of each 
+///			bounce-back body labelled on this grid. Links are grouped by body so
+///			the force on each body is a reduction over a contiguous range. Solid
+///			sites with no fluid neighbour, walls and solid sites in the halo, 
+///			which are represented on another rank, give no links.
+void GridObj::_LBM_buildMomexLinks()
+{
+	// Reset lists
+	int nBodies = static_cast<int>(ObjectManager::getInstance()->bbbOnGridLevel.size());
+	momexLinkSrc.clear();
+	momexBodyStart.assign(nBodies + 1, 0);
+	if (solidBody.empty()) return;
+
+	// Gather links in site order
+	std::vector<int> linkSrc, linkBody;
+	for (int i = 0; i < N_lim; ++i)
+	{
+		for (int j = 0; j < M_lim; ++j)
+		{
+			for (int k = 0; k < K_lim; ++k)
+			{
+				int id = k + j * K_lim + i * K_lim * M_lim;
+				int body = solidBody[id];
+				if (body < 0 || LatTyp[id] != eSolid) continue;
+
+				// For MPI builds, ignore if part of object is in halo region as represented on another rank
+#ifdef L_BUILD_FOR_MPI
+				if (GridUtils::isOnRecvLayer(XPos[i], YPos[j], ZPos[k])) continue;
+#endif
+
+				for (int v = 0; v < L_NUM_VELS; ++v)
+				{
+					// Fluid site whose population in the opposite direction streams into this site (no periodicity)
+					int src_x = i + c_opt[v][0];
+					int src_y = j + c_opt[v][1];
+					int src_z = k + c_opt[v][2];
+					if (GridUtils::isOffGrid(src_x, src_y, src_z, this) ||
+						LatTyp(src_x, src_y, src_z, M_lim, K_lim) != eFluid) continue;
+
+					int src_id = src_z + src_y * K_lim + src_x * K_lim * M_lim;
+					linkSrc.push_back(GridUtils::getOpposite(v) + src_id * L_NUM_VELS);
+					linkBody.push_back(body);
+					++momexBodyStart[body + 1];
+				}
+			}
+		}
+	}
+
+	// Group by body keeping site order within each body
+	for (int b = 0; b < nBodies; ++b) momexBodyStart[b + 1] += momexBodyStart[b];
+	momexLinkSrc.resize(linkSrc.size());
+	std::vector<int> next(momexBodyStart.begin(), momexBodyStart.end() - 1);
+	for (size_t n = 0; n < linkSrc.size(); ++n)
+		momexLinkSrc[next[linkBody[n]]++] = linkSrc[n];
+
+	*GridUtils::logfile << "Grid " << level << ": Momentum exchange links built with " <<
+		momexLinkSrc.size() << " links" << std::endl;
+}
+
+// *****************************************************************************
+/// \brief	Apply explosion and coalescence to the precomputed transition links.
+///
+///			Batched replacement for applying the refinement operations link by
+///			link during streaming. Explosion copies the parent population into 
+///			the links leaving the coarser transition layer on the first 
+///			sub-cycle. Coalescence averages the child cluster into the links 
+///			leaving the refined region. Values are written into fNew before the
+///			stream-collide sweep which then skips these links.
+///
+///	\param	subcycle	sub-cycle to be performed if called from a subgrid.
+void GridObj::_LBM_transitionLinks_opt(int subcycle)
+{
+	// EXPLODE
+	if (subcycle == 0)
+	{
+		int nExplode = static_cast<int>(explodeLinkDst.size());
+#ifdef L_ENABLE_OPENMP
+#pragma omp parallel for
+#endif
+		for (int n = 0; n < nExplode; ++n)
+		{
+			int v = explodeLinkDst[n] % L_NUM_VELS;
+			int id = explodeLinkDst[n] / L_NUM_VELS;
+
+			// Pull value from parent
+#ifdef L_REFINEMENT_INTERPOLATION
+			fNew[fIdx(v, id)] = _LBM_explodeValue_opt(v, explodeLinkSrc[n], explodeLinkSub[n]);
+#else
+			fNew[fIdx(v, id)] = parentGrid->f[parentGrid->fIdx(v, explodeLinkSrc[n])];
+#endif
+		}
+	}
+
+	// COALESCE
+	int nCoalesce = static_cast<int>(coalesceLinkDst.size());
+#ifdef L_ENABLE_OPENMP
+#pragma omp parallel for
 #endif
+	for (int n = 0; n < nCoalesce; ++n)
+	{
+		int v = coalesceLinkDst[n] % L_NUM_VELS;
+		int id = coalesceLinkDst[n] / L_NUM_VELS;
+		const GridObj *childGrid = coalesceLinkGrid[n];
+		int cId = coalesceLinkSrc[n];
 
-				// FORCING //
-#if (defined L_IBM_ON || defined L_GRAVITY_ON)
-				// Do not force solid sites
-				if (type_local != eSolid)
-					_LBM_forceGrid_opt(id);
-#endif
-				// COLLIDE //
-				if (type_local != eTransitionToCoarser) // Do not collide on UpperTL
-				{ 
+		// Offsets of the child cluster
+		int di = childGrid->K_lim * childGrid->M_lim;
+		int dj = childGrid->K_lim;
 
-#ifdef L_USE_KBC_COLLISION
-					_LBM_kbcCollide_opt(id);
+		// Pull average value of f from child cluster
+		double fNew_local = 0.0;
+		for (int ii = 0; ii < 2; ++ii) {
+			for (int jj = 0; jj < 2; ++jj) {
+#if (L_DIMS == 3)
+				for (int kk = 0; kk < 2; ++kk)
 #else
-					_LBM_collide_opt(id);
+				int kk = 0;
 #endif
+				{
+					fNew_local += childGrid->f[childGrid->fIdx(v, cId + ii * di + jj * dj + kk)];
 				}
-
 			}
 		}
-	}
 
-	// Swap distributions
-	f.swap(fNew);
+#if (L_DIMS == 3)
+		fNew_local /= 8.0;
+#else
+		fNew_local /= 4.0;
+#endif
 
-#ifdef L_MOMEX_DEBUG
-	if (level == objman->bbbOnGridLevel && region_number == objman->bbbOnGridReg)
-	{
-		// Close file for momentum exchange information (call before t increments)
-		objman->toggleDebugStream(this);
+		// Store back in memory
+		fNew[fIdx(v, id)] = fNew_local;
 	}
-#endif
+}
 
-	// Increment internal loop counter
-	++t;
+// *****************************************************************************
+/// \brief	Add a link to the BFL link table.
+///
+///			Decides whether a pull link intersects the wall of a BFL body. BFL
+///			site may be either source or current site and so this method will
+///			decide the appropriate action based on each case as well as wall
+///			location. The populations and interpolation weight used to apply
+///			the condition are stored so that streaming does not need to look up
+///			the marker of the site.
+///
+/// \param	i			x-index of current site.
+/// \param	j			y-index of current site.
+/// \param	k			z-index of current site.
+/// \param	id			flattened ijk index.
+///	\param	src_id		flattened ijk index of the source site.
+///	\param	v			lattice direction.
+///	\param	siteBody	BFL body of the marker held by each site (-1 if none).
+///	\param	siteMarker	marker held by each site (-1 if none).
+///	\return	boolean indicator as to whether the link is handled by the BFL
+///			table. If not, the link is streamed as usual.
+bool GridObj::_LBM_addBFLLink(int i, int j, int k, int id, int src_id, int v,
+	const std::vector<int> &siteBody, const std::vector<int> &siteMarker)
+{
+	/* BFL can be applied easily if only one of the two sites are labelled as BFL.
+	 * If both are labelled BFL, the algorithm here checks to see if there is any
+	 * intersecting wall assuming only one wall per voxel. If there are two
+	 * intersecting walls, then the BC favours the nearest. */
 
-	// Get time of loop
-	secs = clock() - t_start;
+	std::vector<BFLBody> &pBody = ObjectManager::getInstance()->pBody;
+	int v_opp = GridUtils::getOpposite(v);
+	double q_link = -1;		// Set to invalid value by default
+	bool bCurrentSiteBflSite = true;
+	int bodyID = -1;
+	int markerID = -1;
 
-	// Update average timestep time on this grid
-	timeav_timestep *= (t - 1);
-	timeav_timestep += ((double)secs) / CLOCKS_PER_SEC;
-	timeav_timestep /= t;
+	// Check whether current site is BFL site and get Q value
+	if (LatTyp[id] == eBFL && siteBody[id] >= 0)
+	{
+		bodyID = siteBody[id];
+		markerID = siteMarker[id];
+		q_link = pBody[bodyID].Q[v_opp + L_NUM_VELS * markerID];
+	}
 
-	if (t % L_GRID_OUT_FREQ == 0) {
-		// Performance data to logfile
-		*GridUtils::logfile << "Grid " << level << ": Time stepping taking an average of " << timeav_timestep * 1000 << "ms" << std::endl;
+	/* If q value is valid then current site is a BFL site with link-intersecting
+	 * wall. If not, then we can check to see if the source site is a BFL site
+	 * and has a link-intersecting wall. */
+	if (q_link == -1 && siteBody[src_id] >= 0)
+	{
+		bCurrentSiteBflSite = false;
+		bodyID = siteBody[src_id];
+		markerID = siteMarker[src_id];
+		q_link = pBody[bodyID].Q[v + L_NUM_VELS * markerID];
 	}
 
-	// MPI COMMUNICATION //
-#ifdef L_BUILD_FOR_MPI
+	// No intersection so regular stream
+	if (q_link == -1) return false;
 
-	// Launch communication on this grid by passing its level and region number
-	MpiManager::getInstance()->mpi_communicate(level, region_number);
+	// Momentum exchange -- don't include forces computed on halo sites to avoid duplicates
+	if (GridUtils::isOnRecvLayer(XPos[i], YPos[j], ZPos[k])) markerID = -1;
 
-#endif
+	// Intersection and wall must be nearer current site than source site //
+	if (bCurrentSiteBflSite)
+	{
+		/* Here, the wall can be considered to be closer to BFL site but we need
+		 * to perform interpolation on pre-stream values pointing towards the
+		 * wall from the BFL site and one site further away from the wall. This
+		 * stencil site can be found from the pull direction unit vector. */
+		int stencil_i = i + c_opt[v][0];
+		int stencil_j = j + c_opt[v][1];
+		int stencil_k = k + c_opt[v][2];
 
-}
+		/* Only apply if the stencil is valid on this rank. Otherwise, doesn't
+		 * matter as it is likely a halo site which will get overwritten anyway. */
+		if (stencil_i < 0 || stencil_i >= N_lim ||
+			stencil_j < 0 || stencil_j >= M_lim ||
+			stencil_k < 0 || stencil_k >= K_lim) return true;
+
+		/* Interpolate pre-stream value then perform bounceback stream. The 
+		 * current site is used as the stencil which reduces to half-way 
+		 * bounce-back of the reflected population. Interpolating from the next 
+		 * site along the link is only stable for q < 0.5 and the Q values are
+		 * not restricted to the near half of the link. */
+		bflLinkSrc.push_back(v_opp + id * L_NUM_VELS);
+		bflLinkWeight.push_back(1 - 2 * q_link);
+	}
+
+	// Intersection and wall must be nearer source site than current site //
+	else
+	{
+		/* Wall must be nearer the source site than the current site. We can
+		 * compute bounced value at current site from post-stream interpolated
+		 * values pointing away from the wall. */
+		bflLinkSrc.push_back(v + id * L_NUM_VELS);
+		bflLinkWeight.push_back((1 - 2 * q_link) / (2 - 2 * q_link));
+	}
 
+	bflLinkDst.push_back(v + id * L_NUM_VELS);
+	bflLinkBody.push_back(bodyID);
+	bflLinkMarker.push_back(markerID);
 
+	return true;
+}
 
 // *****************************************************************************
-/// \brief	Optimised stream operation.
+/// \brief	Apply the BFL condition to the precomputed BFL links.
 ///
-/// \param	i	x-index of current site.
-/// \param	j	y-index of current site.
-/// \param	k	z-index of current site.
-///	\param	id	flattened ijk index.
-///	\param	type_local	type of current site.
-///	\param	subcycle	number of sub-cycle being performed.
-void GridObj::_LBM_stream_opt(int i, int j, int k, int id, eType type_local, int subcycle)
+///			Both the near and far wall cases reduce to an interpolation between
+///			the reflected population and a second pre-stream population so the
+///			links are applied in a single pass before the stream-collide sweep
+///			which then skips these links. Momentum exchange forces are then
+///			added to the markers.
+void GridObj::_LBM_bflLinks_opt()
 {
+	int nLinks = static_cast<int>(bflLinkDst.size());
+#ifdef L_ENABLE_OPENMP
+#pragma omp parallel for
+#endif
+	for (int n = 0; n < nLinks; ++n)
+	{
+		int v = bflLinkDst[n] % L_NUM_VELS;
+		int id = bflLinkDst[n] / L_NUM_VELS;
 
-	// Local value to save multiple loads
-	eType src_type_local;
+		// Interpolate between the reflected and stored populations
+		double fOpp = f[fIdx(GridUtils::getOpposite(v), id)];
+		double fSrc = f[fIdx(bflLinkSrc[n] % L_NUM_VELS, bflLinkSrc[n] / L_NUM_VELS)];
+		fNew[fIdx(v, id)] = fOpp + bflLinkWeight[n] * (fSrc - fOpp);
+	}
 
-	// Loop over velocities
-	for (int v = 0; v < L_NUM_VELS; ++v)
+#ifdef L_LD_OUT
+	// Momentum exchange
+	ObjectManager *objman = ObjectManager::getInstance();
+	for (int n = 0; n < nLinks; ++n)
 	{
-		// Get indicies for source site (periodic by default)
-		int src_x = (i - c_opt[v][0] + N_lim) % N_lim;
-		int src_y = (j - c_opt[v][1] + M_lim) % M_lim;
-		int src_z = (k - c_opt[v][2] + K_lim) % K_lim;
-
-		// Source id and type
-		int src_id = src_z + src_y * K_lim + src_x * K_lim * M_lim;
-		src_type_local = LatTyp[src_id];
+		if (bflLinkMarker[n] < 0) continue;
+		objman->computeLiftDrag(bflLinkDst[n] % L_NUM_VELS, bflLinkDst[n] / L_NUM_VELS,
+			this, bflLinkBody[n], bflLinkMarker[n]);
+	}
+#endif
+}
 
-		// BFL BOUNCEBACK
-		if (type_local == eBFL || src_type_local == eBFL)
-		{
-			// Try to apply BFL BC on streaming link
-			if (_LBM_applyBFL_opt(id, src_id, v, i, j, k, src_x, src_y, src_z)) continue;
-		}
+#ifdef L_REFINEMENT_INTERPOLATION
+// *****************************************************************************
+/// \brief	Get the value of a population exploded from the parent grid.
+///
+///			The parent population is reconstructed linearly across the parent
+///			cell using the gradient from the neighbouring parent sites in each
+///			direction. Neighbours which are not updated on the parent are left
+///			out and a one-sided gradient used instead. The children sit a 
+///			quarter of a parent spacing either side of the centre so the 
+///			corrections cancel over the cluster and mass is conserved.
+///
+///	\param	v		lattice direction.
+///	\param	pId		flattened ijk index of the parent site.
+///	\param	sub		position of the source site in its parent cell (bit d 
+///					set if on the positive side in direction d).
+///	\returns		value of the population.
+double GridObj::_LBM_explodeValue_opt(int v, int pId, int sub)
+{
+	GridObj *p = parentGrid;
+	double fParent = p->f[p->fIdx(v, pId)];
+	double fExplode = fParent;
 
-		// SLIP CONDITIONS //
-		if (type_local == eSlip)
-		{
-			if (_LBM_applySpecReflect_opt(i, j, k, id, v)) continue;
-		}
+	// Parent indices
+	int pInd[3] = { pId / (p->K_lim * p->M_lim), (pId / p->K_lim) % p->M_lim, pId % p->K_lim };
+	int pLim[3] = { p->N_lim, p->M_lim, p->K_lim };
+	int pStride[3] = { p->K_lim * p->M_lim, p->K_lim, 1 };
 
-		// BOUNCEBACK
-		if (src_type_local == eSolid)
+	for (int d = 0; d < L_DIMS; ++d)
+	{
+		// Values at the neighbours either side
+		double fNb[2] = { 0.0, 0.0 };
+		bool bUsable[2];
+		for (int s = 0; s < 2; ++s)
 		{
-			// F value is its opposite (HWBB)
-			fNew[v + id * L_NUM_VELS] =
-				f[GridUtils::getOpposite(v) + id * L_NUM_VELS];
+			int dir = 2 * s - 1;
+			int nId = pId + dir * pStride[d];
+			bUsable[s] = (pInd[d] + dir >= 0 && pInd[d] + dir < pLim[d] &&
+				(p->LatTyp[nId] == eFluid || p->LatTyp[nId] == eTransitionToFiner));
+			if (bUsable[s]) fNb[s] = p->f[p->fIdx(v, nId)];
 		}
 
-		// VELOCITY BC (forced equilbirium)
-#ifndef L_REGULARISED_BOUNDARIES
-		else if (src_type_local == eVelocity)
-		{
-
-#ifdef L_VELOCITY_RAMP
-			double rampCoefficient = GridUtils::getVelocityRampCoefficient(t * dt);
-			u[0 + src_id * L_DIMS] = ux_in[j] * rampCoefficient;
-			u[1 + src_id * L_DIMS] = uy_in[j] * rampCoefficient;
-#if (L_DIMS == 3)
-			u[2 + src_id * L_DIMS] = uz_in[j] * rampCoefficient;
-#endif
-
-#endif
-			// Set f to equilibrium (forced equilibrium BC)
-			fNew[v + id * L_NUM_VELS] = _LBM_equilibrium_opt(src_id, v);
-		}
-#endif
+		// Gradient per parent spacing
+		double grad = 0.0;
+		if (bUsable[0] && bUsable[1]) grad = 0.5 * (fNb[1] - fNb[0]);
+		else if (bUsable[1]) grad = fNb[1] - fParent;
+		else if (bUsable[0]) grad = fParent - fNb[0];
 
-#if (L_NUM_LEVELS > 0)	// Only need to check these options when using refinement
-		// EXPLODE
-		else if (src_type_local == eTransitionToCoarser && subcycle == 0)
-		{
-			// Pull value from parent TL site
-			_LBM_explode_opt(id, v, src_x, src_y, src_z);
-		}
+		fExplode += (((sub >> d) & 1) ? 0.25 : -0.25) * grad;
+	}
 
-		// COALESCE
-		else if (src_type_local == eRefined && type_local == eTransitionToFiner)
-		{
-			// Pull average value from child TL cluster to get value leaving fine grid
-			_LBM_coalesce_opt(i, j, k, id, v);
-		}
+	return fExplode;
+}
 #endif
 
-		// REGULAR STREAM
-		else
-		{
-			// Pull population from source site
-			fNew[v + id * L_NUM_VELS] = f[v + src_id * L_NUM_VELS];
-		}
-
+// *****************************************************************************
+/// \brief	Get the child grid which covers a site on this grid.
+///
+///			Uses the precomputed index maps of each sub-grid so no positions
+///			need to be compared.
+///
+/// \param	i	x-index of the site.
+/// \param	j	y-index of the site.
+/// \param	k	z-index of the site.
+///	\returns	a pointer to the sub-grid or nullptr if the site is not refined.
+GridObj * GridObj::_LBM_getChildGrid(int i, int j, int k)
+{
+	for (GridObj * sg : subGrid)
+	{
+		if (sg->FineIdxX[i] >= 0 && sg->FineIdxY[j] >= 0 && sg->FineIdxZ[k] >= 0)
+			return sg;
 	}
+	return nullptr;
+}
 
+// *****************************************************************************
+/// \brief	Flag the stream tables for rebuilding.
+///
+///			Must be called whenever site labels on this grid are changed, for 
+///			example when bodies are labelled or moved, so that the tables are
+///			rebuilt before the next time step.
+void GridObj::LBM_invalidateStreamTables()
+{
+	bStreamTablesValid = false;
 }
 
 // *****************************************************************************
@@ -302,7 +1214,8 @@ void GridObj::_LBM_stream_opt(int i, int j, int k, int id, eType type_local, int
 ///	\param	id			flattened ijk index.
 ///	\param	type		lattice type (assumed to be either velocity or pressure)
 ///	\param	subcycle	number of sub-cycle being performed.
-void GridObj::_LBM_regularised_opt(int i, int j, int k, int id, eType type, int subcycle)
+///	\param	fSite		post-stream populations of the site (updated in place).
+void GridObj::_LBM_regularised_opt(int i, int j, int k, int id, eType type, int subcycle, double *fSite)
 {
 	// Declarations
 	std::vector<double> tmpVelVector(3, 0);
@@ -371,13 +1284,13 @@ void GridObj::_LBM_regularised_opt(int i, int j, int k, int id, eType type, int
 			if (c_opt[v][normalDirection] == -normalVector[normalDirection])
 			{
 				// Add to known momentum leaving the domain
-				f_plus += fNew[v + id * L_NUM_VELS];
+				f_plus += fSite[v];
 
 			}
 			// If it is perpendicular to wall part of f_zero
 			else if (c_opt[v][normalDirection] == 0)
 			{
-				f_zero += fNew[v + id * L_NUM_VELS];
+				f_zero += fSite[v];
 			}
 		}
 
@@ -432,8 +1345,8 @@ void GridObj::_LBM_regularised_opt(int i, int j, int k, int id, eType type, int
 		// Unknowns for a normal case share the normal vector components
 		if (edgeCount == 1 && c_opt[v][normalDirection] == normalVector[normalDirection])
 		{
-			fNew[v + id * L_NUM_VELS] = _LBM_equilibrium_opt(id, v) +
-				(fNew[GridUtils::getOpposite(v) + id * L_NUM_VELS] - _LBM_equilibrium_opt(id, GridUtils::getOpposite(v)));
+			fSite[v] = _LBM_equilibrium_opt(id, v) +
+				(fSite[GridUtils::getOpposite(v)] - _LBM_equilibrium_opt(id, GridUtils::getOpposite(v)));
 		}
 
 		// Unknown in edge cases are ones who share at least one of the normal components
@@ -459,18 +1372,18 @@ void GridObj::_LBM_regularised_opt(int i, int j, int k, int id, eType type, int
 			// If a buried link then set to feq (plane with normal parallel to normal of boundary)
 			if (dp == 0 && mag > 1.0)
 			{
-				fNew[v + id * L_NUM_VELS] = _LBM_equilibrium_opt(id, v);
+				fSite[v] = _LBM_equilibrium_opt(id, v);
 			}
 			// Else apply non-equilbrium bounceback
 			else
 			{
-				fNew[v + id * L_NUM_VELS] = _LBM_equilibrium_opt(id, v) +
-					(fNew[GridUtils::getOpposite(v) + id * L_NUM_VELS] - _LBM_equilibrium_opt(id, GridUtils::getOpposite(v)));
+				fSite[v] = _LBM_equilibrium_opt(id, v) +
+					(fSite[GridUtils::getOpposite(v)] - _LBM_equilibrium_opt(id, GridUtils::getOpposite(v)));
 			}
 		}
 
 		// Store off-equilibrium and update stress components
-		fneq = fNew[v + id * L_NUM_VELS] - _LBM_equilibrium_opt(id, v);
+		fneq = fSite[v] - _LBM_equilibrium_opt(id, v);
 
 		// Compute off-equilibrium stress components
 		Sxx += c_opt[v][eXDirection] * c_opt[v][eXDirection] * fneq;
@@ -487,7 +1400,7 @@ void GridObj::_LBM_regularised_opt(int i, int j, int k, int id, eType type, int
 	// Compute regularised non-equilibrium components and add to feq to get new populations
 	for (int v = 0; v < L_NUM_VELS; v++)
 	{
-		fNew[v + id * L_NUM_VELS] = _LBM_equilibrium_opt(id, v) +
+		fSite[v] = _LBM_equilibrium_opt(id, v) +
 			(w[v] / (2.0 * SQ(cs) * SQ(cs))) *
 			(
 			((c_opt[v][eXDirection] * c_opt[v][eXDirection] - SQ(cs)) * Sxx) +
@@ -501,6 +1414,29 @@ void GridObj::_LBM_regularised_opt(int i, int j, int k, int id, eType type, int
 
 }
 
+// *****************************************************************************
+/// \brief	Optimised regularised BC procedure applied to the post-stream 
+///			populations of a site stored in fNew.
+///
+/// \param	i			x-index of current site.
+/// \param	j			y-index of current site.
+/// \param	k			z-index of current site.
+///	\param	id			flattened ijk index.
+///	\param	type		lattice type (assumed to be either velocity or pressure)
+///	\param	subcycle	number of sub-cycle being performed.
+void GridObj::_LBM_regularised_opt(int i, int j, int k, int id, eType type, int subcycle)
+{
+	// Copy populations to a local array, apply the BC and copy back
+	double fSite[L_NUM_VELS];
+	for (int v = 0; v < L_NUM_VELS; ++v)
+		fSite[v] = fNew[fIdx(v, id)];
+
+	_LBM_regularised_opt(i, j, k, id, type, subcycle, fSite);
+
+	for (int v = 0; v < L_NUM_VELS; ++v)
+		fNew[fIdx(v, id)] = fSite[v];
+}
+
 // *****************************************************************************
 /// \brief	Optimised application of specular reflection slip BC.
 ///
@@ -526,42 +1462,42 @@ bool GridObj::_LBM_applySpecReflect_opt(int i, int j, int k, int id, int v)
 		// Left slip
 		if (normVec[eXDirection] == 1 && c_opt[v][eXDirection] == 1)
 		{
-			fNew[v + id * L_NUM_VELS] = f[GridUtils::getReflect(v, eXDirection) + id * L_NUM_VELS];
+			fNew[fIdx(v, id)] = f[fIdx(GridUtils::getReflect(v, eXDirection), id)];
 			return true;
 		}
 
 		// Right slip
 		if (normVec[eXDirection] == -1 && c_opt[v][eXDirection] == -1)
 		{
-			fNew[v + id * L_NUM_VELS] = f[GridUtils::getReflect(v, eXDirection) + id * L_NUM_VELS];
+			fNew[fIdx(v, id)] = f[fIdx(GridUtils::getReflect(v, eXDirection), id)];
 			return true;
 		}
 
 		// Bottom slip
 		if (normVec[eYDirection] == 1 && c_opt[v][eYDirection] == 1)
 		{
-			fNew[v + id * L_NUM_VELS] = f[GridUtils::getReflect(v, eYDirection) + id * L_NUM_VELS];
+			fNew[fIdx(v, id)] = f[fIdx(GridUtils::getReflect(v, eYDirection), id)];
 			return true;
 		}
 
 		// Top slip
 		if (normVec[eYDirection] == -1 && c_opt[v][eYDirection] == -1)
 		{
-			fNew[v + id * L_NUM_VELS] = f[GridUtils::getReflect(v, eYDirection) + id * L_NUM_VELS];
+			fNew[fIdx(v, id)] = f[fIdx(GridUtils::getReflect(v, eYDirection), id)];
 			return true;
 		}
 
 		// Front slip
 		if (normVec[eZDirection] == 1 && c_opt[v][eZDirection] == 1)
 		{
-			fNew[v + id * L_NUM_VELS] = f[GridUtils::getReflect(v, eZDirection) + id * L_NUM_VELS];
+			fNew[fIdx(v, id)] = f[fIdx(GridUtils::getReflect(v, eZDirection), id)];
 			return true;
 		}
 
 		// Back slip
 		if (normVec[eZDirection] == -1 && c_opt[v][eZDirection] == -1)
 		{
-			fNew[v + id * L_NUM_VELS] = f[GridUtils::getReflect(v, eZDirection) + id * L_NUM_VELS];
+			fNew[fIdx(v, id)] = f[fIdx(GridUtils::getReflect(v, eZDirection), id)];
 			return true;
 		}
 
@@ -583,7 +1519,7 @@ bool GridObj::_LBM_applySpecReflect_opt(int i, int j, int k, int id, int v)
 void GridObj::_LBM_coalesce_opt(int i, int j, int k, int id, int v) {
 
 	// Get pointer to appropriate child grid
-	GridObj *childGrid = GridUtils::getSubGrid(i, j, k, this);
+	GridObj *childGrid = _LBM_getChildGrid(i, j, k);
 	if (!childGrid) L_ERROR("Could not get correct grid for coalesce operation.", GridUtils::logfile);
 
 	// Get sizes
@@ -591,11 +1527,7 @@ void GridObj::_LBM_coalesce_opt(int i, int j, int k, int id, int v) {
 	int cK_lim = childGrid->K_lim;
 
 	// Get indices of child site
-	std::vector<int> cInd =
-		GridUtils::getFineIndices(
-		i, childGrid->CoarseLimsX[eMinimum],
-		j, childGrid->CoarseLimsY[eMinimum],
-		k, childGrid->CoarseLimsZ[eMinimum]);
+	int cInd[3] = { childGrid->FineIdxX[i], childGrid->FineIdxY[j], childGrid->FineIdxZ[k] };
 
 	// Pull average value of f from child cluster
 	double fNew_local = 0.0;
@@ -608,10 +1540,10 @@ void GridObj::_LBM_coalesce_opt(int i, int j, int k, int id, int v) {
 #endif
 			{
 				fNew_local +=
-					childGrid->f[v +
-					(cInd[2] + kk) * L_NUM_VELS +
-					(cInd[1] + jj) * L_NUM_VELS * cK_lim +
-					(cInd[0] + ii) * L_NUM_VELS * cK_lim * cM_lim];
+					childGrid->f[childGrid->fIdx(v,
+					(cInd[2] + kk) +
+					(cInd[1] + jj) * cK_lim +
+					(cInd[0] + ii) * cK_lim * cM_lim)];
 			}
 		}
 	}
@@ -623,7 +1555,7 @@ void GridObj::_LBM_coalesce_opt(int i, int j, int k, int id, int v) {
 #endif
 
 	// Store back in memory
-	fNew[v + id * L_NUM_VELS] = fNew_local;
+	fNew[fIdx(v, id)] = fNew_local;
 
 }
 
@@ -638,20 +1570,23 @@ void GridObj::_LBM_coalesce_opt(int i, int j, int k, int id, int v) {
 void GridObj::_LBM_explode_opt(int id, int v, int src_x, int src_y, int src_z) {
 
 	// Get parent indices
-	std::vector<int> pInd =
-		GridUtils::getCoarseIndices(
-		src_x, CoarseLimsX[eMinimum],
-		src_y, CoarseLimsY[eMinimum],
-		src_z, CoarseLimsZ[eMinimum]);
+	int pInd[3] = { CoarseIdxX[src_x], CoarseIdxY[src_y], CoarseIdxZ[src_z] };
 
 	// Pull value from parent
-	fNew[v + id * L_NUM_VELS] =
-		parentGrid->f[
-			v +
-				pInd[2] * L_NUM_VELS +
-				pInd[1] * L_NUM_VELS * parentGrid->K_lim +
-				pInd[0] * L_NUM_VELS * parentGrid->K_lim * parentGrid->M_lim
-		];
+#ifdef L_REFINEMENT_INTERPOLATION
+	fNew[fIdx(v, id)] = _LBM_explodeValue_opt(v,
+		pInd[2] +
+		pInd[1] * parentGrid->K_lim +
+		pInd[0] * parentGrid->K_lim * parentGrid->M_lim,
+		(src_x % 2) | ((src_y % 2) << 1) | ((src_z % 2) << 2));
+#else
+	fNew[fIdx(v, id)] =
+		parentGrid->f[parentGrid->fIdx(v,
+				pInd[2] +
+				pInd[1] * parentGrid->K_lim +
+				pInd[0] * parentGrid->K_lim * parentGrid->M_lim
+		)];
+#endif
 }
 
 // *****************************************************************************
@@ -705,8 +1640,9 @@ double GridObj::_LBM_equilibrium_opt(int id, int v) {
 ///
 ///	\param	id 		flattened ijk index. 
 /// \param 	omega 	Relaxation frequency. 
+///	\param	fSite	populations of the site.
 /// \return 		Smagorinsky-modified omega value
-double GridObj::_LBM_smag(int id, double omega)
+double GridObj::_LBM_smag(int id, double omega, const double *fSite)
 {
 	// Calculate the non equilibrium stress tensor
 	Matrix2D<double> nonEquiStress(3,3);
@@ -714,7 +1650,7 @@ double GridObj::_LBM_smag(int id, double omega)
  
 	// Compute non-equilibrium values
 	for (int v = 0; v < L_NUM_VELS; ++v)
-		fneq[v] = fNew[v + id*L_NUM_VELS] - _LBM_equilibrium_opt(id, v);
+		fneq[v] = fSite[v] - _LBM_equilibrium_opt(id, v);
 
 	// Calculate diagonal and upper diagonal of the non equilibrium stress tensor
 	for (int i = 0; i < L_DIMS; ++i)
@@ -750,16 +1686,37 @@ double GridObj::_LBM_smag(int id, double omega)
 // *****************************************************************************
 /// \brief	Optimised collision operation.
 ///
-///			BGK collision operator. If Smagnorinksy turned on, will modify the 
-///			value of omega locally.
+///			BGK collision operator applied to the populations of a site stored 
+///			in fNew.
 ///
 /// \param	id	flattened ijk index.
 void GridObj::_LBM_collide_opt(int id)
+{
+	// Copy populations to a local array, collide and copy back
+	double fSite[L_NUM_VELS];
+	for (int v = 0; v < L_NUM_VELS; ++v)
+		fSite[v] = fNew[fIdx(v, id)];
+
+	_LBM_collide_opt(id, fSite);
+
+	for (int v = 0; v < L_NUM_VELS; ++v)
+		fNew[fIdx(v, id)] = fSite[v];
+}
+
+// *****************************************************************************
+/// \brief	Optimised collision operation.
+///
+///			BGK collision operator. If Smagnorinksy turned on, will modify the 
+///			value of omega locally.
+///
+/// \param	id		flattened ijk index.
+///	\param	fSite	populations of the site (updated in place).
+void GridObj::_LBM_collide_opt(int id, double *fSite)
 {
 
 #ifdef L_USE_BGKSMAG
 	// Compute Smagorinksy-modified relaxation
-	double omega_s = _LBM_smag(id, omega);
+	double omega_s = _LBM_smag(id, omega, fSite);
 #else
 	double omega_s = omega;
 #endif
@@ -767,14 +1724,14 @@ void GridObj::_LBM_collide_opt(int id)
 	// Perform collision operation (using omega_s -- modified if using Smagorinksy)
 	for (int v = 0; v < L_NUM_VELS; ++v)
 	{
-		fNew[v + id * L_NUM_VELS] +=
+		fSite[v] +=
 			omega_s *	(
 			_LBM_equilibrium_opt(id, v) -
-			fNew[v + id * L_NUM_VELS]
+			fSite[v]
 			)
 
 #if (defined L_GRAVITY_ON || defined L_IBM_ON)
-			+ force_i[v + id * L_NUM_VELS]
+			+ force_i[fIdx(v, id)]
 #endif
 			;
 	}
@@ -791,6 +1748,29 @@ void GridObj::_LBM_collide_opt(int id)
 ///	\param	type_local	type of site under consideration
 void GridObj::_LBM_macro_opt(int i, int j, int k, int id, eType type_local) {
 
+	// Gather the post-stream populations of the site
+	double fSite[L_NUM_VELS];
+#ifdef L_USE_AA_STREAMING
+	_LBM_aaGather_opt(i, j, k, id, (t % 2 != 0), fSite);
+#else
+	for (int v = 0; v < L_NUM_VELS; ++v)
+		fSite[v] = fNew[fIdx(v, id)];
+#endif
+
+	_LBM_macro_opt(i, j, k, id, type_local, fSite);
+}
+
+// *****************************************************************************
+/// \brief	Optimised macroscopic operation.
+///
+/// \param	i	x-index of current site.
+/// \param	j	y-index of current site.
+/// \param	k	z-index of current site.
+/// \param	id	flattened ijk index.
+///	\param	type_local	type of site under consideration
+///	\param	fSite		post-stream populations of the site.
+void GridObj::_LBM_macro_opt(int i, int j, int k, int id, eType type_local, const double *fSite) {
+
 	// Only update fluid sites (including BFL and Slip) or TL to finer
 	if (type_local == eFluid || type_local == eBFL ||
 		type_local == eTransitionToFiner ||
@@ -809,11 +1789,11 @@ void GridObj::_LBM_macro_opt(int i, int j, int k, int id, eType type_local) {
 		// Sum to find rho and momentum
 		for (int v = 0; v < L_NUM_VELS; ++v)
 		{
-			rho_temp += fNew[v + id * L_NUM_VELS];
-			rhouX_temp += c_opt[v][0] * fNew[v + id * L_NUM_VELS];
-			rhouY_temp += c_opt[v][1] * fNew[v + id * L_NUM_VELS];
+			rho_temp += fSite[v];
+			rhouX_temp += c_opt[v][0] * fSite[v];
+			rhouY_temp += c_opt[v][1] * fSite[v];
 #if (L_DIMS == 3)
-			rhouZ_temp += c_opt[v][2] * fNew[v + id * L_NUM_VELS];
+			rhouZ_temp += c_opt[v][2] * fSite[v];
 #endif
 		}
 
@@ -842,14 +1822,10 @@ void GridObj::_LBM_macro_opt(int i, int j, int k, int id, eType type_local) {
 	if (type_local == eTransitionToFiner) {
 
 		// Get child grid
-		GridObj *childGrid = GridUtils::getSubGrid(i, j, k, this);
+		GridObj *childGrid = _LBM_getChildGrid(i, j, k);
 
 		// Get indices
-		std::vector<int> cInd =
-			GridUtils::getFineIndices(
-			i, childGrid->CoarseLimsX[eMinimum],
-			j, childGrid->CoarseLimsY[eMinimum],
-			k, childGrid->CoarseLimsZ[eMinimum]);
+		int cInd[3] = { childGrid->FineIdxX[i], childGrid->FineIdxY[j], childGrid->FineIdxZ[k] };
 
 		// Get sizes
 		int cM_lim = childGrid->M_lim;
@@ -952,7 +1928,12 @@ void GridObj::_LBM_forceGrid_opt(int id) {
 	double lambda_v, beta_v;
 
 	// Reset the lattice forces
-	memset(&force_i[id * L_NUM_VELS], 0, sizeof(double) * L_NUM_VELS);
+#ifdef L_USE_FUSED_KERNEL
+	for (int v = 0; v < L_NUM_VELS; ++v)
+		force_i[fIdx(v, id)] = 0.0;
+#else
+	memset(&force_i[fIdx(0, id)], 0, sizeof(double) * L_NUM_VELS);
+#endif
 	
 	// Now compute force_i components from Cartesian force vector
 	for (size_t v = 0; v < L_NUM_VELS; v++)
@@ -972,136 +1953,13 @@ void GridObj::_LBM_forceGrid_opt(int id) {
 
 		// Compute force using shorthand sum described above
 		for (int d = 0; d < L_DIMS; d++) {
-			force_i[v + id * L_NUM_VELS] += force_xyz[d + id * L_DIMS] * 
+			force_i[fIdx(v, id)] += force_xyz[d + id * L_DIMS] * 
 				(c_opt[v][d] * (1 + beta_v) - u[d + id * L_DIMS]);
 		}
 
 		// Multiply by lambda_v
-		force_i[v + id * L_NUM_VELS] *= lambda_v;
-	}
-}
-
-// *****************************************************************************
-/// \brief	Optimised BFL application.
-///
-///			Applies the BFL boundary condition at the present site. BFL site may
-///			be either source or current site and so this method will decide
-///			appropriate action based on each case as well as wall location.
-///			Currently only first BFL body considered.
-///
-/// \param	id		flattened ijk index.
-///	\param	src_id	flatted ijk index of the source site.
-///	\param	v		lattice direction.
-///	\param	i		x-index of current site.
-///	\param	j		y-index of current site.
-///	\param	k		z-index of current site.
-///	\param	src_x	x-index of site where value is pulled from.
-///	\param	src_y	y-index of site where value is pulled from.
-///	\param	src_z	z-index of site where value is pulled from.
-///	\return	boolen a indicator as to whether BFL was applied. If not, regular streaming is continued.
-bool GridObj::_LBM_applyBFL_opt(int id, int src_id, int v, int i, int j, int k, int src_x, int src_y, int src_z)
-{
-	/* BFL can be applied easily if only one of the two sites are labelled as BFL.
-	 * If both are labelled BFL, the algorithm here checks to see if there is any 
-	 * intersecting wall assuming only one wall per voxel. If there are two 
-	 * intersecting walls, then the BC favours the nearest. */
-
-	// Initiate marker data store pointer on stack and retrieve Q
-	MarkerData *m_data;
-	double q_link = -1;		// Set to invalid value by default
-	bool bCurrentSiteBflSite = true;
-	int markerID;
-
-	// Check whether current site is BFL site and get Q value
-	if (LatTyp(i, j, k, M_lim, K_lim) == eBFL)
-	{
-		m_data = ObjectManager::getInstance()->pBody[0].getMarkerData(XPos[i], YPos[j], ZPos[k]);
-		markerID = m_data->ID;
-		delete m_data;
-		q_link = ObjectManager::getInstance()->pBody[0].Q[GridUtils::getOpposite(v) + L_NUM_VELS * markerID];
-		
-	}
-
-	/* If q value is valid then current site is a BFL site with link-intersecting 
-	 * wall. If not, then we can check to see if the source site is a BFL site 
-	 * and has a link-intersecting wall. */
-	if (q_link == -1)
-	{
-		m_data = ObjectManager::getInstance()->pBody[0].getMarkerData(XPos[src_x], YPos[src_y], ZPos[src_z]);
-		if (m_data->isValid())
-		{
-			bCurrentSiteBflSite = false;
-			markerID = m_data->ID;
-			q_link = ObjectManager::getInstance()->pBody[0].Q[v + L_NUM_VELS * markerID];
-		}
-		delete m_data;
-	}
-		
-	/* BFL BC must only be applied if the pull link intersects the wall. Wall may
-	 * or may not intersect the pull link hence this method must handle the case 
-	 * where either the source site or the current site is BFL. If 
-	 * q_link == -1, there is no wall intersection between the current
-	 * site and the source site on that link. */
-
-	// No intersection //
-	if (q_link == -1)
-	{
-		// Regular stream as no intersection
-		return false;
+		force_i[fIdx(v, id)] *= lambda_v;
 	}
-
-	// Intersection and wall must be nearer current site than source site //
-	else if (bCurrentSiteBflSite)
-	{
-		/* Here, the wall can be considered to be closer to BFL site but we need 
-		 * to perform interpolation on pre-stream values pointing towards the
-		 * wall from the BFL site and one site further away from the wall. This
-		 * stencil site can be found from the pull direction unit vector. */
-		int stencil_i = i + c_opt[v][0];
-		int stencil_j = j + c_opt[v][1];
-		int stencil_k = k + c_opt[v][2];
-		int stencil_id = k + j * K_lim + i * K_lim * M_lim;
-
-		/* Only apply if the stencil is valid on this rank. Otherwise, doesn't 
-		 * matter as it is likely a halo site which will get overwritten anyway. */
-		if (stencil_i >= 0 && stencil_i < N_lim &&
-			stencil_j >= 0 && stencil_j < M_lim &&
-			stencil_k >= 0 && stencil_k < K_lim)
-		{
-			// Interpolate pre-stream value then perform bounceback stream
-			fNew[v + id * L_NUM_VELS] =
-				(1 - 2 * q_link) *
-				(f[GridUtils::getOpposite(v) + stencil_id * L_NUM_VELS] - f[GridUtils::getOpposite(v) + id * L_NUM_VELS])
-				+ f[GridUtils::getOpposite(v) + id * L_NUM_VELS];
-
-			// Momentum exchange -- don't include forces computed on halo sites to avoid duplicates
-#ifdef L_LD_OUT
-			if (!GridUtils::isOnRecvLayer(XPos[i], YPos[j], ZPos[k]))
-				ObjectManager::getInstance()->computeLiftDrag(v, id, this, markerID);
-#endif
-		}
-	}
-
-	// Intersection and wall must be nearer source site than current site //
-	else
-	{
-		/* Wall must be nearer the source site than the current site. We can 
-		 * compute bounced value at current site from post-stream interpolated
-		 * values pointing away from the wall. */
-		fNew[v + id * L_NUM_VELS] =
-			(1 - 2 * q_link) *
-			((f[v + id * L_NUM_VELS] - f[GridUtils::getOpposite(v) + id * L_NUM_VELS]) / (2 - 2 * q_link))
-			+ f[GridUtils::getOpposite(v) + id * L_NUM_VELS];
-
-		// Momentum exchange -- don't include forces computed on halo sites to avoid duplicates
-#ifdef L_LD_OUT
-		if (!GridUtils::isOnRecvLayer(XPos[i], YPos[j], ZPos[k]))
-			ObjectManager::getInstance()->computeLiftDrag(v, id, this, markerID);
-#endif
-	}
-
-	return true;
-
 }
 
 // *****************************************************************************
@@ -1135,8 +1993,8 @@ void GridObj::_LBM_kbcCollide_opt(int id)
 	{
 
 		// Update feq and store fneq
-		feq[v + id * L_NUM_VELS] = _LBM_equilibrium_opt(id, v);
-		fneq[v] = f[v + id * L_NUM_VELS] - feq[v + id * L_NUM_VELS];
+		feq[fIdx(v, id)] = _LBM_equilibrium_opt(id, v);
+		fneq[v] = f[fIdx(v, id)] - feq[fIdx(v, id)];
 
 		// 2-index and 3-index non-equilibrium moments
 		int idx = 0;
@@ -1269,8 +2127,8 @@ void GridObj::_LBM_kbcCollide_opt(int id)
 	for (int v = 0; v < L_NUM_VELS; v++)
 	{
 		// Compute scalar products
-		top_prod += ds[v] * dh[v] / feq[v + id * L_NUM_VELS];
-		bot_prod += dh[v] * dh[v] / feq[v + id * L_NUM_VELS];
+		top_prod += ds[v] * dh[v] / feq[fIdx(v, id)];
+		bot_prod += dh[v] * dh[v] / feq[fIdx(v, id)];
 	}
 
 	// Compute 1/beta
@@ -1284,12 +2142,12 @@ void GridObj::_LBM_kbcCollide_opt(int id)
 	for (int v = 0; v < L_NUM_VELS; v++)
 	{
 		// Perform collision
-		fNew[v + id * L_NUM_VELS] =
-			f[v + id * L_NUM_VELS] -
+		fNew[fIdx(v, id)] =
+			f[fIdx(v, id)] -
 			(1.0 / beta_m1) * (2.0 * ds[v] + gamma * dh[v])
 
 #if (defined L_GRAVITY_ON || defined L_IBM_ON)
-			+ force_i[v + id * L_NUM_VELS]
+			+ force_i[fIdx(v, id)]
 #endif
 			;
 	}
@@ -1419,7 +2277,9 @@ void GridObj::_LBM_updateInteriorLatticeSite(int i, int j, int k, int subcycle)
 	eType type_local = LatTyp[id];
 
 	// STREAM //
+#ifndef L_USE_AA_STREAMING
 	_LBM_stream_opt(i, j, k, id, type_local, subcycle);
+#endif
 
 	// MACROSCOPIC //
 	_LBM_macro_opt(i, j, k, id, type_local);
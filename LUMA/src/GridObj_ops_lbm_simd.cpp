@@ -0,0 +1,264 @@
+/*
+* --------------------------------------------------------------
+*
+* ------ Lattice Boltzmann @ The University of Manchester ------
+*
+* -------------------------- L-U-M-A ---------------------------
+*
+* Copyright 2019 The University of Manchester
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.*
+*/
+
+#include "../inc/stdafx.h"
+#include "../inc/GridObj.h"
+#include "../inc/SimdDouble.h"
+
+#ifdef L_USE_SIMD_COLLISION
+
+// *****************************************************************************
+/// \brief	Vectorised collision of a list of sites.
+///
+///			BGK collision operator (Smagorinsky-modified and forced if these 
+///			are turned on) applied to L_SIMD_WIDTH sites at a time. The 
+///			populations and macroscopic quantities of each batch are first 
+///			gathered into local arrays which are contiguous across sites so 
+///			that any population layout can be used. The arithmetic is performed
+///			in the same order as in _LBM_equilibrium_opt, _LBM_smag and 
+///			_LBM_collide_opt so the result is identical to the scalar kernel.
+///
+///	\param	ids	flattened ijk indices of the sites to collide.
+void GridObj::_LBM_collideSites_opt(const std::vector<int> &ids)
+{
+	// Equilibrium coefficients for each direction
+	double cA[L_NUM_VELS][L_DIMS];		// c_i
+	double cB[L_NUM_VELS][L_DIMS];		// c_i^2 - cs^2
+	double cC[L_NUM_VELS][3];			// 2 c_i c_j (i < j)
+	double cS[L_NUM_VELS][3][3];		// c_i c_j
+	for (int v = 0; v < L_NUM_VELS; ++v)
+	{
+		for (int d = 0; d < L_DIMS; ++d)
+		{
+			cA[v][d] = c_opt[v][d];
+			cB[v][d] = SQ(c_opt[v][d]) - SQ(cs);
+		}
+		cC[v][0] = 2 * c_opt[v][0] * c_opt[v][1];
+		cC[v][1] = 2 * c_opt[v][0] * c_opt[v][2];
+		cC[v][2] = 2 * c_opt[v][1] * c_opt[v][2];
+		for (int a = 0; a < 3; ++a)
+		{
+			for (int b = 0; b < 3; ++b)
+				cS[v][a][b] = c_opt[v][a] * c_opt[v][b];
+		}
+	}
+	const SimdDouble cs2(SQ(cs));
+	const SimdDouble cs4x2(2.0 * SQ(cs) * SQ(cs));
+	const SimdDouble one(1.0);
+
+#ifdef L_USE_BGKSMAG
+	// Smagorinsky constants
+	const double tau = 1.0 / omega;
+	const SimdDouble tauV(tau);
+	const SimdDouble tau2(SQ(tau));
+	const SimdDouble smagCoeff(2.0 * L_SQRT2 * SQ(L_CSMAG) * L_RHOIN * SQ(cs) * SQ(cs));
+#endif
+
+	// Local lane-contiguous storage
+	int laneId[L_SIMD_WIDTH];
+	double fBlk[L_NUM_VELS][L_SIMD_WIDTH];
+	double rhoBlk[L_SIMD_WIDTH];
+	double uBlk[L_DIMS][L_SIMD_WIDTH];
+#if (defined L_GRAVITY_ON || defined L_IBM_ON)
+	double forceBlk[L_NUM_VELS][L_SIMD_WIDTH];
+#endif
+
+	// Loop over batches of sites
+	const int nSites = static_cast<int>(ids.size());
+	for (int s = 0; s < nSites; s += L_SIMD_WIDTH)
+	{
+		// Number of real sites in batch (spare lanes repeat the last site)
+		int nLanes = std::min(L_SIMD_WIDTH, nSites - s);
+
+		// GATHER //
+		for (int l = 0; l < L_SIMD_WIDTH; ++l)
+		{
+			int id = ids[s + std::min(l, nLanes - 1)];
+			laneId[l] = id;
+			rhoBlk[l] = rho[id];
+			for (int d = 0; d < L_DIMS; ++d)
+				uBlk[d][l] = u[d + id * L_DIMS];
+			for (int v = 0; v < L_NUM_VELS; ++v)
+			{
+				fBlk[v][l] = fNew[fIdx(v, id)];
+#if (defined L_GRAVITY_ON || defined L_IBM_ON)
+				forceBlk[v][l] = force_i[fIdx(v, id)];
+#endif
+			}
+		}
+
+		SimdDouble rhoV = SimdDouble::load(rhoBlk);
+		SimdDouble uV[L_DIMS];
+		for (int d = 0; d < L_DIMS; ++d)
+			uV[d] = SimdDouble::load(uBlk[d]);
+
+		// EQUILIBRIUM //
+		SimdDouble feq[L_NUM_VELS];
+		for (int v = 0; v < L_NUM_VELS; ++v)
+		{
+#if (L_DIMS == 3)
+			SimdDouble A = (SimdDouble(cA[v][0]) * uV[0]) +
+				(SimdDouble(cA[v][1]) * uV[1]) +
+				(SimdDouble(cA[v][2]) * uV[2]);
+
+			SimdDouble B = SimdDouble(cB[v][0]) * (uV[0] * uV[0]) +
+				SimdDouble(cB[v][1]) * (uV[1] * uV[1]) +
+				SimdDouble(cB[v][2]) * (uV[2] * uV[2]) +
+				SimdDouble(cC[v][0]) * uV[0] * uV[1] +
+				SimdDouble(cC[v][1]) * uV[0] * uV[2] +
+				SimdDouble(cC[v][2]) * uV[1] * uV[2];
+#else
+			SimdDouble A = (SimdDouble(cA[v][0]) * uV[0]) +
+				(SimdDouble(cA[v][1]) * uV[1]);
+
+			SimdDouble B = SimdDouble(cB[v][0]) * (uV[0] * uV[0]) +
+				SimdDouble(cB[v][1]) * (uV[1] * uV[1]) +
+				SimdDouble(cC[v][0]) * uV[0] * uV[1];
+#endif
+			feq[v] = rhoV * SimdDouble(w[v]) * (one + (A / cs2) + (B / cs4x2));
+		}
+
+		// Load populations
+		SimdDouble fV[L_NUM_VELS];
+		for (int v = 0; v < L_NUM_VELS; ++v)
+			fV[v] = SimdDouble::load(fBlk[v]);
+
+		// SMAGORINSKY //
+#ifdef L_USE_BGKSMAG
+		SimdDouble fneq[L_NUM_VELS];
+		for (int v = 0; v < L_NUM_VELS; ++v)
+			fneq[v] = fV[v] - feq[v];
+
+		// Upper triangle of the non-equilibrium stress tensor
+		SimdDouble S[3][3];
+		for (int a = 0; a < L_DIMS; ++a)
+		{
+			for (int b = a; b < L_DIMS; ++b)
+			{
+				S[a][b] = SimdDouble(0.0);
+				for (int v = 0; v < L_NUM_VELS; ++v)
+					S[a][b] = S[a][b] + SimdDouble(cS[v][a][b]) * fneq[v];
+				S[b][a] = S[a][b];
+			}
+		}
+
+		// Inner product summed row by row
+		SimdDouble innerProd(0.0);
+		for (int a = 0; a < L_DIMS; ++a)
+		{
+			SimdDouble rowSum(0.0);
+			for (int b = 0; b < L_DIMS; ++b)
+				rowSum = rowSum + S[a][b] * S[a][b];
+			innerProd = innerProd + rowSum;
+		}
+		SimdDouble Q = (SimdDouble(2.0) * innerProd).sqrt();
+
+		// Compute tau correction
+		SimdDouble tau_t = SimdDouble(0.5) * ((tau2 + smagCoeff * Q).sqrt() - tauV);
+		SimdDouble omega_s = one / (tauV + tau_t);
+#else
+		SimdDouble omega_s(omega);
+#endif
+
+		// COLLIDE //
+		for (int v = 0; v < L_NUM_VELS; ++v)
+		{
+			fV[v] = fV[v] + (omega_s * (feq[v] - fV[v])
+#if (defined L_GRAVITY_ON || defined L_IBM_ON)
+				+ SimdDouble::load(forceBlk[v])
+#endif
+				);
+			fV[v].store(fBlk[v]);
+		}
+
+		// SCATTER //
+		for (int l = 0; l < nLanes; ++l)
+		{
+			for (int v = 0; v < L_NUM_VELS; ++v)
+				fNew[fIdx(v, laneId[l])] = fBlk[v][l];
+		}
+	}
+}
+
+#ifdef L_COLLISION_BENCHMARK
+// *****************************************************************************
+/// \brief	Micro-benchmark of the collision kernels.
+///
+///			Times the scalar and vectorised collision of every fluid site on 
+///			this grid for L_COLLISION_BENCHMARK sweeps and writes the timings 
+///			and the largest difference between the two results to the log. 
+///			Works on a copy of the populations so the simulation is unaffected.
+void GridObj::LBM_benchmarkCollision()
+{
+	// Sites to collide
+	std::vector<int> ids;
+	for (int id = 0; id < N_lim * M_lim * K_lim; ++id)
+	{
+		if (LatTyp[id] == eFluid) ids.push_back(id);
+	}
+
+	// Work on a copy of the populations
+	PopVector fSaved;
+	fSaved.swap(fNew);
+
+	// Scalar kernel
+	fNew = f;
+	clock_t t_start = clock();
+	for (int n = 0; n < L_COLLISION_BENCHMARK; ++n)
+	{
+		for (size_t s = 0; s < ids.size(); ++s)
+			_LBM_collide_opt(ids[s]);
+	}
+	double secsScalar = static_cast<double>(clock() - t_start) / CLOCKS_PER_SEC;
+	PopVector fScalar = fNew;
+
+	// Vectorised kernel
+	fNew = f;
+	t_start = clock();
+	for (int n = 0; n < L_COLLISION_BENCHMARK; ++n)
+		_LBM_collideSites_opt(ids);
+	double secsSimd = static_cast<double>(clock() - t_start) / CLOCKS_PER_SEC;
+
+	// Compare results
+	double maxDiff = 0.0;
+	for (size_t s = 0; s < ids.size(); ++s)
+	{
+		for (int v = 0; v < L_NUM_VELS; ++v)
+			maxDiff = std::max(maxDiff, std::fabs(fNew[fIdx(v, ids[s])] - fScalar[fIdx(v, ids[s])]));
+	}
+
+	// Restore
+	fNew.swap(fSaved);
+
+	double sitesPerSweep = static_cast<double>(ids.size());
+	L_INFO("Collision benchmark on level " + std::to_string(level) + " (" + 
+		std::to_string(ids.size()) + " sites, " + std::to_string(L_COLLISION_BENCHMARK) + " sweeps):", GridUtils::logfile);
+	L_INFO("Scalar collision = " + std::to_string(secsScalar * 1.0e9 / (sitesPerSweep * L_COLLISION_BENCHMARK)) + 
+		" ns/site", GridUtils::logfile);
+	L_INFO("SIMD collision (width " + std::to_string(L_SIMD_WIDTH) + ") = " + 
+		std::to_string(secsSimd * 1.0e9 / (sitesPerSweep * L_COLLISION_BENCHMARK)) + " ns/site", GridUtils::logfile);
+	L_INFO("Speed-up = " + std::to_string(secsScalar / secsSimd) + 
+		", maximum difference = " + std::to_string(maxDiff), GridUtils::logfile);
+}
+#endif
+
+#endif
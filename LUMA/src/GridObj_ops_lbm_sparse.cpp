@@ -0,0 +1,174 @@
+/*
+* --------------------------------------------------------------
+*
+* ------ Lattice Boltzmann @ The University of Manchester ------
+*
+* -------------------------- L-U-M-A ---------------------------
+*
+* Copyright 2019 The University of Manchester
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.*
+*/
+
+#include "../inc/stdafx.h"
+#include "../inc/GridObj.h"
+
+#ifdef L_USE_SPARSE_LATTICE
+
+/* Sparse lattice storage.
+ *
+ * Only active sites (those which are not solid or refined) are given a slot in
+ * the population arrays f, fNew, feq and force_i. All inactive sites share a 
+ * single extra slot so that code which reads or writes their populations (e.g.
+ * the MPI buffers or output) still works without checks. Macroscopic 
+ * quantities remain dense so IBM, output and MPI are unchanged. The kernels 
+ * loop over the list of active sites of each x-plane rather than the whole 
+ * grid. Populations are stored densely at initialisation and compacted when 
+ * the stream tables are first built. */
+
+// *****************************************************************************
+/// \brief	Initialise dense population storage.
+///
+///			Every site is given its own slot. Called before the population 
+///			arrays are allocated.
+void GridObj::_LBM_initSparseStorage()
+{
+	sparseCount = N_lim * M_lim * K_lim;
+	sparseShared = -1;
+	sparseIdx.resize(sparseCount);
+	for (int id = 0; id < sparseCount; ++id) sparseIdx[id] = id;
+}
+
+// *****************************************************************************
+/// \brief	Build the sparse lattice from the current site labels.
+///
+///			Assigns a slot to each active site and repacks the population 
+///			arrays. Sites which were inactive before and are now active are 
+///			initialised to equilibrium. Also builds the lists of active sites 
+///			used by the kernels.
+void GridObj::_LBM_buildSparseLattice()
+{
+	// Store old mapping
+	std::vector<int> oldIdx;
+	oldIdx.swap(sparseIdx);
+	int oldCount = sparseCount;
+	int oldShared = sparseShared;
+
+	// Reset lists
+	int nSites = N_lim * M_lim * K_lim;
+	sparseIdx.assign(nSites, 0);
+	sparseSites.clear();
+	sparsePlaneStart.assign(N_lim + 1, 0);
+
+	// Loop over grid
+	for (int i = 0; i < N_lim; ++i)
+	{
+		sparsePlaneStart[i] = static_cast<int>(sparseSites.size());
+
+		for (int j = 0; j < M_lim; ++j)
+		{
+			for (int k = 0; k < K_lim; ++k)
+			{
+				// Local index and type
+				int id = k + j * K_lim + i * K_lim * M_lim;
+				eType type_local = LatTyp[id];
+
+				// Active sites get their own slot
+				if (type_local != eSolid && type_local != eRefined)
+				{
+					sparseIdx[id] = static_cast<int>(sparseSites.size());
+					sparseSites.push_back(id);
+				}
+			}
+		}
+	}
+	sparsePlaneStart[N_lim] = static_cast<int>(sparseSites.size());
+
+	// Inactive sites share the last slot
+	sparseShared = static_cast<int>(sparseSites.size());
+	sparseCount = sparseShared + 1;
+	for (int id = 0; id < nSites; ++id)
+	{
+		eType type_local = LatTyp[id];
+		if (type_local == eSolid || type_local == eRefined) sparseIdx[id] = sparseShared;
+	}
+
+	// Repack populations
+	_LBM_sparseRepack(f, oldIdx, oldCount, oldShared, true);
+	_LBM_sparseRepack(fNew, oldIdx, oldCount, oldShared, true);
+	_LBM_sparseRepack(feq, oldIdx, oldCount, oldShared, true);
+	_LBM_sparseRepack(force_i, oldIdx, oldCount, oldShared, false);
+
+	*GridUtils::logfile << "Grid " << level << ": Sparse lattice storing populations for " <<
+		sparseSites.size() << " active sites out of " << nSites << " sites" << std::endl;
+}
+
+// *****************************************************************************
+/// \brief	Repack a population array into the current sparse layout.
+///
+///	\param	pop				population array to repack (unallocated arrays are ignored).
+///	\param	oldIdx			slot of each site in the old layout.
+///	\param	oldCount		number of slots in the old layout.
+///	\param	oldShared		slot shared by inactive sites in the old layout (-1 if none).
+///	\param	bEquilibrium	initialise newly active sites to equilibrium rather than zero.
+void GridObj::_LBM_sparseRepack(PopVector &pop, const std::vector<int> &oldIdx, 
+								int oldCount, int oldShared, bool bEquilibrium)
+{
+	if (pop.empty()) return;
+
+	PopVector newPop;
+	newPop.resize(sparseCount * L_NUM_VELS);
+
+	// Loop over active sites plane by plane (in parallel for first-touch placement)
+#ifdef L_ENABLE_OPENMP
+#pragma omp parallel for
+#endif
+	for (int i = 0; i < N_lim; ++i)
+	{
+		for (int a = sparsePlaneStart[i]; a < sparsePlaneStart[i + 1]; ++a)
+		{
+			int id = sparseSites[a];
+			int s = oldIdx[id];
+			for (int v = 0; v < L_NUM_VELS; ++v)
+			{
+				// Site was inactive so had no populations of its own
+				if (s == oldShared)
+				{
+					newPop[fIdx(v, id)] = (bEquilibrium ? _LBM_equilibrium_opt(id, v) : 0.0);
+					continue;
+				}
+
+				// Copy from old slot
+#ifdef L_USE_FUSED_KERNEL
+				newPop[fIdx(v, id)] = pop[s + v * oldCount];
+#else
+				newPop[fIdx(v, id)] = pop[v + s * L_NUM_VELS];
+#endif
+			}
+		}
+	}
+
+	// Clear the shared slot
+	for (int v = 0; v < L_NUM_VELS; ++v)
+	{
+#ifdef L_USE_FUSED_KERNEL
+		newPop[sparseShared + v * sparseCount] = 0.0;
+#else
+		newPop[v + sparseShared * L_NUM_VELS] = 0.0;
+#endif
+	}
+
+	pop.swap(newPop);
+}
+
+#endif
@@ -394,6 +394,161 @@ std::vector<double> GridUtils::solveLinearSystem(std::vector<std::vector<double>
 	return b;
 }
 
+
+// *****************************************************************************
+///	\brief	Solve the banded linear system A.x = b in place
+///
+///			A is in LAPACK banded storage (leading dimension 2 * kl + ku + 1 
+///			with A(i,j) at row kl + ku + i - j of column j) and is overwritten 
+///			by its LU factors. The first BC rows and columns are removed 
+///			from the system.
+///
+///	\param	AB		A matrix in banded storage
+///	\param	kl		number of sub-diagonals
+///	\param	ku		number of super-diagonals
+///	\param	b		b vector (RHS) on entry and x on exit
+///	\param	ipiv	pivot indices (at least as long as b)
+///	\param	BC		number of DOFs removed by the boundary conditions
+void GridUtils::solveBandedSystem(std::vector<double> &AB, int kl, int ku, std::vector<double> &b, std::vector<int> &ipiv, int BC) {
+
+	// Set up the correct values
+	char trans = 'N';
+	int dim = static_cast<int>(b.size()) - BC;
+	int LDAB = 2 * kl + ku + 1;
+	int nrhs = 1;
+	int info = -1;
+
+	// Factorise and solve
+	dgbtrf_(&dim, &dim, &kl, &ku, AB.data() + BC * LDAB, &LDAB, ipiv.data(), &info);
+	dgbtrs_(&trans, &dim, &kl, &ku, &nrhs, AB.data() + BC * LDAB, &LDAB, ipiv.data(), b.data() + BC, &dim, &info);
+
+	// Set values not included to zero
+	fill(b.begin(), b.begin() + BC, 0.0);
+}
+
+
+// *****************************************************************************
+///	\brief	Solve the sparse linear system A.x = b
+///
+///			A is stored in compressed sparse row (CSR) format and the system 
+///			is solved with Jacobi-preconditioned BiCGSTAB until the residual 
+///			falls below L_EPSILON_TOL times the norm of b. In MPI builds the 
+///			rows are distributed over the ranks of the communicator in rank 
+///			order and the column indices are global.
+///
+///	\param	rowPtr		offset of the first entry of each row (rows + 1)
+///	\param	colIdx		column of each entry
+///	\param	val			value of each entry
+///	\param	b			b vector (RHS) of the local rows
+///	\param	x			initial guess on entry and solution on exit (local rows)
+///	\param	iterations	number of iterations taken
+///	\param	rowCounts	number of rows on each rank of the communicator
+///	\param	comm		communicator the rows are distributed over
+///	\return	relative residual
+#ifdef L_BUILD_FOR_MPI
+double GridUtils::solveSparseSystem(const std::vector<int> &rowPtr, const std::vector<int> &colIdx, const std::vector<double> &val,
+	const std::vector<double> &b, std::vector<double> &x, int &iterations,
+	const std::vector<int> &rowCounts, MPI_Comm comm) {
+#else
+double GridUtils::solveSparseSystem(const std::vector<int> &rowPtr, const std::vector<int> &colIdx, const std::vector<double> &val,
+	const std::vector<double> &b, std::vector<double> &x, int &iterations) {
+#endif
+
+	// Number of local rows and offset of the first one in the global vector
+	int n = static_cast<int>(b.size());
+	int rowOffset = 0;
+#ifdef L_BUILD_FOR_MPI
+	int commRank;
+	MPI_Comm_rank(comm, &commRank);
+	std::vector<int> rowDisps(rowCounts.size(), 0);
+	for (size_t i = 1; i < rowCounts.size(); i++)
+		rowDisps[i] = rowDisps[i - 1] + rowCounts[i - 1];
+	rowOffset = rowDisps[commRank];
+	std::vector<double> vGlobal(rowDisps.back() + rowCounts.back(), 0.0);
+#endif
+
+	// Sum of local dot products over all rows
+	auto dot = [&](const std::vector<double> &a, const std::vector<double> &c) {
+		double sum = 0.0;
+		for (int i = 0; i < n; i++) sum += a[i] * c[i];
+#ifdef L_BUILD_FOR_MPI
+		MPI_Allreduce(MPI_IN_PLACE, &sum, 1, MPI_DOUBLE, MPI_SUM, comm);
+#endif
+		return sum;
+	};
+
+	// Matrix-vector product (columns of other ranks are gathered first)
+	auto multiply = [&](const std::vector<double> &v, std::vector<double> &Av) {
+#ifdef L_BUILD_FOR_MPI
+		MPI_Allgatherv(v.data(), n, MPI_DOUBLE, vGlobal.data(), rowCounts.data(), rowDisps.data(), MPI_DOUBLE, comm);
+		const std::vector<double> &vCols = vGlobal;
+#else
+		const std::vector<double> &vCols = v;
+#endif
+		for (int i = 0; i < n; i++) {
+			double sum = 0.0;
+			for (int e = rowPtr[i]; e < rowPtr[i + 1]; e++) sum += val[e] * vCols[colIdx[e]];
+			Av[i] = sum;
+		}
+	};
+
+	// Inverse of the diagonal for preconditioning
+	std::vector<double> invDiag(n, 1.0);
+	for (int i = 0; i < n; i++) {
+		for (int e = rowPtr[i]; e < rowPtr[i + 1]; e++) {
+			if (colIdx[e] == rowOffset + i && val[e] != 0.0) invDiag[i] = 1.0 / val[e];
+		}
+	}
+
+	// Initial residual
+	std::vector<double> r(n), rHat(n), p(n, 0.0), v(n, 0.0), pHat(n), s(n), sHat(n), t(n);
+	multiply(x, r);
+	for (int i = 0; i < n; i++) r[i] = b[i] - r[i];
+	rHat = r;
+
+	double normB = std::sqrt(dot(b, b));
+	if (normB == 0.0) normB = 1.0;
+	double res = std::sqrt(dot(r, r)) / normB;
+	double rho = 1.0, alpha = 1.0, omega = 1.0;
+
+	// Iterate
+	for (iterations = 0; iterations < L_EPSILON_MAXIT && res > L_EPSILON_TOL; iterations++) {
+
+		// Search direction
+		double rhoNew = dot(rHat, r);
+		if (rhoNew == 0.0) break;
+		double beta = (rhoNew / rho) * (alpha / omega);
+		for (int i = 0; i < n; i++) {
+			p[i] = r[i] + beta * (p[i] - omega * v[i]);
+			pHat[i] = invDiag[i] * p[i];
+		}
+		multiply(pHat, v);
+		alpha = rhoNew / dot(rHat, v);
+
+		// Half step
+		for (int i = 0; i < n; i++) s[i] = r[i] - alpha * v[i];
+		res = std::sqrt(dot(s, s)) / normB;
+		if (res <= L_EPSILON_TOL) {
+			for (int i = 0; i < n; i++) x[i] += alpha * pHat[i];
+			iterations++;
+			break;
+		}
+
+		// Stabilising step
+		for (int i = 0; i < n; i++) sHat[i] = invDiag[i] * s[i];
+		multiply(sHat, t);
+		omega = dot(t, s) / dot(t, t);
+		for (int i = 0; i < n; i++) {
+			x[i] += alpha * pHat[i] + omega * sHat[i];
+			r[i] = s[i] - omega * t[i];
+		}
+		res = std::sqrt(dot(r, r)) / normB;
+		rho = rhoNew;
+	}
+
+	return res;
+}
+
 // *****************************************************************************
 /// \brief	Gets the indices of the fine site given the coarse site.
 ///
@@ -1745,6 +1900,37 @@ int GridUtils::safeGetRank()
 
 }
 
+// ****************************************************************************
+/// \brief	Get the range of x-planes owned by the calling OpenMP thread.
+///
+///			Splits the planes 0 to N_lim - 1 into contiguous blocks, one per 
+///			thread in the enclosing parallel region, so that scattered updates 
+///			(e.g. IBM spreading) can be done race-free by each thread only 
+///			writing to sites in the planes it owns. Must be called from inside 
+///			a parallel region. Returns the full range in serial builds.
+///
+///	\param	N_lim	number of x-planes on the grid.
+///	\param	start	pointer to first plane owned by this thread.
+///	\param	end		pointer to one past the last plane owned by this thread.
+void GridUtils::getThreadPlaneRange(int N_lim, int *start, int *end)
+{
+
+#ifdef L_ENABLE_OPENMP
+
+	int nThreads = omp_get_num_threads();
+	int thread = omp_get_thread_num();
+	*start = (N_lim * thread) / nThreads;
+	*end = (N_lim * (thread + 1)) / nThreads;
+
+#else
+
+	*start = 0;
+	*end = N_lim;
+
+#endif
+
+}
+
 // ****************************************************************************
 /// \brief	Method to retireve the sub-grid corresponding to the supplied coarse 
 ///			indices.
@@ -22,6 +22,7 @@
 
 #include "../inc/stdafx.h"
 #include "../inc/GridObj.h"
+#include "../inc/ObjectManager.h"
 
 // Static declarations
 MpiManager* MpiManager::me;
@@ -54,6 +55,14 @@ MpiManager::MpiManager()
 	f_buffer_send.resize(L_MPI_DIRS, std::vector<double>(0));
 	f_buffer_recv.resize(L_MPI_DIRS, std::vector<double>(0));	
 
+	// One exchange per grid in the hierarchy
+	halo_exchanges.resize((L_NUM_LEVELS + 1) * L_NUM_REGIONS);
+
+#ifdef L_MPI_NEIGHBOUR_COLLECTIVES
+	// Use the neighbourhood collective by default
+	bNeighbourCollectives = true;
+#endif
+
 	// Initialise the manager, grid information and topology
 	mpi_init();
 
@@ -70,6 +79,15 @@ MpiManager::MpiManager()
 ///
 MpiManager::~MpiManager(void)
 {
+#ifdef L_MPI_PERSISTENT
+	// Release persistent requests
+	mpi_freePersistentComms();
+#endif
+#ifdef L_MPI_NEIGHBOUR_COLLECTIVES
+	// Release graph communicators
+	mpi_freeNeighbourComms();
+#endif
+
 	// Close the logfile
 	if (logout != nullptr)
 	{
@@ -231,7 +249,6 @@ void MpiManager::mpi_gridbuild(GridManager* const grid_man)
 	cRankSizeX.resize(num_ranks);
 	cRankSizeY.resize(num_ranks);
 	cRankSizeZ.resize(num_ranks);
-	double dh = L_COARSE_SITE_WIDTH;
 	int numCells[3];
 	numCells[0] = L_N;
 	numCells[1] = L_M;
@@ -239,11 +256,11 @@ void MpiManager::mpi_gridbuild(GridManager* const grid_man)
 
 	// Compute block sizes based on chosen algorithm
 #ifdef L_MPI_TOPOLOGY_REPORT
-	mpi_reportOnDecomposition(dh);
+	mpi_reportOnDecomposition(L_COARSE_SITE_WIDTH);
 #elif defined L_MPI_SMART_DECOMPOSE
 	// Log use of SD
 	L_INFO("Using Smart Decomposition...", GridUtils::logfile);
-	mpi_smartDecompose(dh);
+	mpi_smartDecompose(L_COARSE_SITE_WIDTH);
 #else
 	mpi_uniformDecompose(&numCells[0]);
 #endif
@@ -260,6 +277,23 @@ void MpiManager::mpi_gridbuild(GridManager* const grid_man)
 	L_INFO(msg, logout); msg.clear();
 #endif
 
+	// Set up the local grid from the decomposition
+	mpi_setLocalGrid(grid_man);
+}
+
+// ************************************************************************* //
+/// \brief	Set up the local grid of this rank from the rank sizes.
+///
+///			Passes the local grid size to the grid manager then computes the
+///			core edges of all ranks and the positions of the sender and 
+///			receiver layers of this rank. Called once the domain has been 
+///			decomposed and again whenever it is rebalanced.
+///
+///	\param	grid_man	Pointer to an initialised grid manager.
+void MpiManager::mpi_setLocalGrid(GridManager* const grid_man)
+{
+	double dh = L_COARSE_SITE_WIDTH;
+
 	// Compute required local grid size to pass to grid manager //
 	std::vector<int> local_size;
 
@@ -624,23 +658,42 @@ void MpiManager::mpi_writeout_buf( std::string filename, int dir ) {
 ///			This method implements the communication between grids of the same
 ///			level and region across MPI processes. Each call effects
 ///			communication in all valid directions for the grid of the supplied
-///			level and region.
+///			level and region. This is a blocking wrapper which posts the 
+///			exchange and then waits for it to complete.
 ///
 /// \param	lev	level of grid to communicate.
 /// \param	reg	region number of grid to communicate.
 void MpiManager::mpi_communicate(int lev, int reg) {
 
-	// Wall clock variables
-	clock_t t_start, t_end, secs;
+	mpi_communicateStart(lev, reg);
+	mpi_communicateFinish(lev, reg);
+
+}
+
+// ************************************************************************* //
+/// \brief	Post the halo exchange.
+///
+///			Packs the sender layers of the grid of the supplied level and 
+///			region and posts non-blocking sends and receives in all valid 
+///			directions. The exchange must be completed by a matching call to 
+///			mpi_communicateFinish() before the buffers or the halo are used. 
+///			Work which does not touch the sender layers or the halo may be 
+///			done in between to hide the cost of the communication.
+///
+/// \param	lev	level of grid to communicate.
+/// \param	reg	region number of grid to communicate.
+void MpiManager::mpi_communicateStart(int lev, int reg) {
 
 	// Tag
 	int TAG;
-	int send_count = 0;
 
 	// Get grid object
 	GridObj* Grid = NULL;
 	GridUtils::getGrid(GridManager::getInstance()->Grids, lev, reg,  Grid);
 
+	// Exchange of this grid
+	HaloExchangeStruct *ex = mpi_getHaloExchange(Grid);
+
 
 	///////////////////////
 	// MPI Communication //
@@ -658,9 +711,9 @@ void MpiManager::mpi_communicate(int lev, int reg) {
 	* synchronisation between processes and only call barriers outside the grid scope.
 	*
 	* For each sending direction, pack and load a message into the message queue 
-	* for the destination rank with tag associated with direction.
-	* Then for each receive direction, pull message with correct tag from the queue 
-	* and unpack.
+	* for the destination rank with tag associated with direction and post a 
+	* receive for the message coming from the opposite direction. The receives 
+	* are completed and unpacked in mpi_communicateFinish().
 	*
 	* In order to do this, need non-blocking send and receive calls and each needs
 	* their own buffer to store the information which cannot be touched until the 
@@ -671,16 +724,34 @@ void MpiManager::mpi_communicate(int lev, int reg) {
 	* we use the MPI Manager class to hold the buffer in house. */
 
 	// Start the clock
-	t_start = clock();
+	clock_t comm_clock = clock();
+
+#ifdef L_USE_AA_STREAMING
+	/* With in-place streaming the populations are streamed into the halo after 
+	 * an odd time step so the exchange is reversed to return them to the rank 
+	 * which owns these sites. */
+	bool bReverse = (Grid->t % 2 == 0);
+#endif
+
+#ifdef L_MPI_PERSISTENT
+	// Fixed buffers and requests of this grid
+	PersistentCommStruct *pc = mpi_getPersistentComms(Grid);
+#endif
 
 	// Loop over directions in Cartesian topology
 	for (int dir = 0; dir < L_MPI_DIRS; dir++)
 	{
+		// Find opposite direction (neighbour it receives from)
+		int opp_dir = mpi_getOpposite(dir);
 
 		/* Create a unique tag based on level (< 32), region (< 10) and direction (< 100).
 		 * MPICH limits state that tag value cannot be greater than 32767 */
 		TAG = ((Grid->level + 1) * 1000) + ((Grid->region_number + 1) * 100) + dir;
 
+		// Requests are null unless a message is posted
+		ex->send_requests[dir] = MPI_REQUEST_NULL;
+		ex->recv_requests[dir] = MPI_REQUEST_NULL;
+
 #ifdef L_MPI_VERBOSE
 		*logout << "Processing Message with Tag --> " << TAG << std::endl;
 #endif
@@ -689,17 +760,39 @@ void MpiManager::mpi_communicate(int lev, int reg) {
 		// Resize and Pack Buffer //
 		////////////////////////////
 
+#ifdef L_MPI_PERSISTENT
+		/* Messages are already set up so take the buffers bound to the 
+		 * persistent requests. These are swapped back on completion. */
+		f_buffer_send[dir].swap(pc->send[dir]);
+		f_buffer_recv[dir].swap(pc->recv[dir]);
+#else
 		// Adjust buffer size
-		for (MpiManager::BufferSizeStruct bufs : buffer_send_info) {
+		for (const MpiManager::BufferSizeStruct &bufs : buffer_send_info) {
 			if (bufs.level == Grid->level && bufs.region == Grid->region_number) {
-				f_buffer_send[dir].resize(bufs.size[dir] * L_NUM_VELS);
+				f_buffer_send[dir].resize(bufs.size[dir] * mpi_getSitePayload(dir));
 			}
 		}
+#ifdef L_USE_AA_STREAMING
+		// Reverse exchange sends the recv layer on this side
+		if (bReverse) {
+			for (const MpiManager::BufferSizeStruct &bufr : buffer_recv_info) {
+				if (bufr.level == Grid->level && bufr.region == Grid->region_number) {
+					f_buffer_send[dir].resize(bufr.size[opp_dir] * L_NUM_VELS);
+				}
+			}
+		}
+#endif
+#endif	// L_MPI_PERSISTENT
 
 		// Only pack and send if required
 		if (f_buffer_send[dir].size()) {
 
 			// Pass direction and Grid by reference and pack if required
+#ifdef L_USE_AA_STREAMING
+			if (bReverse)
+				mpi_buffer_packReverse( dir, Grid );
+			else
+#endif
 			mpi_buffer_pack( dir, Grid );
 		
 
@@ -707,16 +800,23 @@ void MpiManager::mpi_communicate(int lev, int reg) {
 			// Post Send //
 			///////////////
 
-			send_count++;
-
 #ifdef L_MPI_VERBOSE
 			*logout << "L" << Grid->level << "R" << Grid->region_number << " -- Direction " << dir 
 								<< " -->  Posting Send for " << f_buffer_send[dir].size() / L_NUM_VELS
 								<< " sites to Rank " << neighbour_rank[dir] << " with tag " << TAG << "." << std::endl;
+#endif
+#ifdef L_MPI_PERSISTENT
+			// Activate the persistent send
+			MPI_Start(&pc->send_requests[dir]);
+#else
+#ifdef L_MPI_NEIGHBOUR_COLLECTIVES
+			// Sent by the neighbourhood collective once all directions are packed
+			if (!bNeighbourCollectives)
 #endif
 			// Post send message to message queue and log request handle in array
 			MPI_Isend( &f_buffer_send[dir].front(), static_cast<int>(f_buffer_send[dir].size()), MPI_DOUBLE, neighbour_rank[dir], 
-				TAG, world_comm, &send_requests[send_count-1] );
+				TAG, world_comm, &ex->send_requests[dir] );
+#endif
 
 #ifdef L_MPI_VERBOSE
 			*logout << "Direction " << dir << " --> Send Posted." << std::endl;
@@ -724,42 +824,179 @@ void MpiManager::mpi_communicate(int lev, int reg) {
 
 		}
 
-		// Find opposite direction (neighbour it receives from)
-		int opp_dir = mpi_getOpposite(dir);
-		
+#ifndef L_MPI_PERSISTENT
 		// Resize the receive buffer
-		for (MpiManager::BufferSizeStruct bufr : buffer_recv_info) {
+		for (const MpiManager::BufferSizeStruct &bufr : buffer_recv_info) {
 			if (bufr.level == Grid->level && bufr.region == Grid->region_number) {
-				f_buffer_recv[dir].resize(bufr.size[dir] * L_NUM_VELS);
+				f_buffer_recv[dir].resize(bufr.size[dir] * mpi_getSitePayload(dir));
+			}
+		}
+#ifdef L_USE_AA_STREAMING
+		// Reverse exchange receives onto the sender layer on the opposite side
+		if (bReverse) {
+			for (const MpiManager::BufferSizeStruct &bufs : buffer_send_info) {
+				if (bufs.level == Grid->level && bufs.region == Grid->region_number) {
+					f_buffer_recv[dir].resize(bufs.size[opp_dir] * L_NUM_VELS);
+				}
 			}
 		}
+#endif
+#endif	// L_MPI_PERSISTENT
 
 
-		///////////////////
-		// Fetch Message //
-		///////////////////
+		//////////////////
+		// Post Receive //
+		//////////////////
 
 		if (f_buffer_recv[dir].size()) {
 
 #ifdef L_MPI_VERBOSE
 			*logout << "L" << Grid->level << "R" << Grid->region_number << " -- Direction " << dir 
-								<< " -->  Fetching message for " << f_buffer_recv[dir].size() / L_NUM_VELS	
+								<< " -->  Posting receive for " << f_buffer_recv[dir].size() / L_NUM_VELS	
 								<< " sites from Rank " << neighbour_rank[opp_dir] << " with tag " << TAG << "." << std::endl;
 #endif
 
-			// Use a blocking receive call if required
-			MPI_Recv( &f_buffer_recv[dir].front(), static_cast<int>(f_buffer_recv[dir].size()), MPI_DOUBLE, neighbour_rank[opp_dir], 
-				TAG, world_comm, &recv_stat );
+#ifdef L_MPI_PERSISTENT
+			// Activate the persistent receive
+			MPI_Start(&pc->recv_requests[dir]);
+#else
+#ifdef L_MPI_NEIGHBOUR_COLLECTIVES
+			if (!bNeighbourCollectives)
+#endif
+			// Post receive and log request handle in array
+			MPI_Irecv( &f_buffer_recv[dir].front(), static_cast<int>(f_buffer_recv[dir].size()), MPI_DOUBLE, neighbour_rank[opp_dir], 
+				TAG, world_comm, &ex->recv_requests[dir] );
+#endif
+
+		}
+	}
+
+#ifdef L_MPI_NEIGHBOUR_COLLECTIVES
+	// Exchange all directions in a single collective
+	ex->neighbour_request = MPI_REQUEST_NULL;
+	if (bNeighbourCollectives)
+		mpi_neighbourExchangeStart(Grid);
+#endif
+
+	/* Hold on to the buffers of the posted messages until the exchange is 
+	 * completed. The storage does not move so the messages are unaffected. */
+	for (int dir = 0; dir < L_MPI_DIRS; dir++)
+	{
+		f_buffer_send[dir].swap(ex->send[dir]);
+		f_buffer_recv[dir].swap(ex->recv[dir]);
+	}
+
+	// Time spent posting the exchange
+	ex->comm_clock = clock() - comm_clock;
+
+}
+
+// ************************************************************************* //
+/// \brief	Complete the halo exchange.
+///
+///			Completes the exchange posted by mpi_communicateStart() on the grid
+///			of the supplied level and region and updates the timing data.
+///
+/// \param	lev	level of grid to communicate.
+/// \param	reg	region number of grid to communicate.
+void MpiManager::mpi_communicateFinish(int lev, int reg) {
+
+	// Wall clock variables
+	clock_t t_start, t_end, secs;
+
+	// Get grid object
+	GridObj* Grid = NULL;
+	GridUtils::getGrid(GridManager::getInstance()->Grids, lev, reg,  Grid);
+
+	// Start the clock
+	t_start = clock();
+
+	// Wait for messages and unpack
+	mpi_communicateComplete(Grid);
+
+	// Print Time of MPI comms
+	t_end = clock();
+	secs = t_end - t_start + mpi_getHaloExchange(Grid)->comm_clock;
+
+	// Update average MPI overhead time for this particular grid
+	Grid->timeav_mpi_overhead *= (Grid->t-1);
+	Grid->timeav_mpi_overhead += ((double)secs)/CLOCKS_PER_SEC;
+	Grid->timeav_mpi_overhead /= Grid->t;
+
+#ifdef L_TEXTOUT
+	if (Grid->t % L_GRID_OUT_FREQ == 0) {
+		*GridUtils::logfile << "Writing out to <Grids.out>" << std::endl;
+		Grid->io_textout("POST MPI COMMS");
+	}
+#endif
+
+	if (Grid->t % L_GRID_OUT_FREQ == 0) {
+		// Performance Data
+		L_INFO("MPI overhead taking an average of " + 
+			std::to_string(Grid->timeav_mpi_overhead * 1000) + "ms", GridUtils::logfile);
+	}
+
+
+}
+
+// ************************************************************************* //
+/// \brief	Wait for the halo exchange of a grid and unpack it.
+///
+///			Waits for the receives posted by mpi_communicateStart() on the 
+///			supplied grid, unpacks them into the halo and then waits for the 
+///			sends to be received by the neighbours.
+///
+/// \param	Grid	grid being communicated.
+void MpiManager::mpi_communicateComplete(GridObj* const Grid) {
+
+#ifdef L_USE_AA_STREAMING
+	// Same direction of exchange as when posted
+	bool bReverse = (Grid->t % 2 == 0);
+#endif
+
+	// Return the buffers of the exchange in progress
+	HaloExchangeStruct *ex = mpi_getHaloExchange(Grid);
+	for (int dir = 0; dir < L_MPI_DIRS; dir++)
+	{
+		f_buffer_send[dir].swap(ex->send[dir]);
+		f_buffer_recv[dir].swap(ex->recv[dir]);
+	}
+
+	// Requests of the exchange in progress
+	MPI_Request *sendReq = ex->send_requests;
+	MPI_Request *recvReq = ex->recv_requests;
+#ifdef L_MPI_PERSISTENT
+	PersistentCommStruct *pc = mpi_getPersistentComms(Grid);
+	sendReq = pc->send_requests;
+	recvReq = pc->recv_requests;
+#endif
+
+	// Wait for the messages to arrive
+	MPI_Waitall(L_MPI_DIRS, recvReq, recv_stats);
+#ifdef L_MPI_NEIGHBOUR_COLLECTIVES
+	MPI_Wait(&ex->neighbour_request, MPI_STATUS_IGNORE);
+#endif
+
+	// Loop over directions in Cartesian topology
+	for (int dir = 0; dir < L_MPI_DIRS; dir++)
+	{
+
+		///////////////////////////
+		// Unpack Buffer to Grid //
+		///////////////////////////
+
+		if (f_buffer_recv[dir].size()) {
 
 #ifdef L_MPI_VERBOSE
 			*logout << "Direction " << dir << " --> Received." << std::endl;
 #endif
 
-			///////////////////////////
-			// Unpack Buffer to Grid //
-			///////////////////////////
-
 			// Pass direction and Grid by reference
+#ifdef L_USE_AA_STREAMING
+			if (bReverse)
+				mpi_buffer_unpackReverse( dir, Grid );
+			else
+#endif
 			mpi_buffer_unpack( dir, Grid );
 
 		}
@@ -768,7 +1005,7 @@ void MpiManager::mpi_communicate(int lev, int reg) {
 
 		*logout << "SUMMARY for L" << Grid->level << "R" << Grid->region_number << " -- Direction " << dir
 			<< " -- Sent " << f_buffer_send[dir].size() / L_NUM_VELS << " to " << neighbour_rank[dir]
-			<< ": Received " << f_buffer_recv[dir].size() / L_NUM_VELS << " from " << neighbour_rank[opp_dir] << std::endl;
+			<< ": Received " << f_buffer_recv[dir].size() / L_NUM_VELS << " from " << neighbour_rank[mpi_getOpposite(dir)] << std::endl;
 
 		// Write out buffers
 		std::string filename = GridUtils::path_str + "/mpiBuffer_Rank" + std::to_string(my_rank) + "_Dir" + std::to_string(dir) + ".out";
@@ -779,41 +1016,317 @@ void MpiManager::mpi_communicate(int lev, int reg) {
 
 #ifdef L_MPI_VERBOSE
 	*logout << " *********************** Waiting for Sends to be Received on L" + 
-		std::to_string(lev) + "R" + std::to_string(reg) + 
+		std::to_string(Grid->level) + "R" + std::to_string(Grid->region_number) + 
 		" *********************** " << std::endl;
 #endif
 
 	/* Wait until other processes have handled all the sends from this rank
 	 * Note that calls to this command destroy the handles once complete so
 	 * do not need to clear the array afterward. */
-	MPI_Waitall(send_count,send_requests,send_stat);
+	MPI_Waitall(L_MPI_DIRS, sendReq, send_stat);
 
+#ifdef L_MPI_PERSISTENT
+	// Return the buffers to the persistent requests (requests are inactive not freed)
+	for (int dir = 0; dir < L_MPI_DIRS; dir++)
+	{
+		f_buffer_send[dir].swap(pc->send[dir]);
+		f_buffer_recv[dir].swap(pc->recv[dir]);
+	}
+#endif
 
-	// Print Time of MPI comms
-	t_end = clock();
-	secs = t_end - t_start;
+}
 
-	// Update average MPI overhead time for this particular grid
-	Grid->timeav_mpi_overhead *= (Grid->t-1);
-	Grid->timeav_mpi_overhead += ((double)secs)/CLOCKS_PER_SEC;
-	Grid->timeav_mpi_overhead /= Grid->t;
+// ************************************************************************* //
+/// \brief	Get the halo exchange of a grid.
+///
+/// \param	g	grid being communicated.
+/// \return	pointer to the exchange of the grid.
+MpiManager::HaloExchangeStruct* MpiManager::mpi_getHaloExchange(GridObj* const g) {
 
-#ifdef L_TEXTOUT
-	if (Grid->t % L_GRID_OUT_FREQ == 0) {
-		*GridUtils::logfile << "Writing out to <Grids.out>" << std::endl;
-		Grid->io_textout("POST MPI COMMS");
+	return &halo_exchanges[g->level + g->region_number * (L_NUM_LEVELS + 1)];
+
+}
+
+// ************************************************************************* //
+/// \brief	Get the number of values passed per site.
+///
+///			The populations which cross into the neighbour are followed by the
+///			density and velocity of the site. With in-place streaming only the 
+///			populations are passed.
+///
+/// \param	dir	MPI direction.
+/// \return	number of values per site in the buffer.
+int MpiManager::mpi_getSitePayload(int dir) {
+
+#ifdef L_USE_AA_STREAMING
+	return static_cast<int>(crossing_vels[dir].size());
+#else
+	return static_cast<int>(crossing_vels[dir].size()) + 1 + L_DIMS;
+#endif
+
+}
+
+// ************************************************************************* //
+/// \brief	Get the buffer information of a grid.
+///
+/// \param	info	vector of buffer information structures to search.
+/// \param	g		grid to find.
+/// \return	pointer to the structure for the grid or nullptr if not found.
+MpiManager::BufferSizeStruct* MpiManager::mpi_findBufferInfo(std::vector<BufferSizeStruct> &info, GridObj const * const g) {
+
+	for (BufferSizeStruct &buf : info) {
+		if (buf.level == g->level && buf.region == g->region_number) return &buf;
 	}
+	return nullptr;
+
+}
+
+#ifdef L_MPI_PERSISTENT
+// ************************************************************************* //
+/// \brief	Get the persistent halo exchange of a grid.
+///
+///			On first use for a grid the send and receive buffers are sized 
+///			from the buffer information and persistent requests are created 
+///			for every direction which communicates. With in-place streaming 
+///			the forward and reverse exchanges have their own requests and the 
+///			one matching the time step of the grid is returned.
+///
+/// \param	g	grid whose exchange is required.
+/// \return	pointer to the persistent exchange data of the grid.
+MpiManager::PersistentCommStruct* MpiManager::mpi_getPersistentComms(GridObj* const g) {
+
+	bool bReverse = false;
+#ifdef L_USE_AA_STREAMING
+	bReverse = (g->t % 2 == 0);
 #endif
 
-	if (Grid->t % L_GRID_OUT_FREQ == 0) {
-		// Performance Data
-		L_INFO("MPI overhead taking an average of " + 
-			std::to_string(Grid->timeav_mpi_overhead * 1000) + "ms", GridUtils::logfile);
+	// Return existing exchange if already set up
+	for (PersistentCommStruct &pc : persistent_comms) {
+		if (pc.level == g->level && pc.region == g->region_number && pc.reverse == bReverse) return &pc;
+	}
+
+	// Get buffer sizes of this grid
+	BufferSizeStruct *bufs = mpi_findBufferInfo(buffer_send_info, g);
+	BufferSizeStruct *bufr = mpi_findBufferInfo(buffer_recv_info, g);
+	if (bufs == nullptr || bufr == nullptr)
+		L_ERROR("Buffer sizes for L" + std::to_string(g->level) + "R" + std::to_string(g->region_number) + 
+			" not found. Exiting.", GridUtils::logfile);
+
+	// Create new exchange
+	persistent_comms.emplace_back(g->level, g->region_number, bReverse);
+	PersistentCommStruct &pc = persistent_comms.back();
+
+	for (int dir = 0; dir < L_MPI_DIRS; dir++)
+	{
+		int opp_dir = mpi_getOpposite(dir);
+
+		// Same tag as the non-persistent exchange
+		int TAG = ((g->level + 1) * 1000) + ((g->region_number + 1) * 100) + dir;
+
+		// Reverse exchange sends the recv layer and receives onto the sender layer
+		if (bReverse) {
+			pc.send[dir].resize(bufr->size[opp_dir] * L_NUM_VELS);
+			pc.recv[dir].resize(bufs->size[opp_dir] * L_NUM_VELS);
+		}
+		else {
+			pc.send[dir].resize(bufs->size[dir] * mpi_getSitePayload(dir));
+			pc.recv[dir].resize(bufr->size[dir] * mpi_getSitePayload(dir));
+		}
+
+		pc.send_requests[dir] = MPI_REQUEST_NULL;
+		pc.recv_requests[dir] = MPI_REQUEST_NULL;
+
+		if (pc.send[dir].size()) {
+			MPI_Send_init(&pc.send[dir].front(), static_cast<int>(pc.send[dir].size()), MPI_DOUBLE, neighbour_rank[dir],
+				TAG, world_comm, &pc.send_requests[dir]);
+		}
+		if (pc.recv[dir].size()) {
+			MPI_Recv_init(&pc.recv[dir].front(), static_cast<int>(pc.recv[dir].size()), MPI_DOUBLE, neighbour_rank[opp_dir],
+				TAG, world_comm, &pc.recv_requests[dir]);
+		}
+	}
+
+#ifdef L_MPI_VERBOSE
+	*logout << "Persistent exchange created for L" << g->level << "R" << g->region_number 
+		<< (bReverse ? " (reverse)" : "") << std::endl;
+#endif
+
+	return &pc;
+
+}
+
+// ************************************************************************* //
+/// \brief	Free the persistent halo exchanges.
+///
+///			Must be called when no exchange is in progress and before the 
+///			buffer information is rebuilt.
+void MpiManager::mpi_freePersistentComms() {
+
+	for (PersistentCommStruct &pc : persistent_comms) {
+		for (int dir = 0; dir < L_MPI_DIRS; dir++) {
+			if (pc.send_requests[dir] != MPI_REQUEST_NULL) MPI_Request_free(&pc.send_requests[dir]);
+			if (pc.recv_requests[dir] != MPI_REQUEST_NULL) MPI_Request_free(&pc.recv_requests[dir]);
+		}
+	}
+	persistent_comms.clear();
+
+}
+#endif
+
+#ifdef L_MPI_NEIGHBOUR_COLLECTIVES
+// ************************************************************************* //
+/// \brief	Build the graph topologies for the neighbourhood collective exchange.
+///
+///			For every grid in the hierarchy a communicator is created from the
+///			ranks on which the grid exists and a distributed graph is built on
+///			it with an edge for each direction in which a buffer is passed. All
+///			ranks must call this method as the creation is collective. With 
+///			in-place streaming the reverse exchange gets its own graph as the 
+///			communicating directions may differ. Must be called after the 
+///			buffer information has been computed.
+void MpiManager::mpi_buildNeighbourComms() {
+
+#ifdef L_USE_AA_STREAMING
+	int numExchanges = 2;
+#else
+	int numExchanges = 1;
+#endif
+
+	MPI_Group world_group;
+	MPI_Comm_group(world_comm, &world_group);
+
+	for (int l = 0; l <= L_NUM_LEVELS; l++) {
+		for (int r = 0; r < L_NUM_REGIONS; r++) {
+			for (int rev = 0; rev < numExchanges; rev++) {
+
+				neighbour_comms.emplace_back(l, r, rev == 1);
+				NeighbourCommStruct &nc = neighbour_comms.back();
+
+				// Ranks without the grid are left out of the graph
+				GridObj *g = NULL;
+				GridUtils::getGrid(GridManager::getInstance()->Grids, l, r, g);
+				MPI_Comm grid_comm;
+				MPI_Comm_split(world_comm, (g == NULL ? MPI_UNDEFINED : 0), my_rank, &grid_comm);
+				if (g == NULL) continue;
+
+				BufferSizeStruct *bufs = mpi_findBufferInfo(buffer_send_info, g);
+				BufferSizeStruct *bufr = mpi_findBufferInfo(buffer_recv_info, g);
+
+				// Edges in ascending direction order using world rank numbers
+				std::vector<int> destinations, sources;
+				for (int dir = 0; dir < L_MPI_DIRS; dir++)
+				{
+					int opp_dir = mpi_getOpposite(dir);
+					int sendSize = (rev == 1 ? bufr->size[opp_dir] : bufs->size[dir]);
+					int recvSize = (rev == 1 ? bufs->size[opp_dir] : bufr->size[dir]);
+
+					if (sendSize) {
+						nc.send_dirs.push_back(dir);
+						destinations.push_back(neighbour_rank[dir]);
+					}
+					if (recvSize) {
+						nc.recv_dirs.push_back(dir);
+						sources.push_back(neighbour_rank[opp_dir]);
+					}
+				}
+
+				// Convert to rank numbers in the grid communicator
+				MPI_Group grid_group;
+				MPI_Comm_group(grid_comm, &grid_group);
+				std::vector<int> gridDestinations(destinations.size()), gridSources(sources.size());
+				MPI_Group_translate_ranks(world_group, static_cast<int>(destinations.size()), destinations.data(), grid_group, gridDestinations.data());
+				MPI_Group_translate_ranks(world_group, static_cast<int>(sources.size()), sources.data(), grid_group, gridSources.data());
+				MPI_Group_free(&grid_group);
+
+				// Create graph (no reordering so ranks keep their place in the Cartesian topology)
+				MPI_Dist_graph_create_adjacent(grid_comm,
+					static_cast<int>(gridSources.size()), gridSources.data(), MPI_UNWEIGHTED,
+					static_cast<int>(gridDestinations.size()), gridDestinations.data(), MPI_UNWEIGHTED,
+					MPI_INFO_NULL, 0, &nc.comm);
+				MPI_Comm_free(&grid_comm);
+
+				// Every edge passes doubles
+				nc.send_counts.resize(nc.send_dirs.size());
+				nc.send_displs.resize(nc.send_dirs.size());
+				nc.send_types.resize(nc.send_dirs.size(), MPI_DOUBLE);
+				nc.recv_counts.resize(nc.recv_dirs.size());
+				nc.recv_displs.resize(nc.recv_dirs.size());
+				nc.recv_types.resize(nc.recv_dirs.size(), MPI_DOUBLE);
+
+#ifdef L_MPI_VERBOSE
+				*logout << "Graph for L" << l << "R" << r << (rev == 1 ? " (reverse)" : "") << " has " 
+					<< destinations.size() << " outgoing and " << sources.size() << " incoming edges." << std::endl;
+#endif
+			}
+		}
 	}
 
+	MPI_Group_free(&world_group);
+
+}
+
+// ************************************************************************* //
+/// \brief	Free the graph topologies.
+///
+///			Must be called when no exchange is in progress.
+void MpiManager::mpi_freeNeighbourComms() {
+
+	for (NeighbourCommStruct &nc : neighbour_comms) {
+		if (nc.comm != MPI_COMM_NULL) MPI_Comm_free(&nc.comm);
+	}
+	neighbour_comms.clear();
 
 }
 
+// ************************************************************************* //
+/// \brief	Post the neighbourhood collective exchange of a grid.
+///
+///			The packed send buffers and the receive buffers of each direction 
+///			are addressed in place using absolute displacements so no 
+///			contiguous copy of the buffers is needed. Must be called after all
+///			the directions have been packed.
+///
+/// \param	g	grid being communicated.
+void MpiManager::mpi_neighbourExchangeStart(GridObj* const g) {
+
+	bool bReverse = false;
+#ifdef L_USE_AA_STREAMING
+	bReverse = (g->t % 2 == 0);
+#endif
+
+	// Find graph of this grid
+	NeighbourCommStruct *nc = nullptr;
+	for (NeighbourCommStruct &n : neighbour_comms) {
+		if (n.level == g->level && n.region == g->region_number && n.reverse == bReverse) nc = &n;
+	}
+	if (nc == nullptr || nc->comm == MPI_COMM_NULL)
+		L_ERROR("Graph topology for L" + std::to_string(g->level) + "R" + std::to_string(g->region_number) + 
+			" not found. Exiting.", GridUtils::logfile);
+
+	// Buffers may have been reallocated so get their current addresses
+	for (size_t e = 0; e < nc->send_dirs.size(); e++) {
+		int dir = nc->send_dirs[e];
+		nc->send_counts[e] = static_cast<int>(f_buffer_send[dir].size());
+		MPI_Get_address(f_buffer_send[dir].data(), &nc->send_displs[e]);
+	}
+	for (size_t e = 0; e < nc->recv_dirs.size(); e++) {
+		int dir = nc->recv_dirs[e];
+		nc->recv_counts[e] = static_cast<int>(f_buffer_recv[dir].size());
+		MPI_Get_address(f_buffer_recv[dir].data(), &nc->recv_displs[e]);
+	}
+
+#ifdef L_MPI_VERBOSE
+	*logout << "L" << g->level << "R" << g->region_number << " -- Posting neighbourhood collective on "
+		<< nc->send_dirs.size() << " outgoing and " << nc->recv_dirs.size() << " incoming edges." << std::endl;
+#endif
+
+	MPI_Ineighbor_alltoallw(MPI_BOTTOM, nc->send_counts.data(), nc->send_displs.data(), nc->send_types.data(),
+		MPI_BOTTOM, nc->recv_counts.data(), nc->recv_displs.data(), nc->recv_types.data(), 
+		nc->comm, &mpi_getHaloExchange(g)->neighbour_request);
+
+}
+#endif
+
 // ************************************************************************* //
 /// \brief	Pre-calcualtion of the buffer sizes.
 ///
@@ -823,6 +1336,38 @@ void MpiManager::mpi_buffer_size() {
 
 	*GridUtils::logfile << "Pre-computing buffer sizes for MPI...";
 
+#ifdef L_MPI_PERSISTENT
+	// Existing persistent requests refer to the old buffer sizes
+	mpi_freePersistentComms();
+#endif
+#ifdef L_MPI_NEIGHBOUR_COLLECTIVES
+	// Existing graphs refer to the old communicating directions
+	mpi_freeNeighbourComms();
+#endif
+
+	// Sites found for a previous hierarchy are no longer valid
+	buffer_send_info.clear();
+	buffer_recv_info.clear();
+
+	/* Populations which cross into the neighbour in each direction. With 
+	 * in-place streaming the populations are not all held in their usual 
+	 * slots so every population is passed. With sub-grids every population is
+	 * also passed as explosion and coalescence read complete sets from the
+	 * halo sites. */
+	for (int dir = 0; dir < L_MPI_DIRS; dir++) {
+		crossing_vels[dir].clear();
+		for (int v = 0; v < L_NUM_VELS; v++) {
+			bool bCrosses = true;
+#if (!defined L_USE_AA_STREAMING && L_NUM_LEVELS == 0)
+			for (int d = 0; d < L_DIMS; d++) {
+				if (neighbour_vectors[d][dir] != 0 && c[d][v] != neighbour_vectors[d][dir])
+					bCrosses = false;
+			}
+#endif
+			if (bCrosses) crossing_vels[dir].push_back(v);
+		}
+	}
+
 	/* For each grid in the hierarchy find communicating edges and store the buffer size.
 	 * The data are arranged:
 	 *
@@ -855,9 +1400,10 @@ void MpiManager::mpi_buffer_size() {
 			/* Not every edge of a grid needs to be communicated.
 			 * We therefore loop over the appropriate region of the grid and 
 			 * check whether a site lies in the associated sender / receiver 
-			 * layer. If so increment the buffer size counter. */
+			 * layer. If so it is added to the site list used to pack or unpack
+			 * the buffer. This must be repeated if the grid changes. */
 
-			// Call send and recv size finding routines
+			// Call send and recv site finding routines
 			mpi_buffer_size_send(g);
 			mpi_buffer_size_recv(g);
 
@@ -883,6 +1429,11 @@ void MpiManager::mpi_buffer_size() {
 
 	*GridUtils::logfile << "Complete." << std::endl;
 
+#ifdef L_MPI_NEIGHBOUR_COLLECTIVES
+	// Graphs of the ranks which communicate on each grid
+	mpi_buildNeighbourComms();
+#endif
+
 #ifdef L_MPI_VERBOSE
 	/* Historically, there have been cases of MPI hangs due to buffer
 	* size inconsistencies between ranks. These are difficult to debug
@@ -908,7 +1459,7 @@ void MpiManager::mpi_buffer_size() {
 				if (l == 0 && r != 0) continue;		// L0 can only be R0
 
 				// Try retireve the buffer size info
-				for (MpiManager::BufferSizeStruct bufs : buffer_send_info)
+				for (const MpiManager::BufferSizeStruct &bufs : buffer_send_info)
 				{
 					if (bufs.level == l && bufs.region == r)
 					{
@@ -954,7 +1505,7 @@ void MpiManager::mpi_buffer_size() {
 				if (l == 0 && r != 0) continue;		// L0 can only be R0
 
 				// Try retireve the buffer size info
-				for (MpiManager::BufferSizeStruct bufr : buffer_recv_info)
+				for (const MpiManager::BufferSizeStruct &bufr : buffer_recv_info)
 				{
 					if (bufr.level == l && bufr.region == r)
 					{
@@ -1214,6 +1765,11 @@ void MpiManager::mpi_updateLoadInfo(GridManager* const grid_man) {
 
 	if (ops_count_buffer) delete[] ops_count_buffer;
 
+#ifdef L_MPI_COST_MODEL
+	// Measure the features of the cost model on the grids and bodies
+	mpi_measureCostFeatures();
+#endif
+
 }
 // ************************************************************************* //
 /// \brief	Populate the rank size arrays based on uniform decomposition logic
@@ -1400,9 +1956,15 @@ void MpiManager::mpi_SDReconstructSolution(SDData& solutionData, std::vector<int
 void MpiManager::mpi_SDComputeImbalance(LoadImbalanceData& load,
 	SDData& solutionData, std::vector<int>& numCores)
 {
+#ifdef L_MPI_COST_MODEL
+	double count = 0.0;
+	double countMax = 0.0;
+	double countMin = std::numeric_limits<double>::max();
+#else
 	size_t count = 0;
 	size_t countMax = 0;
 	size_t countMin = std::numeric_limits<size_t>::max();
+#endif
 
 	// Construct bounds for each block and then find active cell count from grid manager
 	double bounds[6];
@@ -1420,8 +1982,13 @@ void MpiManager::mpi_SDComputeImbalance(LoadImbalanceData& load,
 				bounds[eZMin] = solutionData.ZSol[k];
 				bounds[eZMax] = solutionData.ZSol[k + 1];
 
+#ifdef L_MPI_COST_MODEL
+				// Get cost of block from the model
+				count = costModel.getBlockCost(&bounds[0]);
+#else
 				// Get active operation count
 				count = GridManager::getInstance()->getActiveCellCount(&bounds[0], true);
+#endif
 
 				// Update the extremes
 				if (count > countMax)
@@ -1440,7 +2007,7 @@ void MpiManager::mpi_SDComputeImbalance(LoadImbalanceData& load,
 	// Update load imbalance
 	load.loadImbalance = 
 		std::abs(static_cast<double>(countMax) - static_cast<double>(countMin)) * 100.0 / static_cast<double>(countMax);
-	load.heaviestOps = countMax;
+	load.heaviestOps = static_cast<size_t>(countMax);
 
 }
 
@@ -1490,6 +2057,11 @@ MpiManager::LoadImbalanceData MpiManager::mpi_smartDecompose(double dh, std::vec
 		domainSize[eYDirection] = L_M;
 		domainSize[eZDirection] = L_K;
 
+#ifdef L_MPI_COST_MODEL
+		// Build the cost model on first use
+		if (!costModel.isBuilt()) mpi_buildCostModel();
+#endif
+
 		// Fix the edges as we know where they are
 		solutionData.XSol[0] = 0.0;
 		solutionData.YSol[0] = 0.0;
@@ -1699,7 +2271,10 @@ void MpiManager::mpi_SDCommunicateSolution(SDData& solutionData, double imbalanc
 ///
 ///			This method terminates the application on completion. Only compatible
 ///			with smart decomposition at present. Uses the values of L_MPI_?CORES
-///			as the upper threshold for options.
+///			as the upper threshold for options. For each number of ranks the
+///			imbalance of recursive bisection and Hilbert curve decompositions
+///			is also reported together with the largest number of neighbours a
+///			block would have and the gain over the smart decomposition.
 ///
 ///	\param	dh			coarse cell spacing.
 void MpiManager::mpi_reportOnDecomposition(double dh)
@@ -1723,7 +2298,12 @@ void MpiManager::mpi_reportOnDecomposition(double dh)
 		L_INFO("Writing report...", GridUtils::logfile);
 
 		// Write header
-		reportFile << "Case\tXCORES\tYCORES\tZCORES\tTotalCore\tImbalance\tUniform\tHeaviestOps\t" << std::endl;
+		reportFile << "Case\tXCORES\tYCORES\tZCORES\tTotalCore\tImbalance\tUniform\tHeaviestOps\t" <<
+			"RCBImbalance\tRCBMaxNeighbours\tHilbertImbalance\tHilbertMaxNeighbours\tGain\t" << std::endl;
+
+		// Site costs for the non-uniform decompositions
+		std::vector<double> siteCosts;
+		mpi_getSiteCosts(siteCosts);
 
 		// Loop over each case
 		for (int i = 1; i < L_MPI_TOP_XCORES + 1; ++i)
@@ -1748,7 +2328,28 @@ void MpiManager::mpi_reportOnDecomposition(double dh)
 					reportFile << std::to_string(i * j * k) + "\t";
 					reportFile << std::to_string(load.loadImbalance) + "\t";
 					reportFile << std::to_string(load.uniImbalance) + "\t";
-					reportFile << std::to_string(load.heaviestOps);
+					reportFile << std::to_string(load.heaviestOps) + "\t";
+
+					// Non-uniform decompositions with the same number of blocks
+					std::vector<int> owner;
+					std::vector<std::vector<int>> neighbours;
+					double heaviestCost;
+					size_t maxNeighbours;
+					mpi_bisectionDecompose(i * j * k, siteCosts, owner);
+					double rcbImbalance = mpi_evaluateDecomposition(i * j * k, siteCosts, owner, neighbours, heaviestCost);
+					maxNeighbours = 0;
+					for (auto &list : neighbours) maxNeighbours = std::max(maxNeighbours, list.size());
+					reportFile << std::to_string(rcbImbalance) + "\t";
+					reportFile << std::to_string(maxNeighbours) + "\t";
+					mpi_curveDecompose(i * j * k, siteCosts, owner);
+					double curveImbalance = mpi_evaluateDecomposition(i * j * k, siteCosts, owner, neighbours, heaviestCost);
+					maxNeighbours = 0;
+					for (auto &list : neighbours) maxNeighbours = std::max(maxNeighbours, list.size());
+					reportFile << std::to_string(curveImbalance) + "\t";
+					reportFile << std::to_string(maxNeighbours) + "\t";
+
+					// Gain of the best non-uniform decomposition over the smart decomposition
+					reportFile << std::to_string(load.loadImbalance - std::min(rcbImbalance, curveImbalance));
 					reportFile << std::endl;
 				}
 			}
@@ -1817,6 +2418,154 @@ void MpiManager::mpi_setSubGridDepth()
 	}
 }
 
+// *****************************************************************************
+///	\brief	Rebuild the communication set up after the grid hierarchy changes.
+///
+///			Must be called by all ranks once the new hierarchy is in place. The
+///			level communicators, IBM marker communication and support, halo 
+///			buffers, sub-grid communicators, writable data and load 
+///			information are all rebuilt for the grids now on each rank.
+void MpiManager::mpi_updateHierarchy()
+{
+	GridManager *gm = GridManager::getInstance();
+
+	// Rebuild the level communicators
+	for (MPI_Comm &comm : lev_comm)
+	{
+		if (comm != MPI_COMM_NULL) MPI_Comm_free(&comm);
+	}
+	mpi_setSubGridDepth();
+
+#ifdef L_IBM_ON
+	// Pass the markers to their new ranks then rebuild the support
+	ObjectManager *objMan = ObjectManager::getInstance();
+	for (int lev = 0; lev <= rankGrids[my_rank]; ++lev)
+		objMan->ibm_updateMarkers(lev, true);
+	for (int lev = rankGrids[my_rank] + 1; lev <= L_NUM_LEVELS; ++lev)
+	{
+		markerCommOwnerSide[lev].clear();
+		markerCommMarkerSide[lev].clear();
+		supportCommMarkerSide[lev].clear();
+		supportCommSupportSide[lev].clear();
+	}
+	objMan->ibm_initialise();
+#endif
+
+	// Rebuild the halo exchange, writable data and load information
+	gm->p_data.clear();
+	for (int reg = 0; reg < L_NUM_REGIONS; ++reg)
+	{
+		for (int lev = 1; lev <= L_NUM_LEVELS; ++lev)
+		{
+			MPI_Comm &comm = subGrid_comm[(lev - 1) + reg * L_NUM_LEVELS];
+			if (comm != MPI_COMM_NULL) MPI_Comm_free(&comm);
+		}
+	}
+	mpi_buffer_size();
+	mpi_buildCommunicators(gm);
+	mpi_updateLoadInfo(gm);
+}
+
+// *****************************************************************************
+///	\brief	Pass packed sites to the ranks on which they exist.
+///
+///			Each site is a block of nValues values starting with its level, 
+///			region and position. A copy of the site is passed to every rank 
+///			whose core or halo (including periodic images) contains the 
+///			position so that the receiving grids, halos included, can be 
+///			filled from the sites received. Must be called by all ranks.
+///
+///	\param[in,out]	sites		packed sites to send (released on exit).
+///	\param			nValues		number of values per site.
+///	\param[out]		recvBuffer	packed sites received from all ranks.
+void MpiManager::mpi_passSitesToRanks(std::vector<double>& sites, int nValues, std::vector<double>& recvBuffer)
+{
+	double dh = L_COARSE_SITE_WIDTH;
+	GridManager *gm = GridManager::getInstance();
+
+	// Core edges of each block of the topology
+	std::vector<double> blockMin[3], blockMax[3];
+	for (int d = 0; d < L_DIMS; ++d)
+	{
+		blockMin[d].resize(dimensions[d]);
+		blockMax[d].resize(dimensions[d]);
+	}
+	for (int r = 0; r < num_ranks; ++r)
+	{
+		int coords[L_DIMS];
+		MPI_Cart_coords(world_comm, r, L_DIMS, coords);
+		for (int d = 0; d < L_DIMS; ++d)
+		{
+			blockMin[d][coords[d]] = rank_core_edge[2 * d][r];
+			blockMax[d][coords[d]] = rank_core_edge[2 * d + 1][r];
+		}
+	}
+
+	// Copy each site to every rank whose core or halo (including periodic images) contains it
+	std::vector<std::vector<double>> sendSites(num_ranks);
+	std::vector<int> blocks[3];
+	for (size_t s = 0; s < sites.size(); s += nValues)
+	{
+		for (int d = 0; d < L_DIMS; ++d)
+		{
+			blocks[d].clear();
+			double pos = sites[s + 2 + d];
+			double length = gm->global_edges[2 * d + 1][0];
+			for (int c = 0; c < dimensions[d]; ++c)
+			{
+				if (dimensions[d] == 1 ||
+					(pos > blockMin[d][c] - dh && pos < blockMax[d][c] + dh) ||
+					(pos - length > blockMin[d][c] - dh && pos - length < blockMax[d][c] + dh) ||
+					(pos + length > blockMin[d][c] - dh && pos + length < blockMax[d][c] + dh))
+					blocks[d].push_back(c);
+			}
+		}
+
+		int coords[L_DIMS];
+		int toRank;
+		for (int bx : blocks[eXDirection])
+		{
+			coords[eXDirection] = bx;
+			for (int by : blocks[eYDirection])
+			{
+				coords[eYDirection] = by;
+#if (L_DIMS == 3)
+				for (int bz : blocks[eZDirection])
+				{
+					coords[eZDirection] = bz;
+#endif
+					MPI_Cart_rank(world_comm, coords, &toRank);
+					sendSites[toRank].insert(sendSites[toRank].end(), sites.begin() + s, sites.begin() + s + nValues);
+#if (L_DIMS == 3)
+				}
+#endif
+			}
+		}
+	}
+	std::vector<double>().swap(sites);
+
+	// Exchange the sites
+	std::vector<int> sendCounts(num_ranks), recvCounts(num_ranks);
+	std::vector<int> sendDispls(num_ranks, 0), recvDispls(num_ranks, 0);
+	for (int r = 0; r < num_ranks; ++r) sendCounts[r] = static_cast<int>(sendSites[r].size());
+	MPI_Alltoall(sendCounts.data(), 1, MPI_INT, recvCounts.data(), 1, MPI_INT, world_comm);
+	for (int r = 1; r < num_ranks; ++r)
+	{
+		sendDispls[r] = sendDispls[r - 1] + sendCounts[r - 1];
+		recvDispls[r] = recvDispls[r - 1] + recvCounts[r - 1];
+	}
+	std::vector<double> sendBuffer;
+	sendBuffer.reserve(sendDispls.back() + sendCounts.back());
+	for (int r = 0; r < num_ranks; ++r)
+	{
+		sendBuffer.insert(sendBuffer.end(), sendSites[r].begin(), sendSites[r].end());
+		std::vector<double>().swap(sendSites[r]);
+	}
+	recvBuffer.assign(recvDispls.back() + recvCounts.back(), 0.0);
+	MPI_Alltoallv(sendBuffer.data(), sendCounts.data(), sendDispls.data(), MPI_DOUBLE,
+		recvBuffer.data(), recvCounts.data(), recvDispls.data(), MPI_DOUBLE, world_comm);
+}
+
 // *****************************************************************************
 ///	\brief	Maps rank numbers from level communicator to world communcator
 ///
@@ -0,0 +1,273 @@
+/*
+* --------------------------------------------------------------
+*
+* ------ Lattice Boltzmann @ The University of Manchester ------
+*
+* -------------------------- L-U-M-A ---------------------------
+*
+* Copyright 2019 The University of Manchester
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.*
+*/
+#include "../inc/stdafx.h"
+#include "../inc/GridObj.h"
+#include "../inc/ObjectManager.h"
+
+#ifdef L_MPI_COST_MODEL
+
+// *****************************************************************************
+///	\brief	Build the cost model used by the smart decomposition.
+///
+///			Only called by the master. Features are read from the cost map of 
+///			a previous run if requested and available, otherwise they are 
+///			estimated from the refinement and wall configuration.
+void MpiManager::mpi_buildCostModel()
+{
+#ifdef L_MPI_COST_MAP_FILE
+#ifdef L_MPI_COST_CALIBRATE
+	bool bReadWeights = true;
+#else
+	bool bReadWeights = false;
+#endif
+	if (costModel.read("./input/cost_map.in", bReadWeights))
+	{
+		L_INFO("Cost map read from file.", GridUtils::logfile);
+		return;
+	}
+	L_WARN("Cost map file missing or does not match the grid. Using analytic cost estimate.", GridUtils::logfile);
+#endif
+
+	costModel.buildAnalytic();
+}
+
+// *****************************************************************************
+///	\brief	Measure the cost features of this rank.
+///
+///			Must be called by all ranks once the grids and bodies have been
+///			initialised. Features of the core sites of each grid, BFL links and
+///			IBM support sites are counted per coarse time step against the 
+///			coarse site in which they lie. The features of all ranks are 
+///			assembled on the master to replace the cost map used for the 
+///			decomposition and the predicted imbalance of the current 
+///			decomposition is logged.
+void MpiManager::mpi_measureCostFeatures()
+{
+	const int F = eCostNumFeatures;
+	double dh = L_COARSE_SITE_WIDTH;
+
+	// Coarse sites of this rank's core
+	int box[6] = { 0, 1, 0, 1, 0, 1 };
+	for (int d = 0; d < L_DIMS; ++d)
+	{
+		box[2 * d] = static_cast<int>(std::round(rank_core_edge[2 * d][my_rank] / dh));
+		box[2 * d + 1] = static_cast<int>(std::round(rank_core_edge[2 * d + 1][my_rank] / dh));
+	}
+	int nx = box[eXMax] - box[eXMin];
+	int ny = box[eYMax] - box[eYMin];
+	int nz = box[eZMax] - box[eZMin];
+	std::vector<double> localFeatures(static_cast<size_t>(nx) * ny * nz * F, 0.0);
+
+	// Add to the feature of the coarse site containing a position
+	auto addFeature = [&](double x, double y, double z, eCostFeature feature, double amount)
+	{
+		int ci = std::min(std::max(static_cast<int>(std::floor(x / dh)) - box[eXMin], 0), nx - 1);
+		int cj = std::min(std::max(static_cast<int>(std::floor(y / dh)) - box[eYMin], 0), ny - 1);
+#if (L_DIMS == 3)
+		int ck = std::min(std::max(static_cast<int>(std::floor(z / dh)) - box[eZMin], 0), nz - 1);
+#else
+		int ck = 0;
+#endif
+		localFeatures[(ck + nz * (cj + ny * static_cast<size_t>(ci))) * F + feature] += amount;
+	};
+
+	// Sites of each grid (each updated 2^level times per coarse step)
+	for (int lev = 0; lev <= L_NUM_LEVELS; ++lev)
+	{
+		for (int reg = 0; reg < L_NUM_REGIONS; ++reg)
+		{
+			GridObj *g = nullptr;
+			GridUtils::getGrid(lev, reg, g);
+			if (!g) continue;
+
+			double ops = std::pow(2.0, lev);
+			for (int i = 0; i < g->N_lim; ++i)
+			{
+				for (int j = 0; j < g->M_lim; ++j)
+				{
+					for (int k = 0; k < g->K_lim; ++k)
+					{
+						if (GridUtils::isOnRecvLayer(g->XPos[i], g->YPos[j], g->ZPos[k])) continue;
+						addFeature(g->XPos[i], g->YPos[j], g->ZPos[k],
+							CostModel::getFeature(g->LatTyp(i, j, k, g->M_lim, g->K_lim)), ops);
+					}
+				}
+			}
+		}
+	}
+
+	ObjectManager *objMan = ObjectManager::getInstance();
+
+	// BFL links of markers on the core
+	for (BFLBody &body : objMan->pBody)
+	{
+		double ops = std::pow(2.0, body.level);
+		for (size_t m = 0; m < body.markers.size(); ++m)
+		{
+			BFLMarker &marker = body.markers[m];
+			eLocationOnRank loc = eNone;
+			if (!GridUtils::isOnThisRank(marker.position[eXDirection], marker.position[eYDirection], 
+				marker.position[eZDirection], &loc, body._Owner) || loc != eCore) continue;
+
+			for (int v = 0; v < L_NUM_VELS; ++v)
+			{
+				if (body.Q[v + L_NUM_VELS * m] != -1)
+					addFeature(marker.position[eXDirection], marker.position[eYDirection], 
+					marker.position[eZDirection], eCostBFLLink, ops);
+			}
+		}
+	}
+
+	// Support sites of IBM markers owned by this rank
+	for (IBBody &body : objMan->iBody)
+	{
+		double ops = std::pow(2.0, body.level);
+		for (int m : body.validMarkers)
+		{
+			IBMarker &marker = body.markers[m];
+			for (size_t s = 0; s < marker.supp_x.size(); ++s)
+				addFeature(marker.supp_x[s], marker.supp_y[s], marker.supp_z[s], eCostIBMSupport, ops);
+		}
+	}
+
+	// Total features of this rank
+	rank_features.assign(F, 0.0);
+	for (size_t s = 0; s < localFeatures.size(); s += F)
+	{
+		for (int n = 0; n < F; ++n) rank_features[n] += localFeatures[s + n];
+	}
+
+	// Gather boxes and features on the master
+	std::vector<int> boxes(my_rank == 0 ? 6 * num_ranks : 0);
+	MPI_Gather(&box[0], 6, MPI_INT, boxes.data(), 6, MPI_INT, 0, world_comm);
+	std::vector<double> allRankFeatures(my_rank == 0 ? F * num_ranks : 0);
+	MPI_Gather(rank_features.data(), F, MPI_DOUBLE, allRankFeatures.data(), F, MPI_DOUBLE, 0, world_comm);
+
+	std::vector<int> recvCounts, displs;
+	std::vector<double> allFeatures;
+	if (my_rank == 0)
+	{
+		recvCounts.resize(num_ranks);
+		displs.resize(num_ranks, 0);
+		for (int r = 0; r < num_ranks; ++r)
+		{
+			recvCounts[r] = (boxes[6 * r + eXMax] - boxes[6 * r + eXMin]) *
+				(boxes[6 * r + eYMax] - boxes[6 * r + eYMin]) *
+				(boxes[6 * r + eZMax] - boxes[6 * r + eZMin]) * F;
+			if (r > 0) displs[r] = displs[r - 1] + recvCounts[r - 1];
+		}
+		allFeatures.resize(displs.back() + recvCounts.back());
+	}
+	MPI_Gatherv(localFeatures.data(), static_cast<int>(localFeatures.size()), MPI_DOUBLE, 
+		allFeatures.data(), recvCounts.data(), displs.data(), MPI_DOUBLE, 0, world_comm);
+
+	if (my_rank != 0) return;
+
+	// Assemble the map from the blocks of each rank
+	costModel.features.assign(static_cast<size_t>(L_N) * L_M * L_K * F, 0.0);
+	for (int r = 0; r < num_ranks; ++r)
+	{
+		int *b = &boxes[6 * r];
+		double *rf = &allFeatures[displs[r]];
+		for (int i = b[eXMin]; i < b[eXMax]; ++i)
+		{
+			for (int j = b[eYMin]; j < b[eYMax]; ++j)
+			{
+				for (int k = b[eZMin]; k < b[eZMax]; ++k)
+				{
+					for (int n = 0; n < F; ++n)
+						costModel.features[(k + L_K * (j + L_M * static_cast<size_t>(i))) * F + n] = *rf++;
+				}
+			}
+		}
+	}
+	costModel.updateCosts();
+
+	// Predicted imbalance of the current decomposition
+	double costMax = 0.0;
+	double costMin = std::numeric_limits<double>::max();
+	for (int r = 0; r < num_ranks; ++r)
+	{
+		double cost = costModel.getCost(&allRankFeatures[r * F]);
+		costMax = std::max(costMax, cost);
+		costMin = std::min(costMin, cost);
+	}
+	L_INFO("Cost model predicts an imbalance of " + std::to_string((costMax - costMin) * 100.0 / costMax) + 
+		"% for this decomposition.", GridUtils::logfile);
+}
+
+// *****************************************************************************
+///	\brief	Write the cost map for use by future runs.
+///
+///			Must be called by all ranks at the end of the simulation. The 
+///			measured time per coarse time step of each rank is gathered on the
+///			master and compared with the cost predicted by the model. If 
+///			calibration is on, the weights are fitted to the measured times 
+///			first. The map is written to the output directory and must be 
+///			copied to ./input/cost_map.in to be used by a subsequent run.
+void MpiManager::mpi_writeCostMap()
+{
+	const int F = eCostNumFeatures;
+
+	// Time spent updating the grids of this rank per coarse time step
+	double time = 0.0;
+	for (int lev = 0; lev <= L_NUM_LEVELS; ++lev)
+	{
+		for (int reg = 0; reg < L_NUM_REGIONS; ++reg)
+		{
+			GridObj *g = nullptr;
+			GridUtils::getGrid(lev, reg, g);
+			if (g) time += g->timeav_timestep * std::pow(2.0, lev);
+		}
+	}
+
+	// Gather times and features on the master
+	std::vector<double> allTimes(my_rank == 0 ? num_ranks : 0);
+	MPI_Gather(&time, 1, MPI_DOUBLE, allTimes.data(), 1, MPI_DOUBLE, 0, world_comm);
+	std::vector<double> allRankFeatures(my_rank == 0 ? F * num_ranks : 0);
+	MPI_Gather(rank_features.data(), F, MPI_DOUBLE, allRankFeatures.data(), F, MPI_DOUBLE, 0, world_comm);
+
+	if (my_rank != 0) return;
+
+	// Measured imbalance
+	double timeMax = *std::max_element(allTimes.begin(), allTimes.end());
+	double timeMin = *std::min_element(allTimes.begin(), allTimes.end());
+	if (timeMax > 0.0)
+		L_INFO("Measured imbalance of step times is " + std::to_string((timeMax - timeMin) * 100.0 / timeMax) + "%.", GridUtils::logfile);
+
+#ifdef L_MPI_COST_CALIBRATE
+	if (costModel.fitWeights(allRankFeatures, allTimes))
+	{
+		std::string msg("Calibrated cost weights =");
+		for (int n = 0; n < F; ++n) msg += " " + std::to_string(costModel.weights[n]);
+		L_INFO(msg, GridUtils::logfile);
+	}
+	else
+	{
+		L_WARN("Cost weights could not be calibrated from the measured times. Keeping current weights.", GridUtils::logfile);
+	}
+#endif
+
+	costModel.write(GridUtils::path_str + "/cost_map.out");
+}
+
+#endif
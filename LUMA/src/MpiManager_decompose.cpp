@@ -0,0 +1,308 @@
+/*
+* --------------------------------------------------------------
+*
+* ------ Lattice Boltzmann @ The University of Manchester ------
+*
+* -------------------------- L-U-M-A ---------------------------
+*
+* Copyright 2019 The University of Manchester
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.*
+*/
+#include "../inc/stdafx.h"
+
+/* Decompositions in this file assign each coarse site to a block without the
+ * blocks having to form a tensor-product grid. Each block may therefore have
+ * any number of neighbours and these are returned as a list rather than the 
+ * fixed directions of the Cartesian topology. */
+
+// ************************************************************************* //
+/// \brief	Get the cost of each coarse site.
+///
+///			Uses the cost model if enabled, otherwise the active operation count
+///			per coarse time step of the finest grid covering the site.
+///
+///	\param[out]	costs	cost of each coarse site (k fastest then j and i).
+void MpiManager::mpi_getSiteCosts(std::vector<double>& costs)
+{
+	costs.resize(static_cast<size_t>(L_N) * L_M * L_K);
+
+#ifdef L_MPI_COST_MODEL
+	if (!costModel.isBuilt()) mpi_buildCostModel();
+#else
+	double dh = L_COARSE_SITE_WIDTH;
+#endif
+
+	for (int i = 0; i < L_N; ++i)
+	{
+		for (int j = 0; j < L_M; ++j)
+		{
+			for (int k = 0; k < L_K; ++k)
+			{
+#ifdef L_MPI_COST_MODEL
+				costs[k + L_K * (j + L_M * static_cast<size_t>(i))] = costModel.getSiteCost(i, j, k);
+#else
+				int lev = CostModel::getFinestLevel((i + 0.5) * dh, (j + 0.5) * dh, (k + 0.5) * dh);
+				costs[k + L_K * (j + L_M * static_cast<size_t>(i))] = std::pow(2.0, lev * (L_DIMS + 1));
+#endif
+			}
+		}
+	}
+}
+
+// ************************************************************************* //
+/// \brief	Decompose the coarse sites by recursive coordinate bisection.
+///
+///			The domain is split recursively across its longest side at the
+///			plane which best divides the cost in proportion to the number of 
+///			blocks on either side. Each block is a box of coarse sites but the
+///			boxes do not need to align with those of their neighbours.
+///
+///	\param		numBlocks	number of blocks to produce.
+///	\param		costs		cost of each coarse site.
+///	\param[out]	owner		block of each coarse site.
+void MpiManager::mpi_bisectionDecompose(int numBlocks, 
+	std::vector<double>& costs, std::vector<int>& owner)
+{
+	owner.assign(costs.size(), 0);
+	int lo[3] = { 0, 0, 0 };
+	int hi[3] = { L_N, L_M, L_K };
+	mpi_bisect(lo, hi, 0, numBlocks, costs, owner);
+}
+
+// ************************************************************************* //
+/// \brief	Recursively bisect a box of coarse sites.
+///
+///	\param		lo			lower corner of box (inclusive).
+///	\param		hi			upper corner of box (exclusive).
+///	\param		firstBlock	ID of the first block in the box.
+///	\param		numBlocks	number of blocks the box is to be split into.
+///	\param		costs		cost of each coarse site.
+///	\param[out]	owner		block of each coarse site.
+void MpiManager::mpi_bisect(int *lo, int *hi, int firstBlock, int numBlocks,
+	std::vector<double>& costs, std::vector<int>& owner)
+{
+	// Choose the longest side which can be cut
+	int dir = -1;
+	for (int d = 0; d < L_DIMS; ++d)
+	{
+		if (hi[d] - lo[d] > 1 && (dir < 0 || hi[d] - lo[d] > hi[dir] - lo[dir])) dir = d;
+	}
+
+	// Assign the box to a single block if no further cut is required or possible
+	if (numBlocks == 1 || dir < 0)
+	{
+		for (int i = lo[eXDirection]; i < hi[eXDirection]; ++i)
+		{
+			for (int j = lo[eYDirection]; j < hi[eYDirection]; ++j)
+			{
+				for (int k = lo[eZDirection]; k < hi[eZDirection]; ++k)
+					owner[k + L_K * (j + L_M * static_cast<size_t>(i))] = firstBlock;
+			}
+		}
+		return;
+	}
+
+	// Cost of each plane of the box along the cut direction
+	std::vector<double> planeCost(hi[dir] - lo[dir], 0.0);
+	int ijk[3];
+	for (ijk[0] = lo[eXDirection]; ijk[0] < hi[eXDirection]; ++ijk[0])
+	{
+		for (ijk[1] = lo[eYDirection]; ijk[1] < hi[eYDirection]; ++ijk[1])
+		{
+			for (ijk[2] = lo[eZDirection]; ijk[2] < hi[eZDirection]; ++ijk[2])
+				planeCost[ijk[dir] - lo[dir]] += costs[ijk[2] + L_K * (ijk[1] + L_M * static_cast<size_t>(ijk[0]))];
+		}
+	}
+	double totalCost = std::accumulate(planeCost.begin(), planeCost.end(), 0.0);
+
+	// Find the cut which best matches the share of the lower half
+	int lowerBlocks = numBlocks / 2;
+	double target = totalCost * lowerBlocks / numBlocks;
+	double lowerCost = 0.0;
+	double bestError = std::numeric_limits<double>::max();
+	int cut = 1;
+	for (int c = 1; c < hi[dir] - lo[dir]; ++c)
+	{
+		lowerCost += planeCost[c - 1];
+		if (std::abs(lowerCost - target) < bestError)
+		{
+			bestError = std::abs(lowerCost - target);
+			cut = c;
+		}
+	}
+
+	// Recurse on each half
+	int mid[3] = { hi[0], hi[1], hi[2] };
+	mid[dir] = lo[dir] + cut;
+	mpi_bisect(lo, mid, firstBlock, lowerBlocks, costs, owner);
+	mid[0] = lo[0]; mid[1] = lo[1]; mid[2] = lo[2];
+	mid[dir] = lo[dir] + cut;
+	mpi_bisect(mid, hi, firstBlock + lowerBlocks, numBlocks - lowerBlocks, costs, owner);
+}
+
+// ************************************************************************* //
+/// \brief	Decompose the coarse sites along a Hilbert curve.
+///
+///			Sites are ordered along a Hilbert curve and the curve is cut into
+///			contiguous segments of equal cost. Blocks are compact but are not 
+///			in general boxes.
+///
+///	\param		numBlocks	number of blocks to produce.
+///	\param		costs		cost of each coarse site.
+///	\param[out]	owner		block of each coarse site.
+void MpiManager::mpi_curveDecompose(int numBlocks, 
+	std::vector<double>& costs, std::vector<int>& owner)
+{
+	// Bits required to index the largest side
+	int bits = 1;
+	while ((1 << bits) < std::max(std::max(L_N, L_M), L_K)) ++bits;
+
+	// Order sites along the curve
+	std::vector<std::pair<unsigned long long, size_t>> curve(costs.size());
+	for (int i = 0; i < L_N; ++i)
+	{
+		for (int j = 0; j < L_M; ++j)
+		{
+			for (int k = 0; k < L_K; ++k)
+			{
+				size_t id = k + L_K * (j + L_M * static_cast<size_t>(i));
+				curve[id] = std::make_pair(mpi_getHilbertKey(i, j, k, bits), id);
+			}
+		}
+	}
+	std::sort(curve.begin(), curve.end());
+
+	// Cut into segments at the midpoint cost of each site
+	double totalCost = std::accumulate(costs.begin(), costs.end(), 0.0);
+	double runningCost = 0.0;
+	owner.resize(costs.size());
+	for (auto &site : curve)
+	{
+		double midCost = runningCost + 0.5 * costs[site.second];
+		owner[site.second] = std::min(static_cast<int>(midCost * numBlocks / totalCost), numBlocks - 1);
+		runningCost += costs[site.second];
+	}
+}
+
+// ************************************************************************* //
+/// \brief	Get the position of a coarse site along a Hilbert curve.
+///
+///			Uses the transpose form of Skilling (2004) which works in both 2D
+///			and 3D.
+///
+///	\param	i		x-index of site.
+///	\param	j		y-index of site.
+///	\param	k		z-index of site.
+///	\param	bits	number of bits per coordinate.
+///	\returns		distance along the curve.
+unsigned long long MpiManager::mpi_getHilbertKey(int i, int j, int k, int bits)
+{
+	unsigned int X[3] = { static_cast<unsigned int>(i), static_cast<unsigned int>(j), static_cast<unsigned int>(k) };
+	unsigned int M = 1u << (bits - 1);
+	unsigned int P, Q, t;
+	int n = L_DIMS;
+
+	// Inverse undo
+	for (Q = M; Q > 1; Q >>= 1)
+	{
+		P = Q - 1;
+		for (int d = 0; d < n; ++d)
+		{
+			if (X[d] & Q) X[0] ^= P;
+			else
+			{
+				t = (X[0] ^ X[d]) & P;
+				X[0] ^= t;
+				X[d] ^= t;
+			}
+		}
+	}
+
+	// Gray encode
+	for (int d = 1; d < n; ++d) X[d] ^= X[d - 1];
+	t = 0;
+	for (Q = M; Q > 1; Q >>= 1)
+	{
+		if (X[n - 1] & Q) t ^= Q - 1;
+	}
+	for (int d = 0; d < n; ++d) X[d] ^= t;
+
+	// Interleave the transposed bits
+	unsigned long long key = 0;
+	for (int b = bits - 1; b >= 0; --b)
+	{
+		for (int d = 0; d < n; ++d) key = (key << 1) | ((X[d] >> b) & 1);
+	}
+
+	return key;
+}
+
+// ************************************************************************* //
+/// \brief	Evaluate a decomposition of the coarse sites into blocks.
+///
+///			Imbalance is measured as for the smart decomposition. The neighbours
+///			of each block are those owning any of the sites adjacent to its own
+///			sites (including across the periodic boundaries of the topology).
+///
+///	\param		numBlocks		number of blocks.
+///	\param		costs			cost of each coarse site.
+///	\param		owner			block of each coarse site.
+///	\param[out]	neighbours		list of neighbouring blocks of each block.
+///	\param[out]	heaviestCost	cost of the heaviest block.
+///	\returns					load imbalance as a percentage of the heaviest block.
+double MpiManager::mpi_evaluateDecomposition(int numBlocks, 
+	std::vector<double>& costs, std::vector<int>& owner,
+	std::vector<std::vector<int>>& neighbours, double& heaviestCost)
+{
+	// Cost of each block
+	std::vector<double> blockCost(numBlocks, 0.0);
+	for (size_t id = 0; id < costs.size(); ++id) blockCost[owner[id]] += costs[id];
+	heaviestCost = *std::max_element(blockCost.begin(), blockCost.end());
+	double lightestCost = *std::min_element(blockCost.begin(), blockCost.end());
+
+	// Neighbour lists
+	neighbours.assign(numBlocks, std::vector<int>());
+	int dims[3] = { L_N, L_M, L_K };
+	for (int i = 0; i < L_N; ++i)
+	{
+		for (int j = 0; j < L_M; ++j)
+		{
+			for (int k = 0; k < L_K; ++k)
+			{
+				int block = owner[k + L_K * (j + L_M * static_cast<size_t>(i))];
+				int ijk[3] = { i, j, k };
+				for (int di = -1; di <= 1; ++di)
+				{
+					for (int dj = -1; dj <= 1; ++dj)
+					{
+						for (int dk = (L_DIMS == 3 ? -1 : 0); dk <= (L_DIMS == 3 ? 1 : 0); ++dk)
+						{
+							int n[3] = { ijk[0] + di, ijk[1] + dj, ijk[2] + dk };
+							for (int d = 0; d < 3; ++d) n[d] = (n[d] + dims[d]) % dims[d];
+							int other = owner[n[2] + L_K * (n[1] + L_M * static_cast<size_t>(n[0]))];
+							if (other != block) neighbours[block].push_back(other);
+						}
+					}
+				}
+			}
+		}
+	}
+	for (auto &list : neighbours)
+	{
+		std::sort(list.begin(), list.end());
+		list.erase(std::unique(list.begin(), list.end()), list.end());
+	}
+
+	return (heaviestCost - lightestCost) * 100.0 / heaviestCost;
+}
@@ -122,10 +122,11 @@ void MpiManager::mpi_forceCommGather(int level) {
 ///	\brief	Do communication required for sending new marker positions after FEM
 ///
 ///	\param	level			current grid level
+///	\param	ownedBodies		indices of the bodies owned by this rank whose markers are sent
 ///	\param	markerIDs		IDs of markers that have been sent
 ///	\param	positions		positions of markers that have been sent
 ///	\param	vels			velocities of markers that have been sent
-void MpiManager::mpi_spreadNewMarkers(int level, std::vector<std::vector<int>> &markerIDs, std::vector<std::vector<std::vector<double>>> &positions, std::vector<std::vector<std::vector<double>>> &vels) {
+void MpiManager::mpi_spreadNewMarkers(int level, std::vector<int> &ownedBodies, std::vector<std::vector<int>> &markerIDs, std::vector<std::vector<std::vector<double>>> &positions, std::vector<std::vector<std::vector<double>>> &vels) {
 
 	// Get object manager instance
 	ObjectManager *objman = ObjectManager::getInstance();
@@ -141,7 +142,7 @@ void MpiManager::mpi_spreadNewMarkers(int level, std::vector<std::vector<int>> &
 	std::vector<std::vector<double>> sendPosAndVel(num_ranks, std::vector<double>());
 
 	// Loop through and pack data
-	for (auto ib : objman->idxFEM) {
+	for (auto ib : ownedBodies) {
 
 		// Only do if on this grid level
 		if (objman->iBody[ib]._Owner->level == level) {
@@ -228,7 +229,7 @@ void MpiManager::mpi_spreadNewMarkers(int level, std::vector<std::vector<int>> &
 			// Unpack positions
 			for (int d = 0; d < L_DIMS; d++) {
 				positionVec[d] = recvPositions[fromRank][marker*(L_DIMS*2)+d];
-				velVec[d] = recvPositions[fromRank][marker*(L_DIMS*2)+d+2];
+				velVec[d] = recvPositions[fromRank][marker*(L_DIMS*2)+d+L_DIMS];
 			}
 
 			// Push back
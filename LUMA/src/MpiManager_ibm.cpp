@@ -395,277 +395,54 @@ void MpiManager::mpi_epsilonCommGather(int level) {
 // *****************************************************************************
 ///	\brief	Do communication required to gather values for universal epsilon calculation
 ///
+///			Every rank on the level receives the marker data (position, 
+///			dilation and ds) of the valid markers on all ranks of the level 
+///			as these are the columns of its rows of the epsilon system.
+///
 ///	\param	level			current grid level.
-///	\param	rootRank		rank to which data should be passed.
-///	\param	iBodyTmp		temporary IBBody which is used for epsilon calculation.
-void MpiManager::mpi_uniEpsilonCommGather(int level, int rootRank, IBBody &iBodyTmp) {
-
-	// Get object manager instance
-	ObjectManager *objman = ObjectManager::getInstance();
+///	\param	cols			column data of this rank on entry and of all ranks on exit.
+///	\param	rowCounts		number of valid markers on each rank of the level.
+void MpiManager::mpi_uniEpsilonCommGather(int level, std::vector<double> &cols, std::vector<int> &rowCounts) {
 
 	// Get ranks which exist on this level
 	std::vector<int> lev2glob = mpi_mapRankLevelToWorld(level);
-	std::vector<int> glob2lev = mpi_mapRankWorldToLevel(level);
-
-	// Get root ID in this communicator
-	int rootRankLev = glob2lev[rootRank];
-
-	// Initialise values
-	int nMarkersOnThisRank = 0;
-	std::vector<int> deltasPerMarkerOnThisRank;
-
-	// Get how many markers and supports exist on each rank
-	for (int ib = 0; ib < objman->iBody.size(); ib++) {
-
-		// If this body is on this level
-		if (objman->iBody[ib].level == level) {
-
-			// Number of markers on this rank
-			nMarkersOnThisRank += static_cast<int>(objman->iBody[ib].validMarkers.size());
-
-			// Loop through markers and get number of deltas
-			for (auto m : objman->iBody[ib].validMarkers)
-				deltasPerMarkerOnThisRank.push_back(static_cast<int>(objman->iBody[ib].markers[m].deltaval.size()));
-		}
-	}
 
-	// Set receive buffer for how many markers on each rank
-	std::vector<int> nMarkersOnEachRank;
-	std::vector<int> nMarkersOnEachRankLev;
-	if (my_rank == rootRank) {
-		nMarkersOnEachRank.resize(num_ranks, 0);
-		nMarkersOnEachRankLev.resize(lev2glob.size(), 0);
-	}
+	// Number of values per marker
+	const int stride = L_DIMS + 2;
 
-	// Perform gather so root rank knows how many markers on each rank
-	MPI_Gather(&nMarkersOnThisRank, 1, MPI_INT, &nMarkersOnEachRankLev.front(), 1, MPI_INT, rootRankLev, lev_comm[level]);
+	// Gather how many markers are on each rank
+	int nMarkersOnThisRank = static_cast<int>(cols.size()) / stride;
+	rowCounts.resize(lev2glob.size(), 0);
+	MPI_Allgather(&nMarkersOnThisRank, 1, MPI_INT, &rowCounts.front(), 1, MPI_INT, lev_comm[level]);
 
-	// Insert into full vector
-	if (my_rank == rootRank) {
-		for (int levRank = 0; levRank < lev2glob.size(); levRank++)
-			nMarkersOnEachRank[lev2glob[levRank]] = nMarkersOnEachRankLev[levRank];
+	// Buffer sizes and displacements
+	std::vector<int> recvBufferSizes(lev2glob.size(), 0);
+	std::vector<int> recvBufferDisps(lev2glob.size(), 0);
+	for (size_t i = 0; i < lev2glob.size(); i++) {
+		recvBufferSizes[i] = rowCounts[i] * stride;
+		if (i > 0) recvBufferDisps[i] = recvBufferDisps[i - 1] + recvBufferSizes[i - 1];
 	}
 
-	// Get number of markers in whole system
-	int nSystemMarkers = std::accumulate(nMarkersOnEachRankLev.begin(), nMarkersOnEachRankLev.end(), 0);
-
-	// Create result and displacement arrays
-	std::vector<int> deltasPerMarkerOnEachRank;
-	std::vector<int> markerDisps;
-
-	// Root rank resize result and displacement arrays
-	if (my_rank == rootRank) {
-
-		// Resize result vector
-		deltasPerMarkerOnEachRank.resize(nSystemMarkers);
-		markerDisps.resize(lev2glob.size());
-
-		// Calculate block displacements
-		for (int i = 1; i < lev2glob.size(); i++)
-			markerDisps[i] = std::accumulate(nMarkersOnEachRankLev.begin(), nMarkersOnEachRankLev.begin()+i, 0);
-	}
-
-	// Gather so root rank knows how many support sites each markers has
-	MPI_Gatherv(&deltasPerMarkerOnThisRank.front(), nMarkersOnThisRank, MPI_INT, &deltasPerMarkerOnEachRank.front(), &nMarkersOnEachRankLev.front(), &markerDisps.front(), MPI_INT, rootRankLev, lev_comm[level]);
-
-	// Declare receive buffer vectors
-	std::vector<int> recvBufferSizes;
-	std::vector<int> recvBufferDisps;
-	std::vector<double> recvBuffer;
-
-	// Now create receive buffer, buffer size and buffer displacements
-	if (my_rank == rootRank) {
-
-		// Resize for number of ranks
-		recvBufferSizes.resize(lev2glob.size(), 0);
-		recvBufferDisps.resize(lev2glob.size(), 0);
-
-		// Counter
-		int count = 0;
-
-		// Loop through all ranks and sort out receive buffer
-		for (int fromRank = 0; fromRank < lev2glob.size(); fromRank++) {
-
-			// Loop through all markers which exist on this rank
-			for (int m = 0; m < nMarkersOnEachRankLev[fromRank]; m++) {
-
-				// Add contribution to buffer size
-				recvBufferSizes[fromRank] += (L_DIMS + 3) + deltasPerMarkerOnEachRank[count] * (L_DIMS + 1);
-
-				// Increment counter
-				count++;
-			}
-		}
-
-		// Calculate block displacements
-		for (int i = 1; i < lev2glob.size(); i++)
-			recvBufferDisps[i] = std::accumulate(recvBufferSizes.begin(), recvBufferSizes.begin()+i, 0);
-
-		// Resize receive buffer
-		recvBuffer.resize(std::accumulate(recvBufferSizes.begin(), recvBufferSizes.end(), 0), 0.0);
-	}
-
-	// Declare send buffer vector
-	std::vector<double> sendBuffer;
-
-	// Now pack data into send buffer
-	for (int ib = 0; ib < objman->iBody.size(); ib++) {
-
-		// If this body is on this level
-		if (objman->iBody[ib].level == level) {
-
-			// Loop through valid markers on this body
-			for (auto m : objman->iBody[ib].validMarkers) {
-
-				// Pack position first
-				sendBuffer.push_back(objman->iBody[ib].markers[m].position[eXDirection]);
-				sendBuffer.push_back(objman->iBody[ib].markers[m].position[eYDirection]);
-#if (L_DIMS == 3)
-				sendBuffer.push_back(objman->iBody[ib].markers[m].position[eZDirection]);
-#endif
-				sendBuffer.push_back(objman->iBody[ib].markers[m].local_area);
-				sendBuffer.push_back(objman->iBody[ib].markers[m].dilation);
-				sendBuffer.push_back(objman->iBody[ib].markers[m].ds);
-
-				// Now pack the support site data
-				for (int s = 0; s < objman->iBody[ib].markers[m].deltaval.size(); s++) {
-					sendBuffer.push_back(objman->iBody[ib].markers[m].supp_x[s]);
-					sendBuffer.push_back(objman->iBody[ib].markers[m].supp_y[s]);
-#if (L_DIMS == 3)
-					sendBuffer.push_back(objman->iBody[ib].markers[m].supp_z[s]);
-#endif
-					sendBuffer.push_back(objman->iBody[ib].markers[m].deltaval[s]);
-				}
-			}
-		}
-	}
-
-	// Now send all data to root
-	MPI_Gatherv(&sendBuffer.front(), static_cast<int>(sendBuffer.size()),
-		MPI_DOUBLE, &recvBuffer.front(), &recvBufferSizes.front(), &recvBufferDisps.front(),
-		MPI_DOUBLE, rootRankLev, lev_comm[level]);
-
-	// Set global values
-	iBodyTmp.owningRank = rootRank;
-	iBodyTmp.level = level;
-	iBodyTmp.dh = objman->_Grids->dh / pow(2.0, level);
-
-	// Unpack receive buffer
-	if (my_rank == rootRank) {
-
-		// Resize number of markers
-		iBodyTmp.markers.resize(nSystemMarkers);
-
-		// Counter
-		int count = 0;
-
-		// Marker ID
-		int m = 0;
-
-		// Now loop through all markers
-		for (int rank = 0; rank < num_ranks; rank++) {
-			for (int marker = 0; marker < nMarkersOnEachRank[rank]; marker++) {
-
-				// Get owning rank of marker (need this for the scatter later)
-				iBodyTmp.markers[m].owningRank = rank;
-
-				// Pack position
-				for (int d = 0; d < L_DIMS; d++)
-					iBodyTmp.markers[m].position[d] = recvBuffer[count+d];
-
-				// Increment
-				count += L_DIMS;
-
-				// Pack area and dilation
-				iBodyTmp.markers[m].local_area = recvBuffer[count]; count++;
-				iBodyTmp.markers[m].dilation = recvBuffer[count]; count++;
-				iBodyTmp.markers[m].ds = recvBuffer[count]; count++;
-
-				// Now pack support data
-				for (int s = 0; s < deltasPerMarkerOnEachRank[m]; s++) {
-					iBodyTmp.markers[m].supp_x.push_back(recvBuffer[count]); count++;
-					iBodyTmp.markers[m].supp_y.push_back(recvBuffer[count]); count++;
-#if (L_DIMS == 3)
-					iBodyTmp.markers[m].supp_z.push_back(recvBuffer[count]); count++;
-#endif
-					iBodyTmp.markers[m].deltaval.push_back(recvBuffer[count]); count++;
-				}
-
-				// Increment m
-				m++;
-			}
-		}
-	}
+	// Gather the marker data from all ranks
+	std::vector<double> sendBuffer(cols);
+	cols.resize(recvBufferDisps.back() + recvBufferSizes.back());
+	MPI_Allgatherv(sendBuffer.data(), static_cast<int>(sendBuffer.size()), MPI_DOUBLE,
+		cols.data(), &recvBufferSizes.front(), &recvBufferDisps.front(), MPI_DOUBLE, lev_comm[level]);
 }
 
 
 // *****************************************************************************
 ///	\brief	Do communication required to send values after universal epsilon calculation
 ///
+///			Epsilon is solved on the ranks holding the markers so only the 
+///			owning ranks of the bodies need updating.
+///
 ///	\param	level			current grid level.
-///	\param	rootRank		root rank which did the calculation.
-///	\param	iBodyTmp		temporary IBBody which is used for epsilon calculation
-void MpiManager::mpi_uniEpsilonCommScatter(int level, int rootRank, IBBody &iBodyTmp) {
+void MpiManager::mpi_uniEpsilonCommScatter(int level) {
 
 	// Get object manager instance
 	ObjectManager *objman = ObjectManager::getInstance();
 
-	// Get ranks which exist on this level
-	std::vector<int> lev2glob = mpi_mapRankLevelToWorld(level);
-	std::vector<int> glob2lev = mpi_mapRankWorldToLevel(level);
-
-	// Get root ID in this communicator
-	int rootRankLev = glob2lev[rootRank];
-
-	// Declare send buffer vectors
-	std::vector<int> sendBufferSizes;
-	std::vector<int> sendBufferDisps;
-	std::vector<double> sendBuffer;
-
-	// Root rank pack data into send buffer and sort sizes
-	if (my_rank == rootRank) {
-
-		// Set sizes
-		sendBufferSizes.resize(lev2glob.size(), 0);
-		sendBufferDisps.resize(lev2glob.size(), 0);
-
-		// Loop through pack epsilon and insert buffer sizes for each rank
-		for (int m = 0; m < iBodyTmp.markers.size(); m++) {
-			sendBuffer.push_back(iBodyTmp.markers[m].epsilon);
-			sendBufferSizes[glob2lev[iBodyTmp.markers[m].owningRank]]++;
-		}
-
-		// Calculate block displacements
-		for (int i = 1; i < static_cast<int>(lev2glob.size()); i++)
-			sendBufferDisps[i] = std::accumulate(sendBufferSizes.begin(), sendBufferSizes.begin()+i, 0);
-	}
-
-	// Get how many markers and supports exist on each rank
-	int nMarkersOnThisRank = 0;
-	for (int ib = 0; ib < objman->iBody.size(); ib++) {
-		if (objman->iBody[ib].level == level) {
-			nMarkersOnThisRank += static_cast<int>(objman->iBody[ib].validMarkers.size());
-		}
-	}
-
-
-	// Create receive buffer
-	std::vector<double> recvBuffer(nMarkersOnThisRank, 0.0);
-
-	// Scatter the epsilon values to the correct rank
-	MPI_Scatterv(&sendBuffer.front(), &sendBufferSizes.front(), &sendBufferDisps.front(), MPI_DOUBLE, &recvBuffer.front(), nMarkersOnThisRank, MPI_DOUBLE, rootRankLev, lev_comm[level]);
-
-	// Now unpack
-	int count = 0;
-	for (int ib = 0; ib < objman->iBody.size(); ib++) {
-		if (objman->iBody[ib].level == level) {
-			for (auto m : objman->iBody[ib].validMarkers) {
-				objman->iBody[ib].markers[m].epsilon = recvBuffer[count];
-				count++;
-			}
-		}
-	}
-
 	// Update owning rank's epsilon values
 	std::vector<std::vector<double>> sendEpsBuffer(num_ranks, std::vector<double>(0));
 
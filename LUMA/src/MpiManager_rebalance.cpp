@@ -0,0 +1,375 @@
+/*
+* --------------------------------------------------------------
+*
+* ------ Lattice Boltzmann @ The University of Manchester ------
+*
+* -------------------------- L-U-M-A ---------------------------
+*
+* Copyright 2019 The University of Manchester
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.*
+*/
+
+#include "../inc/stdafx.h"
+#include "../inc/GridObj.h"
+#include "../inc/ObjectManager.h"
+
+#ifdef L_MPI_REBALANCE
+
+// *****************************************************************************
+///	\brief	Total time spent updating the grids of this rank.
+///
+///	\returns	time in seconds since the start of the simulation.
+double MpiManager::mpi_getRankTime()
+{
+	double time = 0.0;
+	for (int lev = 0; lev <= L_NUM_LEVELS; ++lev)
+	{
+		for (int reg = 0; reg < L_NUM_REGIONS; ++reg)
+		{
+			GridObj *g = nullptr;
+			GridUtils::getGrid(lev, reg, g);
+			if (g) time += g->timeav_timestep * g->t;
+		}
+	}
+	return time;
+}
+
+// *****************************************************************************
+///	\brief	Rebalance the decomposition if the step times have drifted apart.
+///
+///			Must be called by all ranks between time steps. The step times of
+///			the ranks since the last check are compared and, if the imbalance
+///			exceeds L_MPI_REBALANCE_THRESHOLD, the cost map measured on the 
+///			current grids and bodies is scaled so that the cost of each rank 
+///			block matches its measured time. A new smart decomposition is 
+///			computed from this map and, if it is predicted to be better, the 
+///			grids are rebuilt, the site data migrated and the halo exchange and
+///			IBM markers updated for the new ranks.
+///
+///	\param[in,out]	Grids	pointer to the grid hierarchy (replaced if rebalanced).
+///	\returns		true if the domain was rebalanced.
+bool MpiManager::mpi_rebalance(GridObj *&Grids)
+{
+	const int F = eCostNumFeatures;
+	double dh = L_COARSE_SITE_WIDTH;
+	GridManager *gm = GridManager::getInstance();
+	ObjectManager *objMan = ObjectManager::getInstance();
+
+	// Step time of each rank since the last check
+	double time = mpi_getRankTime();
+	double interval = time - rebalance_time;
+	rebalance_time = time;
+	std::vector<double> allTimes(num_ranks);
+	MPI_Allgather(&interval, 1, MPI_DOUBLE, allTimes.data(), 1, MPI_DOUBLE, world_comm);
+
+	double timeMax = *std::max_element(allTimes.begin(), allTimes.end());
+	double timeMin = *std::min_element(allTimes.begin(), allTimes.end());
+	if (num_ranks == 1 || timeMax <= 0.0) return false;
+	double imbalance = (timeMax - timeMin) * 100.0 / timeMax;
+	L_INFO("Measured imbalance of step times since last check is " + std::to_string(imbalance) + "%.", GridUtils::logfile);
+	if (imbalance < L_MPI_REBALANCE_THRESHOLD) return false;
+
+	// BFL bodies store their links against local sites so cannot be migrated
+	int hasBFL = objMan->pBody.size() ? 1 : 0;
+	MPI_Allreduce(MPI_IN_PLACE, &hasBFL, 1, MPI_INT, MPI_MAX, world_comm);
+	if (hasBFL)
+	{
+		L_WARN("Rebalancing is not supported with BFL bodies. Keeping current decomposition.", GridUtils::logfile);
+		return false;
+	}
+
+	// Gather the features of each rank on the master
+	std::vector<double> allRankFeatures(my_rank == 0 ? F * num_ranks : 0);
+	MPI_Gather(rank_features.data(), F, MPI_DOUBLE, allRankFeatures.data(), F, MPI_DOUBLE, 0, world_comm);
+
+	if (my_rank == 0)
+	{
+#ifdef L_MPI_COST_CALIBRATE
+		if (costModel.fitWeights(allRankFeatures, allTimes))
+		{
+			std::string msg("Calibrated cost weights =");
+			for (int n = 0; n < F; ++n) msg += " " + std::to_string(costModel.weights[n]);
+			L_INFO(msg, GridUtils::logfile);
+		}
+#endif
+
+		/* Scale the features of each rank block so that its cost is the 
+		 * measured time. This captures any work the features do not describe
+		 * (e.g. a flexible body sweeping through the block). */
+		for (int r = 0; r < num_ranks; ++r)
+		{
+			double cost = costModel.getCost(&allRankFeatures[r * F]);
+			if (cost <= 0.0) continue;
+			double scale = allTimes[r] / cost;
+
+			int box[6] = { 0, 1, 0, 1, 0, 1 };
+			for (int d = 0; d < L_DIMS; ++d)
+			{
+				box[2 * d] = static_cast<int>(std::round(rank_core_edge[2 * d][r] / dh));
+				box[2 * d + 1] = static_cast<int>(std::round(rank_core_edge[2 * d + 1][r] / dh));
+			}
+			for (int i = box[eXMin]; i < box[eXMax]; ++i)
+			{
+				for (int j = box[eYMin]; j < box[eYMax]; ++j)
+				{
+					for (int k = box[eZMin]; k < box[eZMax]; ++k)
+					{
+						for (int n = 0; n < F; ++n)
+							costModel.features[(k + L_K * (j + L_M * static_cast<size_t>(i))) * F + n] *= scale;
+					}
+				}
+			}
+		}
+		costModel.updateCosts();
+	}
+
+	// Decompose on the scaled map
+	std::vector<int> oldSizeX(cRankSizeX), oldSizeY(cRankSizeY), oldSizeZ(cRankSizeZ);
+	L_INFO("Recomputing decomposition from measured step times...", GridUtils::logfile);
+	double predicted = mpi_smartDecompose(dh).loadImbalance;
+	MPI_Bcast(&predicted, 1, MPI_DOUBLE, 0, world_comm);
+
+	// Keep the current decomposition unless the new one is different and better
+	bool bChanged = (cRankSizeX != oldSizeX || cRankSizeY != oldSizeY || cRankSizeZ != oldSizeZ);
+	bool bRebuild = (bChanged && predicted < imbalance);
+	GridObj *newGrids = nullptr;
+	if (bRebuild)
+	{
+		newGrids = mpi_rebuildGrids(Grids);
+		if (!newGrids)
+		{
+			L_WARN("New decomposition would move a grid carrying IBM bodies. Keeping current decomposition.", GridUtils::logfile);
+		}
+	}
+	else if (!bChanged)
+	{
+		L_INFO("New decomposition is the same as the current one.", GridUtils::logfile);
+	}
+	else
+	{
+		L_INFO("New decomposition does not improve on the measured imbalance. Keeping current decomposition.", GridUtils::logfile);
+	}
+
+	// Restore the current decomposition if not rebuilt
+	if (!newGrids)
+	{
+		cRankSizeX = oldSizeX;
+		cRankSizeY = oldSizeY;
+		cRankSizeZ = oldSizeZ;
+		if (bRebuild) mpi_setLocalGrid(gm);
+		return false;
+	}
+
+	// Move the bodies onto the new grids and replace the hierarchy
+	for (IBBody &body : objMan->iBody)
+		GridUtils::getGrid(newGrids, body._Owner->level, body._Owner->region_number, body._Owner);
+	objMan->_Grids = newGrids;
+	gm->setGridHierarchy(newGrids);
+	delete Grids;
+	Grids = newGrids;
+
+	// Rebuild the communicators and markers for the new hierarchy
+	mpi_updateHierarchy();
+
+	// Start timing the next interval from here
+	rebalance_time = mpi_getRankTime();
+
+	L_INFO("Domain rebalanced at time step " + std::to_string(Grids->t) + 
+		". Predicted imbalance is " + std::to_string(predicted) + "%.", GridUtils::logfile);
+	return true;
+}
+
+// *****************************************************************************
+///	\brief	Build the grids of the new decomposition and migrate the site data.
+///
+///			Must be called by all ranks with the new decomposition in the rank
+///			size arrays. The core sites of the current grids are packed, the
+///			local grid set up for the new decomposition and a new hierarchy 
+///			built. Each site is then sent to every rank whose core or halo 
+///			contains it so the new grids, halos included, are an exact copy of
+///			the current state. Bodies are only constructed on ranks which have
+///			their grid so the hierarchy is discarded if any rank would gain or
+///			lose a grid carrying IBM bodies. The current hierarchy is left 
+///			untouched in either case.
+///
+///	\param	oldGrids	pointer to the current grid hierarchy.
+///	\returns			pointer to the new hierarchy or nullptr if discarded.
+GridObj* MpiManager::mpi_rebuildGrids(GridObj *oldGrids)
+{
+	GridManager *gm = GridManager::getInstance();
+	ObjectManager *objMan = ObjectManager::getInstance();
+
+	/* Values passed per site: level, region, position, type, bounce-back 
+	 * body, density, velocity, populations and time-averaged quantities if 
+	 * computed. */
+	const int nProducts = 3 * L_DIMS - 3;
+	int nValues = 8 + L_DIMS + L_NUM_VELS;
+#ifndef L_USE_AA_STREAMING
+	nValues += L_NUM_VELS;
+#endif
+#ifdef L_COMPUTE_TIME_AVERAGED_QUANTITIES
+	nValues += 1 + L_DIMS + nProducts;
+#endif
+
+	// Pack the core sites of the current grids
+	std::vector<double> sites;
+	for (int lev = 0; lev <= L_NUM_LEVELS; ++lev)
+	{
+		for (int reg = 0; reg < L_NUM_REGIONS; ++reg)
+		{
+			GridObj *g = nullptr;
+			GridUtils::getGrid(oldGrids, lev, reg, g);
+			if (!g) continue;
+
+			for (int i = 0; i < g->N_lim; ++i)
+			{
+				for (int j = 0; j < g->M_lim; ++j)
+				{
+					for (int k = 0; k < g->K_lim; ++k)
+					{
+						if (GridUtils::isOnRecvLayer(g->XPos[i], g->YPos[j], g->ZPos[k])) continue;
+						int id = k + j * g->K_lim + i * g->K_lim * g->M_lim;
+
+						sites.push_back(lev);
+						sites.push_back(reg);
+						sites.push_back(g->XPos[i]);
+						sites.push_back(g->YPos[j]);
+						sites.push_back(g->ZPos[k]);
+						sites.push_back(static_cast<double>(g->LatTyp(i, j, k, g->M_lim, g->K_lim)));
+						sites.push_back(g->solidBody.empty() ? -1.0 : static_cast<double>(g->solidBody[id]));
+						sites.push_back(g->rho(i, j, k, g->M_lim, g->K_lim));
+						for (int d = 0; d < L_DIMS; ++d)
+							sites.push_back(g->u(i, j, k, d, g->M_lim, g->K_lim, L_DIMS));
+						for (int v = 0; v < L_NUM_VELS; ++v)
+							sites.push_back(g->f[g->fIdx(v, id)]);
+#ifndef L_USE_AA_STREAMING
+						for (int v = 0; v < L_NUM_VELS; ++v)
+							sites.push_back(g->fNew[g->fIdx(v, id)]);
+#endif
+#ifdef L_COMPUTE_TIME_AVERAGED_QUANTITIES
+						sites.push_back(g->rho_timeav(i, j, k, g->M_lim, g->K_lim));
+						for (int d = 0; d < L_DIMS; ++d)
+							sites.push_back(g->ui_timeav(i, j, k, d, g->M_lim, g->K_lim, L_DIMS));
+						for (int p = 0; p < nProducts; ++p)
+							sites.push_back(g->uiuj_timeav(i, j, k, p, g->M_lim, g->K_lim, nProducts));
+#endif
+					}
+				}
+			}
+		}
+	}
+
+	// Set up the local grid and build the new hierarchy
+	mpi_setLocalGrid(gm);
+	GridObj *newGrids = new GridObj(0);
+	if (L_NUM_LEVELS != 0)
+	{
+		for (int reg = 0; reg < L_NUM_REGIONS; ++reg)
+			newGrids->LBM_addSubGrid(reg);
+	}
+
+	// Check the grids carrying IBM bodies stay on the same ranks
+	int bMoved = 0;
+	for (int lev = 1; lev <= L_NUM_LEVELS; ++lev)
+	{
+		int hasBodies = objMan->hasIBMBodies[lev] ? 1 : 0;
+		MPI_Allreduce(MPI_IN_PLACE, &hasBodies, 1, MPI_INT, MPI_MAX, world_comm);
+		if (!hasBodies) continue;
+
+		for (int reg = 0; reg < L_NUM_REGIONS; ++reg)
+		{
+			GridObj *gOld = nullptr, *gNew = nullptr;
+			GridUtils::getGrid(oldGrids, lev, reg, gOld);
+			GridUtils::getGrid(newGrids, lev, reg, gNew);
+			if ((gOld == nullptr) != (gNew == nullptr)) bMoved = 1;
+		}
+	}
+	MPI_Allreduce(MPI_IN_PLACE, &bMoved, 1, MPI_INT, MPI_MAX, world_comm);
+	if (bMoved)
+	{
+		delete newGrids;
+		return nullptr;
+	}
+
+	// Copy each site to every rank whose core or halo contains it
+	std::vector<double> recvBuffer;
+	mpi_passSitesToRanks(sites, nValues, recvBuffer);
+
+	// Get the new grids
+	int gridCount = (L_NUM_LEVELS + 1) * L_NUM_REGIONS;
+	std::vector<GridObj*> grids(gridCount, nullptr);
+	for (int lev = 0; lev <= L_NUM_LEVELS; ++lev)
+	{
+		for (int reg = 0; reg < L_NUM_REGIONS; ++reg)
+			GridUtils::getGrid(newGrids, lev, reg, grids[lev + reg * (L_NUM_LEVELS + 1)]);
+	}
+
+	// Unpack the sites onto the new grids
+	std::vector<int> ijk;
+	for (size_t s = 0; s < recvBuffer.size(); s += nValues)
+	{
+		const double *site = &recvBuffer[s];
+		GridObj *g = grids[static_cast<int>(site[0]) + static_cast<int>(site[1]) * (L_NUM_LEVELS + 1)];
+		if (!g || !GridUtils::isOnThisRank(site[2], site[3], site[4], nullptr, g, &ijk)) continue;
+		int i = ijk[eXDirection];
+		int j = ijk[eYDirection];
+		int k = ijk[eZDirection];
+		int id = k + j * g->K_lim + i * g->K_lim * g->M_lim;
+
+		site += 5;
+		g->LatTyp(i, j, k, g->M_lim, g->K_lim) = static_cast<eType>(static_cast<int>(*site++));
+		int body = static_cast<int>(*site++);
+		if (body >= 0)
+		{
+			if (g->solidBody.empty()) g->solidBody.assign(g->N_lim * g->M_lim * g->K_lim, -1);
+			g->solidBody[id] = body;
+		}
+		g->rho(i, j, k, g->M_lim, g->K_lim) = *site++;
+		for (int d = 0; d < L_DIMS; ++d)
+			g->u(i, j, k, d, g->M_lim, g->K_lim, L_DIMS) = *site++;
+		for (int v = 0; v < L_NUM_VELS; ++v)
+			g->f[g->fIdx(v, id)] = *site++;
+#ifndef L_USE_AA_STREAMING
+		for (int v = 0; v < L_NUM_VELS; ++v)
+			g->fNew[g->fIdx(v, id)] = *site++;
+#endif
+#ifdef L_COMPUTE_TIME_AVERAGED_QUANTITIES
+		g->rho_timeav(i, j, k, g->M_lim, g->K_lim) = *site++;
+		for (int d = 0; d < L_DIMS; ++d)
+			g->ui_timeav(i, j, k, d, g->M_lim, g->K_lim, L_DIMS) = *site++;
+		for (int p = 0; p < nProducts; ++p)
+			g->uiuj_timeav(i, j, k, p, g->M_lim, g->K_lim, nProducts) = *site++;
+#endif
+	}
+
+	// Carry over the time and timings of each grid
+	for (int n = 0; n < gridCount; ++n)
+	{
+		GridObj *g = grids[n];
+		if (!g) continue;
+
+		GridObj *gOld = nullptr;
+		GridUtils::getGrid(oldGrids, g->level, g->region_number, gOld);
+		g->t = oldGrids->t * static_cast<int>(std::pow(2, g->level));
+		if (gOld)
+		{
+			g->timeav_timestep = gOld->timeav_timestep;
+			g->timeav_mpi_overhead = gOld->timeav_mpi_overhead;
+		}
+	}
+
+	return newGrids;
+}
+
+#endif
@@ -0,0 +1,104 @@
+/*
+* --------------------------------------------------------------
+*
+* ------ Lattice Boltzmann @ The University of Manchester ------
+*
+* -------------------------- L-U-M-A ---------------------------
+*
+* Copyright 2019 The University of Manchester
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.*
+*/
+#include "../inc/stdafx.h"
+#include "../inc/MpiManager.h"
+#include "../inc/GridObj.h"
+
+#if (defined L_BUILD_FOR_MPI && defined L_MPI_BENCHMARK)
+
+// ****************************************************************************
+/// \brief	Benchmark of the halo exchange.
+///
+///			Times L_MPI_BENCHMARK halo exchanges (pack, transfer and unpack) 
+///			of the coarse grid for each transport compiled in and reports the
+///			time per exchange of the slowest rank together with the number of
+///			messages and the volume passed across the topology. All ranks must
+///			call this method. The grid state is restored afterwards.
+void MpiManager::mpi_benchmarkExchange()
+{
+	GridObj *g = GridManager::getInstance()->Grids;
+
+	// Save state (the reverse exchange of in-place streaming writes to the core)
+	PopVector fSaved = g->f;
+	IVector<double> uSaved = g->u;
+	IVector<double> rhoSaved = g->rho;
+
+	// Messages and volume of a forward exchange
+	BufferSizeStruct *bufs = mpi_findBufferInfo(buffer_send_info, g);
+	long long counts[2] = { 0, 0 };
+	for (int dir = 0; dir < L_MPI_DIRS; dir++)
+	{
+		if (bufs->size[dir] == 0) continue;
+		counts[0]++;
+		counts[1] += static_cast<long long>(bufs->size[dir]) * mpi_getSitePayload(dir) * sizeof(double);
+	}
+	MPI_Allreduce(MPI_IN_PLACE, counts, 2, MPI_LONG_LONG, MPI_SUM, world_comm);
+
+	L_INFO("Halo exchange benchmark on " + std::to_string(num_ranks) + " rank(s) (" + 
+		std::to_string(counts[0]) + " messages, " + std::to_string(counts[1] / 1024.0) + " KiB, " +
+		std::to_string(L_MPI_BENCHMARK) + " exchanges):", GridUtils::logfile);
+
+	// Transports available in this build
+	std::vector<std::string> transports;
+#ifdef L_MPI_PERSISTENT
+	transports.push_back("Persistent point-to-point");
+#else
+	transports.push_back("Point-to-point");
+#endif
+#ifdef L_MPI_NEIGHBOUR_COLLECTIVES
+	transports.push_back("Neighbourhood collective");
+#endif
+
+	for (size_t tr = 0; tr < transports.size(); tr++)
+	{
+#ifdef L_MPI_NEIGHBOUR_COLLECTIVES
+		bNeighbourCollectives = (tr == 1);
+#endif
+
+		// Warm up so set-up costs are not timed
+		mpi_communicateStart(g->level, g->region_number);
+		mpi_communicateComplete(g);
+		MPI_Barrier(world_comm);
+
+		double t_start = MPI_Wtime();
+		for (int n = 0; n < L_MPI_BENCHMARK; n++)
+		{
+			mpi_communicateStart(g->level, g->region_number);
+			mpi_communicateComplete(g);
+		}
+		double secs = MPI_Wtime() - t_start;
+		MPI_Allreduce(MPI_IN_PLACE, &secs, 1, MPI_DOUBLE, MPI_MAX, world_comm);
+
+		L_INFO(transports[tr] + " = " + std::to_string(secs * 1.0e6 / L_MPI_BENCHMARK) + " us/exchange, " +
+			std::to_string(counts[1] * L_MPI_BENCHMARK / (secs * 1024.0 * 1024.0)) + " MiB/s", GridUtils::logfile);
+	}
+
+	// Restore state
+#ifdef L_MPI_NEIGHBOUR_COLLECTIVES
+	bNeighbourCollectives = true;
+#endif
+	g->f.swap(fSaved);
+	g->u.swap(uSaved);
+	g->rho.swap(rhoSaved);
+}
+
+#endif
@@ -0,0 +1,130 @@
+/*
+* --------------------------------------------------------------
+*
+* ------ Lattice Boltzmann @ The University of Manchester ------
+*
+* -------------------------- L-U-M-A ---------------------------
+*
+* Copyright 2019 The University of Manchester
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.*
+*/
+
+#include "../inc/stdafx.h"
+#include "../inc/GridObj.h"
+
+#ifdef L_USE_AA_STREAMING
+
+// ****************************************************************************
+/// \brief	Side of the recv layers on which a position lies along one axis.
+///
+/// \param	pos		position along the axis.
+/// \param	minEdge	edge enumeration for the minimum side of the axis.
+/// \param	maxEdge	edge enumeration for the maximum side of the axis.
+/// \return	+1 if on the maximum recv layer, -1 if on the minimum recv layer,
+///			0 otherwise.
+static int _recvSide(double pos, eCartMinMax minEdge, eCartMinMax maxEdge)
+{
+	if (GridUtils::isOnRecvLayer(pos, maxEdge)) return 1;
+	if (GridUtils::isOnRecvLayer(pos, minEdge)) return -1;
+	return 0;
+}
+
+// ****************************************************************************
+/// \brief	Method to pack the communication buffer for a reverse exchange.
+///
+///			With in-place streaming, every other time step the populations are
+///			streamed by writing them into the slots of the destination site. 
+///			Populations streamed out of the core of the rank are therefore left
+///			in the recv layer and must be returned to the rank which owns these 
+///			sites. This method packs the recv layer on the side given by the 
+///			direction so it can be sent back to the neighbour in that direction.
+///
+/// \param	dir	communication direction.
+/// \param	g	grid from which information is being sent during the communication.
+void MpiManager::mpi_buffer_packReverse(int dir, GridObj* const g) {
+
+#ifdef L_MPI_VERBOSE
+	*logout << "Packing reverse direction " << dir << std::endl;
+#endif
+
+	// Recv layer on the side given by the direction
+	const std::vector<int> &sites = mpi_findBufferInfo(buffer_recv_info, g)->sites[mpi_getOpposite(dir)];
+
+	// Gather from the grid
+#ifdef L_ENABLE_OPENMP
+#pragma omp parallel for
+#endif
+	for (int s = 0; s < static_cast<int>(sites.size()); s++) {
+		for (int v = 0; v < L_NUM_VELS; v++)
+			f_buffer_send[dir][v + s * L_NUM_VELS] = g->f[g->fIdx(v, sites[s])];
+	}
+}
+
+// ****************************************************************************
+/// \brief	Method to unpack the communication buffer for a reverse exchange.
+///
+///			Unpacks the recv layer of a neighbour onto the sender layer of this
+///			grid. Only those populations which were streamed from a site owned 
+///			by the neighbour are taken from the buffer, the rest were written 
+///			by this rank or another neighbour.
+///
+/// \param	dir	communication direction.
+/// \param	g	grid doing the communication.
+void MpiManager::mpi_buffer_unpackReverse(int dir, GridObj* const g) {
+
+	int M_lim = static_cast<int>(g->M_lim), K_lim = static_cast<int>(g->K_lim);
+
+	// Sites are on the sender layer facing the neighbour
+	int opp_dir = mpi_getOpposite(dir);
+	const std::vector<int> &sites = mpi_findBufferInfo(buffer_send_info, g)->sites[opp_dir];
+
+#ifdef L_MPI_VERBOSE
+	*logout << "Unpacking reverse direction " << dir << std::endl;
+#endif
+
+	for (int s = 0; s < static_cast<int>(sites.size()); s++) {
+
+		// Solid sites hold no populations but are still in the buffer
+		int id = sites[s];
+		if (g->LatTyp[id] == eSolid) continue;
+
+		int i = id / (K_lim * M_lim);
+		int j = (id / K_lim) % M_lim;
+		int k = id % K_lim;
+
+		for (int v = 0; v < L_NUM_VELS; v++) {
+
+			// Source of the population
+			int src_x = i - c_opt[v][eXDirection];
+			int src_y = j - c_opt[v][eYDirection];
+			int src_z = k - c_opt[v][eZDirection];
+
+			/* Only take those streamed from a site owned by the neighbour. Those
+			 * from a solid site are bounced back locally instead. */
+			if (!GridUtils::isOffGrid(src_x, src_y, src_z, g) &&
+				g->LatTyp(src_x, src_y, src_z, M_lim, K_lim) != eSolid &&
+				_recvSide(g->XPos[src_x], eXMin, eXMax) == neighbour_vectors[eXDirection][opp_dir] &&
+				_recvSide(g->YPos[src_y], eYMin, eYMax) == neighbour_vectors[eYDirection][opp_dir]
+#if (L_DIMS == 3)
+				&& _recvSide(g->ZPos[src_z], eZMin, eZMax) == neighbour_vectors[eZDirection][opp_dir]
+#endif
+				)
+			{
+				g->f[g->fIdx(v, id)] = f_buffer_recv[dir][v + s * L_NUM_VELS];
+			}
+		}
+	}
+}
+
+#endif
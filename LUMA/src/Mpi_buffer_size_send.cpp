@@ -19,707 +19,97 @@
 * See the License for the specific language governing permissions and
 * limitations under the License.*
 */
-
 #include "../inc/stdafx.h"
 #include "../inc/GridObj.h"
 
 
 // ****************************************************************************
-/// \brief	Method to pre-compute the size of the sender layer buffer.
+/// \brief	Method to find the sites of a sender or receiver layer.
 ///
 ///			A halo consists of a receiver (outer) and sender (inner) layer. 
-///			This method computes the size of the sender layers in each 
-///			communication direction (MPI directions).
+///			The sender layer in a given MPI direction is the part of the inner
+///			layer facing the neighbour in that direction which is not on the
+///			receiver layer in any other direction. The receiver layer for a 
+///			direction is the part of the outer layer on the opposite side 
+///			which receives the message sent in that direction. Refined sites 
+///			are never passed. Sites are stored in ascending order of their 
+///			flattened ijk index so that the layers on either side of a 
+///			boundary are traversed in the same order.
 ///
-/// \param	g	grid being inspected.
-void MpiManager::mpi_buffer_size_send(GridObj* const g) {
-	
-	int count, i, j, k, dir;	// Local counters
-	// Local grid sizes
-	int N_lim = static_cast<int>(g->N_lim), M_lim = static_cast<int>(g->M_lim)
-#if (L_DIMS == 3)
-		, K_lim = static_cast<int>(g->K_lim);
-#else
-		, K_lim = 1;
-#endif
-
-	/* Loop over the allowable directions:
-	* 0		=	Right
-	* 1		=	Left
-	* 2		=	Right-Up
-	* 3		=	Left-Down
-	* 4		=	Up
-	* 5		=	Down
-	* 6		=	Left-Up
-	* 7		=	Right-Down
-	* -------- 3D --------
-	* 8		=	Back
-	* 9		=	Front
-	* 10	=	Right-Back
-	* 11	=	Left-Front
-	* 12	=	Right-Up-Back
-	* 13	=	Left-Down-Front
-	* 14	=	Up-Back
-	* 15	=	Down-Front
-	* 16	=	Left-Up-Back
-	* 17	=	Right-Down-Front
-	* 18	=	Left-Back
-	* 19	=	Right-Front
-	* 20	=	Left-Down-Back
-	* 21	=	Right-Up-Front
-	* 22	=	Down-Back
-	* 23	=	Up-Front
-	* 24	=	Right-Down-Back
-	* 25	=	Left-Up-Front
-	*/
-	for (dir = 0; dir < L_MPI_DIRS; dir++)  {
-
-		// Reset the site counter
-		count = 0;
-
-		// Switch based on direction
-		switch (dir)
-		{
-
-		case 0:
-			// Right
-
-			// Examine possible inner and outer buffer locations
-			for (range_i_right) {
-				for (j = 0; j < M_lim; j++) {
-					for (k = 0; k < K_lim; k++) {
-
-						// Check conditions for sender
-						if (g->LatTyp(i,j,k,M_lim,K_lim) != eRefined)	// Do not pass refined sites as zero anyway
-						{
-							if (  GridUtils::isOnSenderLayer(g->XPos[i],eXMax) && 
-								(!GridUtils::isOnRecvLayer(g->YPos[j],eYMax) && !GridUtils::isOnRecvLayer(g->YPos[j],eYMin))
-#if (L_DIMS == 3)
-								&&
-								(!GridUtils::isOnRecvLayer(g->ZPos[k],eZMax) && !GridUtils::isOnRecvLayer(g->ZPos[k],eZMin))
-#endif
-							) {
-
-								// Must be a site to pass in MPI so increment counter
-								count++;
-							}
-						}
-
-					}
-				}
-			}
-			break;
-
-		case 1:
-			// Left
-			for (range_i_left) {
-				for (j = 0; j < M_lim; j++) {
-					for (k = 0; k < K_lim; k++) {
-
-						// Check conditions for sender
-						if (g->LatTyp(i,j,k,M_lim,K_lim) != eRefined)	// Do not pass refined sites as zero anyway
-						{
-							if (  GridUtils::isOnSenderLayer(g->XPos[i],eXMin) && 
-								(!GridUtils::isOnRecvLayer(g->YPos[j],eYMax) && !GridUtils::isOnRecvLayer(g->YPos[j],eYMin))
-#if (L_DIMS == 3)
-								&&
-								(!GridUtils::isOnRecvLayer(g->ZPos[k],eZMax) && !GridUtils::isOnRecvLayer(g->ZPos[k],eZMin))
-#endif
-							) {
-								// Must be a site to pass in MPI so increment counter
-								count++;
-							}
-						}
-
-					}
-				}
-			}
-			break;
-
-		case 2:
-			// Right-Up
-			for (range_i_right) {
-				for (range_j_up) {
-					for (k = 0; k < K_lim; k++) {
-
-						// Check conditions for sender
-						if (g->LatTyp(i,j,k,M_lim,K_lim) != eRefined)	// Do not pass refined sites as zero anyway
-						{
-							if (  GridUtils::isOnSenderLayer(g->XPos[i],eXMax) && 
-								GridUtils::isOnSenderLayer(g->YPos[j],eYMax)
-#if (L_DIMS == 3)
-								&&
-								(!GridUtils::isOnRecvLayer(g->ZPos[k],eZMax) && !GridUtils::isOnRecvLayer(g->ZPos[k],eZMin))
-#endif
-							) {
-								// Must be a site to pass in MPI so increment counter
-								count++;
-							}
-						}
-
-					}
-				}
-			}
-			break;
-
-		case 3:
-			// Left-Down
-			for (range_i_left) {
-				for (range_j_down) {
-					for (k = 0; k < K_lim; k++) {
-
-						// Check conditions for sender
-						if (g->LatTyp(i,j,k,M_lim,K_lim) != eRefined)	// Do not pass refined sites as zero anyway
-						{
-							if (  GridUtils::isOnSenderLayer(g->XPos[i],eXMin) && 
-								GridUtils::isOnSenderLayer(g->YPos[j],eYMin)
-#if (L_DIMS == 3)
-								&&
-								(!GridUtils::isOnRecvLayer(g->ZPos[k],eZMax) && !GridUtils::isOnRecvLayer(g->ZPos[k],eZMin))
-#endif
-							) {
-								// Must be a site to pass in MPI so increment counter
-								count++;
-							}
-						}
-
-					}
-				}
-			}
-			break;
+/// \param	g		grid being inspected.
+/// \param	dir		MPI direction.
+/// \param	bSender	true to find the sender layer, false for the receiver layer.
+/// \param	sites	vector to be filled with the flattened ijk indices of the sites.
+void MpiManager::mpi_buffer_findSites(GridObj* const g, int dir, bool bSender, std::vector<int> &sites) {
 
-		case 4:
-			// Up
-			for (i = 0; i < N_lim; i++) {
-				for (range_j_up) {
-					for (k = 0; k < K_lim; k++) {
-
-						// Check conditions for sender
-						if (g->LatTyp(i,j,k,M_lim,K_lim) != eRefined)	// Do not pass refined sites as zero anyway
-						{
-							if (  (!GridUtils::isOnRecvLayer(g->XPos[i],eXMin) && !GridUtils::isOnRecvLayer(g->XPos[i],eXMax)) &&
-								GridUtils::isOnSenderLayer(g->YPos[j],eYMax)
-#if (L_DIMS == 3)
-								&&
-								(!GridUtils::isOnRecvLayer(g->ZPos[k],eZMax) && !GridUtils::isOnRecvLayer(g->ZPos[k],eZMin))
-#endif
-							) {
-								// Must be a site to pass in MPI so increment counter
-								count++;
-							}
-						}
-
-					}
-				}
-			}
-			break;
-
-
-		case 5:
-			// Down
-			for (i = 0; i < N_lim; i++) {
-				for (range_j_down) {
-					for (k = 0; k < K_lim; k++) {
-
-						// Check conditions for sender
-						if (g->LatTyp(i,j,k,M_lim,K_lim) != eRefined)	// Do not pass refined sites as zero anyway
-						{
-							if (  (!GridUtils::isOnRecvLayer(g->XPos[i],eXMin) && !GridUtils::isOnRecvLayer(g->XPos[i],eXMax)) &&
-								GridUtils::isOnSenderLayer(g->YPos[j],eYMin)
-#if (L_DIMS == 3)
-								&&
-								(!GridUtils::isOnRecvLayer(g->ZPos[k],eZMax) && !GridUtils::isOnRecvLayer(g->ZPos[k],eZMin))
-#endif
-							) {
-								// Must be a site to pass in MPI so increment counter
-								count++;
-							}
-						}
-
-					}
-				}
-			}
-			break;
-
-		case 6:
-			// Left-Up
-			for (range_i_left) {
-				for (range_j_up) {
-					for (k = 0; k < K_lim; k++) {
-
-						// Check conditions for sender
-						if (g->LatTyp(i,j,k,M_lim,K_lim) != eRefined)	// Do not pass refined sites as zero anyway
-						{
-							if (  GridUtils::isOnSenderLayer(g->XPos[i],eXMin) && 
-								GridUtils::isOnSenderLayer(g->YPos[j],eYMax)
-#if (L_DIMS == 3)
-								&&
-								(!GridUtils::isOnRecvLayer(g->ZPos[k],eZMax) && !GridUtils::isOnRecvLayer(g->ZPos[k],eZMin))
-#endif
-							) {
-								// Must be a site to pass in MPI so increment counter
-								count++;
-							}
-						}
-
-					}
-				}
-			}
-			break;
-
-		case 7:
-			// Right-Down
-			for (range_i_right) {
-				for (range_j_down) {
-					for (k = 0; k < K_lim; k++) {
-
-						// Check conditions for sender
-						if (g->LatTyp(i,j,k,M_lim,K_lim) != eRefined)	// Do not pass refined sites as zero anyway
-						{
-							if (  GridUtils::isOnSenderLayer(g->XPos[i],eXMax) && 
-								GridUtils::isOnSenderLayer(g->YPos[j],eYMin)
+	// Local grid sizes
+	int lims[3] = { static_cast<int>(g->N_lim), static_cast<int>(g->M_lim), 1 };
 #if (L_DIMS == 3)
-								&&
-								(!GridUtils::isOnRecvLayer(g->ZPos[k],eZMax) && !GridUtils::isOnRecvLayer(g->ZPos[k],eZMin))
+	lims[eZDirection] = static_cast<int>(g->K_lim);
 #endif
-							) {
-								// Must be a site to pass in MPI so increment counter
-								count++;
-							}
-						}
-
-					}
-				}
-			}
-			break;
-
-
-		///////////////////////
-		// 3D-specific cases //
-		///////////////////////
-
-		case 8:
-			// Back
-			for (i = 0; i < N_lim; i++) {
-				for (j = 0; j < M_lim; j++) {
-					for (range_k_back) {
-
-						// Check conditions for sender
-						if (g->LatTyp(i,j,k,M_lim,K_lim) != eRefined)	// Do not pass refined sites as zero anyway
-						{
-							if ( (!GridUtils::isOnRecvLayer(g->XPos[i],eXMin) && !GridUtils::isOnRecvLayer(g->XPos[i],eXMax)) && 
-									(!GridUtils::isOnRecvLayer(g->YPos[j],eYMin) && !GridUtils::isOnRecvLayer(g->YPos[j],eYMax)) &&
-									(GridUtils::isOnSenderLayer(g->ZPos[k],eZMax))
-							) {
-								// Must be a site to pass in MPI so increment counter
-								count++;
-							}
-						}
-
-					}
-				}
-			}
-			break;
-
-		case 9:
-			// Front
-			for (i = 0; i < N_lim; i++) {
-				for (j = 0; j < M_lim; j++) {
-					for (range_k_front) {
-
-						// Check conditions for sender
-						if (g->LatTyp(i,j,k,M_lim,K_lim) != eRefined)	// Do not pass refined sites as zero anyway
-						{
-							if ( (!GridUtils::isOnRecvLayer(g->XPos[i],eXMin) && !GridUtils::isOnRecvLayer(g->XPos[i],eXMax)) && 
-									(!GridUtils::isOnRecvLayer(g->YPos[j],eYMin) && !GridUtils::isOnRecvLayer(g->YPos[j],eYMax)) &&
-									(GridUtils::isOnSenderLayer(g->ZPos[k],eZMin))
-							) {
-								// Must be a site to pass in MPI so increment counter
-								count++;
-							}
-						}
-
-					}
-				}
-			}
-			break;
-
-		case 10:
-			// Right-Back
-			for (range_i_right) {
-				for (j = 0; j < M_lim; j++) {
-					for (range_k_back) {
 
-						// Check conditions for sender
-						if (g->LatTyp(i,j,k,M_lim,K_lim) != eRefined)	// Do not pass refined sites as zero anyway
-						{
-							if ( (GridUtils::isOnSenderLayer(g->XPos[i],eXMax)) && 
-									(!GridUtils::isOnRecvLayer(g->YPos[j],eYMin) && !GridUtils::isOnRecvLayer(g->YPos[j],eYMax)) &&
-									(GridUtils::isOnSenderLayer(g->ZPos[k],eZMax))
-							) {
-								// Must be a site to pass in MPI so increment counter
-								count++;
-							}
-						}
-
-					}
-				}
-			}
-			break;
-
-		case 11:
-			// Left-Front
-			for (range_i_left) {
-				for (j = 0; j < M_lim; j++) {
-					for (range_k_front) {
-
-						// Check conditions for sender
-						if (g->LatTyp(i,j,k,M_lim,K_lim) != eRefined)	// Do not pass refined sites as zero anyway
-						{
-							if ( (GridUtils::isOnSenderLayer(g->XPos[i],eXMin)) && 
-									(!GridUtils::isOnRecvLayer(g->YPos[j],eYMin) && !GridUtils::isOnRecvLayer(g->YPos[j],eYMax)) &&
-									(GridUtils::isOnSenderLayer(g->ZPos[k],eZMin))
-							) {
-								// Must be a site to pass in MPI so increment counter
-								count++;
-							}
-						}
-
-					}
-				}
-			}
-			break;
-
-		case 12:
-			// Right-Up-Back
-			for (range_i_right) {
-				for (range_j_up) {
-					for (range_k_back) {
-
-						// Check conditions for sender
-						if (g->LatTyp(i,j,k,M_lim,K_lim) != eRefined)	// Do not pass refined sites as zero anyway
-						{
-							if ( (GridUtils::isOnSenderLayer(g->XPos[i],eXMax)) && 
-									(GridUtils::isOnSenderLayer(g->YPos[j],eYMax)) &&
-									(GridUtils::isOnSenderLayer(g->ZPos[k],eZMax))
-							) {
-								// Must be a site to pass in MPI so increment counter
-								count++;
-							}
-						}
-
-					}
-				}
-			}
-			break;
-
-		case 13:
-			// Left-Down-Front
-			for (range_i_left) {
-				for (range_j_down) {
-					for (range_k_front) {
-
-						// Check conditions for sender
-						if (g->LatTyp(i,j,k,M_lim,K_lim) != eRefined)	// Do not pass refined sites as zero anyway
-						{
-							if ( (GridUtils::isOnSenderLayer(g->XPos[i],eXMin)) && 
-									(GridUtils::isOnSenderLayer(g->YPos[j],eYMin)) &&
-									(GridUtils::isOnSenderLayer(g->ZPos[k],eZMin))
-							) {
-								// Must be a site to pass in MPI so increment counter
-								count++;
-							}
-						}
-
-					}
-				}
-			}
-			break;
-
-		case 14:
-			// Up-Back
-			for (i = 0; i < N_lim; i++) {
-				for (range_j_up) {
-					for (range_k_back) {
-
-						// Check conditions for sender
-						if (g->LatTyp(i,j,k,M_lim,K_lim) != eRefined)	// Do not pass refined sites as zero anyway
-						{
-							if ( (!GridUtils::isOnRecvLayer(g->XPos[i],eXMin) && !GridUtils::isOnRecvLayer(g->XPos[i],eXMax)) && 
-									(GridUtils::isOnSenderLayer(g->YPos[j],eYMax)) &&
-									(GridUtils::isOnSenderLayer(g->ZPos[k],eZMax))
-							) {
-								// Must be a site to pass in MPI so increment counter
-								count++;
-							}
-						}
-
-					}
-				}
-			}
-			break;
-
-		case 15:
-			// Down-Front
-			for (i = 0; i < N_lim; i++) {
-				for (range_j_down) {
-					for (range_k_front) {
-
-						// Check conditions for sender
-						if (g->LatTyp(i,j,k,M_lim,K_lim) != eRefined)	// Do not pass refined sites as zero anyway
-						{
-							if ( (!GridUtils::isOnRecvLayer(g->XPos[i],eXMin) && !GridUtils::isOnRecvLayer(g->XPos[i],eXMax)) && 
-									(GridUtils::isOnSenderLayer(g->YPos[j],eYMin)) &&
-									(GridUtils::isOnSenderLayer(g->ZPos[k],eZMin))
-							) {
-								// Must be a site to pass in MPI so increment counter
-								count++;
-							}
-						}
-
-					}
-				}
-			}
-			break;
-
-		case 16:
-			// Left-Up-Back
-			for (range_i_left) {
-				for (range_j_up) {
-					for (range_k_back) {
-
-						// Check conditions for sender
-						if (g->LatTyp(i,j,k,M_lim,K_lim) != eRefined)	// Do not pass refined sites as zero anyway
-						{
-							if ( (GridUtils::isOnSenderLayer(g->XPos[i],eXMin)) && 
-									(GridUtils::isOnSenderLayer(g->YPos[j],eYMax)) &&
-									(GridUtils::isOnSenderLayer(g->ZPos[k],eZMax))
-							) {
-								// Must be a site to pass in MPI so increment counter
-								count++;
-							}
-						}
-
-					}
-				}
-			}
-			break;
-
-		case 17:
-			// Right-Down-Front
-			for (range_i_right) {
-				for (range_j_down) {
-					for (range_k_front) {
-
-						// Check conditions for sender
-						if (g->LatTyp(i,j,k,M_lim,K_lim) != eRefined)	// Do not pass refined sites as zero anyway
-						{
-							if ( (GridUtils::isOnSenderLayer(g->XPos[i],eXMax)) && 
-									(GridUtils::isOnSenderLayer(g->YPos[j],eYMin)) &&
-									(GridUtils::isOnSenderLayer(g->ZPos[k],eZMin))
-							) {
-								// Must be a site to pass in MPI so increment counter
-								count++;
-							}
-						}
-
-					}
-				}
-			}
-			break;
-
-		case 18:
-			// Left-Back
-			for (range_i_left) {
-				for (j = 0; j < M_lim; j++) {
-					for (range_k_back) {
-
-						// Check conditions for sender
-						if (g->LatTyp(i,j,k,M_lim,K_lim) != eRefined)	// Do not pass refined sites as zero anyway
-						{
-							if ( (GridUtils::isOnSenderLayer(g->XPos[i],eXMin)) && 
-									(!GridUtils::isOnRecvLayer(g->YPos[j],eYMin) && !GridUtils::isOnRecvLayer(g->YPos[j],eYMax)) &&
-									(GridUtils::isOnSenderLayer(g->ZPos[k],eZMax))
-							) {
-								// Must be a site to pass in MPI so increment counter
-								count++;
-							}
-						}
-
-					}
-				}
-			}
-			break;
-
-		case 19:
-			// Right-Front
-			for (range_i_right) {
-				for (j = 0; j < M_lim; j++) {
-					for (range_k_front) {
-
-						// Check conditions for sender
-						if (g->LatTyp(i,j,k,M_lim,K_lim) != eRefined)	// Do not pass refined sites as zero anyway
-						{
-							if ( (GridUtils::isOnSenderLayer(g->XPos[i],eXMax)) && 
-									(!GridUtils::isOnRecvLayer(g->YPos[j],eYMin) && !GridUtils::isOnRecvLayer(g->YPos[j],eYMax)) &&
-									(GridUtils::isOnSenderLayer(g->ZPos[k],eZMin))
-							) {
-								// Must be a site to pass in MPI so increment counter
-								count++;
-							}
-						}
-
-					}
-				}
-			}
-			break;
-
-		case 20:
-			// Left-Down-Back
-			for (range_i_left) {
-				for (range_j_down) {
-					for (range_k_back) {
-
-						// Check conditions for sender
-						if (g->LatTyp(i,j,k,M_lim,K_lim) != eRefined)	// Do not pass refined sites as zero anyway
-						{
-							if ( (GridUtils::isOnSenderLayer(g->XPos[i],eXMin)) && 
-									(GridUtils::isOnSenderLayer(g->YPos[j],eYMin)) &&
-									(GridUtils::isOnSenderLayer(g->ZPos[k],eZMax))
-							) {
-								// Must be a site to pass in MPI so increment counter
-								count++;
-							}
-						}
-
-					}
-				}
-			}
-			break;
-
-		case 21:
-			// Right-Up-Front
-			for (range_i_right) {
-				for (range_j_up) {
-					for (range_k_front) {
-
-						// Check conditions for sender
-						if (g->LatTyp(i,j,k,M_lim,K_lim) != eRefined)	// Do not pass refined sites as zero anyway
-						{
-							if ( (GridUtils::isOnSenderLayer(g->XPos[i],eXMax)) && 
-									(GridUtils::isOnSenderLayer(g->YPos[j],eYMax)) &&
-									(GridUtils::isOnSenderLayer(g->ZPos[k],eZMin))
-							) {
-								// Must be a site to pass in MPI so increment counter
-								count++;
-							}
-						}
-
-					}
-				}
-			}
-			break;
-
-		case 22:
-			// Down-Back
-			for (i = 0; i < N_lim; i++) {
-				for (range_j_down) {
-					for (range_k_back) {
-
-						// Check conditions for sender
-						if (g->LatTyp(i,j,k,M_lim,K_lim) != eRefined)	// Do not pass refined sites as zero anyway
-						{
-							if ( (!GridUtils::isOnRecvLayer(g->XPos[i],eXMin) && !GridUtils::isOnRecvLayer(g->XPos[i],eXMax)) && 
-									(GridUtils::isOnSenderLayer(g->YPos[j],eYMin)) &&
-									(GridUtils::isOnSenderLayer(g->ZPos[k],eZMax))
-							) {
-								// Must be a site to pass in MPI so increment counter
-								count++;
-							}
-						}
+	/* Side of the grid on which the layer lies in each direction (the receiver 
+	 * layer is on the opposite side to the neighbour the message is sent to)
+	 * and the range of indices which can contain it. */
+	int side[3], lo[3], hi[3];
+	int width = static_cast<int>(pow(2, g->level + 1));
+	for (int d = 0; d < 3; ++d)
+	{
+		side[d] = (bSender ? neighbour_vectors[d][dir] : -neighbour_vectors[d][dir]);
+		lo[d] = (side[d] == 1 ? GridUtils::upToZero(lims[d] - width) : 0);
+		hi[d] = (side[d] == -1 ? GridUtils::downToLimit(width, lims[d]) : lims[d]);
+	}
 
-					}
-				}
-			}
-			break;
+	sites.clear();
+	for (int i = lo[eXDirection]; i < hi[eXDirection]; i++) {
+		for (int j = lo[eYDirection]; j < hi[eYDirection]; j++) {
+			for (int k = lo[eZDirection]; k < hi[eZDirection]; k++) {
 
-		case 23:
-			// Up-Front
-			for (i = 0; i < N_lim; i++) {
-				for (range_j_up) {
-					for (range_k_front) {
+				// Do not pass refined sites as zero anyway
+				int id = k + j * lims[eZDirection] + i * lims[eZDirection] * lims[eYDirection];
+				if (g->LatTyp[id] == eRefined) continue;
 
-						// Check conditions for sender
-						if (g->LatTyp(i,j,k,M_lim,K_lim) != eRefined)	// Do not pass refined sites as zero anyway
-						{
-							if ( (!GridUtils::isOnRecvLayer(g->XPos[i],eXMin) && !GridUtils::isOnRecvLayer(g->XPos[i],eXMax)) && 
-									(GridUtils::isOnSenderLayer(g->YPos[j],eYMax)) &&
-									(GridUtils::isOnSenderLayer(g->ZPos[k],eZMin))
-							) {
-								// Must be a site to pass in MPI so increment counter
-								count++;
-							}
-						}
+				// Check conditions for the layer in each direction
+				double pos[3] = { g->XPos[i], g->YPos[j], g->ZPos[k] };
+				bool bOnLayer = true;
+				for (int d = 0; d < L_DIMS && bOnLayer; ++d)
+				{
+					eCartMinMax minEdge = static_cast<eCartMinMax>(2 * d);
+					eCartMinMax maxEdge = static_cast<eCartMinMax>(2 * d + 1);
 
-					}
+					// Must not be on the receiver layer in directions without a neighbour
+					if (side[d] == 0)
+						bOnLayer = !GridUtils::isOnRecvLayer(pos[d], minEdge) && !GridUtils::isOnRecvLayer(pos[d], maxEdge);
+					else if (bSender)
+						bOnLayer = GridUtils::isOnSenderLayer(pos[d], (side[d] == 1 ? maxEdge : minEdge));
+					else
+						bOnLayer = GridUtils::isOnRecvLayer(pos[d], (side[d] == 1 ? maxEdge : minEdge));
 				}
-			}
-			break;
-
-		case 24:
-			// Right-Down-Back
-			for (range_i_right) {
-				for (range_j_down) {
-					for (range_k_back) {
 
-						// Check conditions for sender
-						if (g->LatTyp(i,j,k,M_lim,K_lim) != eRefined)	// Do not pass refined sites as zero anyway
-						{
-							if ( (GridUtils::isOnSenderLayer(g->XPos[i],eXMax)) && 
-									(GridUtils::isOnSenderLayer(g->YPos[j],eYMin)) &&
-									(GridUtils::isOnSenderLayer(g->ZPos[k],eZMax))
-							) {
-								// Must be a site to pass in MPI so increment counter
-								count++;
-							}
-						}
-
-					}
-				}
+				// Must be a site to pass in MPI so store it
+				if (bOnLayer) sites.push_back(id);
 			}
-			break;
-
-		case 25:
-			// Left-Up-Front
-			for (range_i_left) {
-				for (range_j_up) {
-					for (range_k_front) {
+		}
+	}
 
-						// Check conditions for sender
-						if (g->LatTyp(i,j,k,M_lim,K_lim) != eRefined)	// Do not pass refined sites as zero anyway
-						{
-							if ( (GridUtils::isOnSenderLayer(g->XPos[i],eXMin)) && 
-									(GridUtils::isOnSenderLayer(g->YPos[j],eYMax)) &&
-									(GridUtils::isOnSenderLayer(g->ZPos[k],eZMin))
-							) {
-								// Must be a site to pass in MPI so increment counter
-								count++;
-							}
-						}
+}
 
-					}
-				}
-			}
-			break;
+// ****************************************************************************
+/// \brief	Method to pre-compute the sender layer buffer information.
+///
+///			Finds the sites of the sender layers in each communication 
+///			direction (MPI directions) and stores them along with the size of 
+///			the layer so the buffers can be packed without searching the grid.
+///
+/// \param	g	grid being inspected.
+void MpiManager::mpi_buffer_size_send(GridObj* const g) {
+	
+	for (int dir = 0; dir < L_MPI_DIRS; dir++)  {
 
-		default:
-			std::cout << "Unidentified direction: " << dir << std::endl;
-			break;
-		}
-			
-		// Store the count of sites in the MpiManager buffer_info structure
-		buffer_send_info.back().size[dir] = count;				
+		// Store the sites and count in the MpiManager buffer_info structure
+		mpi_buffer_findSites(g, dir, true, buffer_send_info.back().sites[dir]);
+		buffer_send_info.back().size[dir] = static_cast<int>(buffer_send_info.back().sites[dir].size());
 
 	}
 
-}
\ No newline at end of file
+}
@@ -73,93 +73,92 @@ ObjectManager::ObjectManager(GridObj* g) : _Grids(g)
 	hasIBMBodies.resize(L_NUM_LEVELS+1 ,false);
 	hasFlexibleBodies.resize(L_NUM_LEVELS+1 ,false);
 
+	// One packed stencil table per level
+	ibmStencil.resize(L_NUM_LEVELS+1);
+
 	// Set sub-iteration loop values
 	timeav_subResidual = 0.0;
 	timeav_subIterations = 0.0;
 };
 
 // ************************************************************************* //
-/// \brief	Compute forces on a BB rigid object.
+/// \brief	Compute forces on BB rigid objects.
 ///
-///			Uses momentum exchange to compute forces on rigid bodies.
-///			Currently working with bounce-back objects only. There is no 
-///			bounding box so if we have walls in the domain they will be counted 
-///			as well.
+///			Uses momentum exchange to compute forces on the bounce-back bodies
+///			on the supplied grid. The links between fluid sites and the solid 
+///			sites of each body are precomputed with the stream tables so the 
+///			force on each body is a reduction over its own links. Walls and 
+///			other solid sites not belonging to a body are not included.
 ///
-/// \param	i	local i-index of solid site.
-/// \param	j	local j-index of solid site.
-/// \param	k	local k-index of solid site.
-/// \param	g	pointer to grid on which object resides.
-void ObjectManager::computeLiftDrag(int i, int j, int k, GridObj *g) {
-
-	// TODO: Need a bounding box for object if we have walls in the domain otherwise they will also be counted
-	// TODO: Also need to be able to identify which body this site relates to so we can differentiate
-
-	int N_lim = g->N_lim;
-	int M_lim = g->M_lim;
-	int K_lim = g->K_lim;
-
-	// For MPI builds, ignore if part of object is in halo region as represented on another rank
-#ifdef L_BUILD_FOR_MPI
-	if (!GridUtils::isOnRecvLayer(g->XPos[i], g->YPos[j], g->ZPos[k]))
-#endif
+/// \param	g	pointer to grid on which the objects reside.
+void ObjectManager::computeLiftDrag(GridObj *g)
+{
+	int nBodies = static_cast<int>(g->momexBodyStart.size()) - 1;
+	for (int b = 0; b < nBodies; ++b)
 	{
-
-#ifdef L_MOMEX_DEBUG
-		// Write position of solid site to debugging file
-		if (debugstream.is_open())
-			debugstream << std::endl << g->XPos[i] << "," << g->YPos[j] << "," << g->ZPos[k];
+		/* For HWBB:
+		 *
+		 *	Force =
+		 *		(pre-stream population toward wall +
+		 *		post-stream population away from wall)
+		 *
+		 * since population is simply bounced-back, we can write as:
+		 *
+		 *	Force =
+		 *		(2 * pre-stream population toward wall)
+		 *
+		 * Multiplication by c unit vector resolves the result in
+		 * appropriate direction.
+		 */
+		double forceX = 0.0, forceY = 0.0, forceZ = 0.0;
+		int start = g->momexBodyStart[b];
+		int end = g->momexBodyStart[b + 1];
+
+#ifdef L_ENABLE_OPENMP
+#pragma omp parallel for reduction(+:forceX,forceY,forceZ)
 #endif
-		// Loop over directions from solid site
-		for (int n = 0; n < L_NUM_VELS; n++)
+		for (int n = start; n < end; ++n)
 		{
-			// Declare some local stores for this site
-			double contrib_x = 0.0, contrib_y = 0.0, contrib_z = 0.0;
+			// Population at the fluid site pointing toward the wall
+			int v = g->momexLinkSrc[n] % L_NUM_VELS;
+			int id = g->momexLinkSrc[n] / L_NUM_VELS;
+#ifdef L_USE_AA_STREAMING
+			double f_v = g->_LBM_aaGetPopulation(
+				id / (g->K_lim * g->M_lim), (id / g->K_lim) % g->M_lim, id % g->K_lim, v);
+#else
+			double f_v = g->f[g->fIdx(v, id)];
+#endif
 
-			// Get incoming direction
-			int n_opp = GridUtils::getOpposite(n);
+			// Add the contribution of this link
+			forceX += 2.0 * c[eXDirection][v] * f_v;
+			forceY += 2.0 * c[eYDirection][v] * f_v;
+			forceZ += 2.0 * c[eZDirection][v] * f_v;
+		}
 
-			// Compute destination coordinates (does not assume any periodicity)
-			int xdest = i - c[eXDirection][n_opp];
-			int ydest = j - c[eYDirection][n_opp];
-			int zdest = k - c[eZDirection][n_opp];
+		bbbForce[3 * b + eXDirection] += forceX;
+		bbbForce[3 * b + eYDirection] += forceY;
+		bbbForce[3 * b + eZDirection] += forceZ;
 
-			// Objects on edges will not get a periodic contribution && only applies to fluid sites
-			if (!GridUtils::isOffGrid(xdest, ydest, zdest, g) &&
-				g->LatTyp(xdest, ydest, zdest, M_lim, K_lim) == eFluid)
+#ifdef L_MOMEX_DEBUG
+		// Write body, solid site position, direction and contribution of each link to debugging file
+		if (debugstream.is_open())
+		{
+			for (int n = start; n < end; ++n)
 			{
-				/* For HWBB:
-				 *
-				 *	Force =
-				 *		(pre-stream population toward wall +
-				 *		post-stream population away from wall)
-				 *
-				 * since population is simply bounced-back, we can write as:
-				 *
-				 *	Force =
-				 *		(2 * pre-stream population toward wall)
-				 *
-				 * Multiplication by c unit vector resolves the result in
-				 * appropriate direction.
-				 */
-
-				 // Store contribution in this direction
-				contrib_x = 2.0 * c[eXDirection][n_opp] * g->f(xdest, ydest, zdest, n_opp, M_lim, K_lim, L_NUM_VELS);
-				contrib_y = 2.0 * c[eYDirection][n_opp] * g->f(xdest, ydest, zdest, n_opp, M_lim, K_lim, L_NUM_VELS);
-				contrib_z = 2.0 * c[eZDirection][n_opp] * g->f(xdest, ydest, zdest, n_opp, M_lim, K_lim, L_NUM_VELS);
+				int v = g->momexLinkSrc[n] % L_NUM_VELS;
+				int id = g->momexLinkSrc[n] / L_NUM_VELS;
+				int i = id / (g->K_lim * g->M_lim) + c[eXDirection][v];
+				int j = (id / g->K_lim) % g->M_lim + c[eYDirection][v];
+				int k = id % g->K_lim + c[eZDirection][v];
+				double f_v = g->f[g->fIdx(v, id)];
+
+				debugstream << std::endl << b << "," << g->XPos[i] << "," << g->YPos[j] << "," << g->ZPos[k] << "," << v <<
+					"," << std::to_string(2.0 * c[eXDirection][v] * f_v) <<
+					"," << std::to_string(2.0 * c[eYDirection][v] * f_v) <<
+					"," << std::to_string(2.0 * c[eZDirection][v] * f_v);
 			}
-
-#ifdef L_MOMEX_DEBUG
-			// Write contribution to file for this site for this lattice link
-			if (debugstream.is_open())
-				debugstream << "," << std::to_string(contrib_x) << "," << std::to_string(contrib_y) << "," << std::to_string(contrib_z);
-#endif
-			// Add the contribution of this link to the body forces
-			bbbForceOnObjectX += contrib_x;
-			bbbForceOnObjectY += contrib_y;
-			bbbForceOnObjectZ += contrib_z;
-
 		}
+#endif
 	}
 }
 
@@ -167,25 +166,34 @@ void ObjectManager::computeLiftDrag(int i, int j, int k, GridObj *g) {
 /// \brief	Compute forces on a BFL rigid object.
 ///
 ///			Uses momentum exchange to compute forces on a marker than makes up
-///			a BFL body. Currently only works with a single BFL body but can 
-///			easily be upgraded.
+///			a BFL body.
 ///
 ///	\param	v			lattice direction of link being considered.
 ///	\param	id			collapsed ijk index for site on which BFL BC is being applied.
 /// \param	g			pointer to grid on which marker resides.
+/// \param	bodyID		index of BFL body in pBody.
 /// \param	markerID	id of marker on which force is to be updated.
-void ObjectManager::computeLiftDrag(int v, int id, GridObj *g, int markerID)
+void ObjectManager::computeLiftDrag(int v, int id, GridObj *g, int bodyID, int markerID)
 {
 	// Get opposite once
 	int v_opp = GridUtils::getOpposite(v);
 
 	// Similar to BBB but we cannot assume that bounced-back population is the same anymore
-	pBody[0].markers[markerID].forceX +=
-		c[eXDirection][v_opp] * (g->f[v_opp + id * L_NUM_VELS] + g->fNew[v + id * L_NUM_VELS]);
-	pBody[0].markers[markerID].forceY +=
-		c[eYDirection][v_opp] * (g->f[v_opp + id * L_NUM_VELS] + g->fNew[v + id * L_NUM_VELS]);
-	pBody[0].markers[markerID].forceZ +=
-		c[eZDirection][v_opp] * (g->f[v_opp + id * L_NUM_VELS] + g->fNew[v + id * L_NUM_VELS]);
+	double f_sum = g->f[g->fIdx(v_opp, id)] + g->fNew[g->fIdx(v, id)];
+
+	// Markers may be shared by sites updated by different threads
+#ifdef L_ENABLE_OPENMP
+#pragma omp atomic
+#endif
+	pBody[bodyID].markers[markerID].forceX += c[eXDirection][v_opp] * f_sum;
+#ifdef L_ENABLE_OPENMP
+#pragma omp atomic
+#endif
+	pBody[bodyID].markers[markerID].forceY += c[eYDirection][v_opp] * f_sum;
+#ifdef L_ENABLE_OPENMP
+#pragma omp atomic
+#endif
+	pBody[bodyID].markers[markerID].forceZ += c[eZDirection][v_opp] * f_sum;
 }
 
 // ************************************************************************* //
@@ -195,19 +203,24 @@ void ObjectManager::computeLiftDrag(int v, int id, GridObj *g, int markerID)
 ///	\param	grid	Grid object on which method was called
 void ObjectManager::resetMomexBodyForces(GridObj * grid)
 {
-	if (grid->level == bbbOnGridLevel && grid->region_number == bbbOnGridReg)
+	// Reset the BB body forces
+	for (size_t b = 0; b < bbbOnGridLevel.size(); ++b)
 	{
-		bbbForceOnObjectX = 0.0;
-		bbbForceOnObjectY = 0.0;
-		bbbForceOnObjectZ = 0.0;
+		// Only reset if body on this grid
+		if (bbbOnGridLevel[b] == grid->level && bbbOnGridReg[b] == grid->region_number)
+		{
+			bbbForce[3 * b + eXDirection] = 0.0;
+			bbbForce[3 * b + eYDirection] = 0.0;
+			bbbForce[3 * b + eZDirection] = 0.0;
+		}
+	}
 
 #ifdef L_MOMEX_DEBUG
-		// Open file for momentum exchange information
+	// Open file for momentum exchange information
+	if (!grid->solidBody.empty())
 		toggleDebugStream(grid);
 #endif
 
-	}
-
 	// Reset the BFL body marker forces
 	for (BFLBody& body : pBody)
 	{
@@ -231,17 +244,14 @@ void ObjectManager::resetMomexBodyForces(GridObj * grid)
 ///
 ///			Override of the usual method which tries to place the object on the 
 ///			finest grid it can rather than a given grid. This will allow objects
-///			to span multiple levels.
+///			to span multiple levels. Sites are not attributed to the body so no
+///			momentum exchange forces are computed on it.
 ///
 /// \param	geom	pointer to structure containing object information read from config file.
 /// \param	_PCpts	pointer to point cloud information.
 void ObjectManager::addBouncebackObject(GeomPacked *geom, PCpts *_PCpts)
 {
 
-	// Store information about the body in the Object Manager
-	bbbOnGridLevel = geom->onGridLev;
-	bbbOnGridReg = geom->onGridReg;
-
 	// Declarations
 	std::vector<int> ijk;
 	eLocationOnRank loc = eNone;
@@ -280,6 +290,7 @@ void ObjectManager::addBouncebackObject(GeomPacked *geom, PCpts *_PCpts)
 					{
 						// Change type
 						g->LatTyp(ijk[0], ijk[1], ijk[2], g->M_lim, g->K_lim) = eSolid;
+						g->LBM_invalidateStreamTables();
 
 						// Change macro
 						g->u(ijk[0], ijk[1], ijk[2], 0, g->M_lim, g->K_lim, L_DIMS) = 0.0;
@@ -308,9 +319,8 @@ void ObjectManager::addBouncebackObject(GeomPacked *geom, PCpts *_PCpts)
 /// \param	_PCpts	pointer to point cloud information.
 void ObjectManager::addBouncebackObject(GridObj *g, GeomPacked *geom, PCpts *_PCpts)
 {
-	// Store information about the body in the Object Manager
-	bbbOnGridLevel = geom->onGridLev;
-	bbbOnGridReg = geom->onGridReg;
+	// Index of the body (registered by the cloud reader)
+	int bodyID = static_cast<int>(bbbOnGridLevel.size()) - 1;
 
 	// Declarations
 	std::vector<int> ijk;
@@ -328,6 +338,11 @@ void ObjectManager::addBouncebackObject(GridObj *g, GeomPacked *geom, PCpts *_PC
 			{
 				// Change type
 				g->LatTyp(ijk[0], ijk[1], ijk[2], g->M_lim, g->K_lim) = eSolid;
+				g->LBM_invalidateStreamTables();
+
+				// Attribute site to this body for momentum exchange
+				if (g->solidBody.empty()) g->solidBody.assign(g->N_lim * g->M_lim * g->K_lim, -1);
+				g->solidBody[ijk[2] + ijk[1] * g->K_lim + ijk[0] * g->K_lim * g->M_lim] = bodyID;
 
 				// Change macro
 				g->u(ijk[0], ijk[1], ijk[2], 0, g->M_lim, g->K_lim, L_DIMS) = 0.0;
@@ -359,12 +374,7 @@ void ObjectManager::toggleDebugStream(GridObj *g)
 			"_Rnk" + std::to_string(GridUtils::safeGetRank()) + ".csv", std::ios::out);
 
 		// Add header for MomEx debug
-		debugstream << "X Position,Y Position,Z Position";
-
-		for (int v = 0; v < L_NUM_VELS; ++v)
-		{
-			debugstream << ",F" + std::to_string(v) + "X,F" + std::to_string(v) + "Y,F" + std::to_string(v) + "Z";
-		}
+		debugstream << "Body,X Position,Y Position,Z Position,Direction,FX,FY,FZ";
 	}
 	else
 	{
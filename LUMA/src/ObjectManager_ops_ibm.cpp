@@ -217,7 +217,7 @@ void ObjectManager::ibm_initialise() {
 #ifdef L_BUILD_FOR_MPI
 	int levToLoop = MpiManager::getInstance()->rankGrids[MpiManager::getInstance()->my_rank];
 #else
-	int levToLoop = L_NUM_LEVELS+1;
+	int levToLoop = L_NUM_LEVELS;
 #endif
 
 	// Build helper classes for MPI comms
@@ -494,84 +494,41 @@ void ObjectManager::ibm_initialiseSupport(int ib, int m, std::vector<double> &es
 // *****************************************************************************
 ///	\brief	Interpolate velocity field onto markers
 ///
+///			Each row of the packed stencil table is a marker so rows are 
+///			threaded directly.
+///
 ///	\param	level		current grid level
 void ObjectManager::ibm_interpolate(int level) {
 
-	// Get rank
-	int rank = GridUtils::safeGetRank();
-
-	// Loop through all bodies
-	for (size_t ib = 0; ib < iBody.size(); ib++) {
-
-		// Only interpolate the bodies that exist on this grid level
-		if (iBody[ib]._Owner->level == level) {
-
-			// Get grid sizes
-			size_t M_lim = iBody[ib]._Owner->M_lim;
-#if (L_DIMS == 3)
-			size_t K_lim = iBody[ib]._Owner->K_lim;
-#endif
-
-			// For each marker
-			for (auto m : iBody[ib].validMarkers) {
-
-				// Reset the values of interpolated velocity and density
-				std::fill(iBody[ib].markers[m].interpMom.begin(), iBody[ib].markers[m].interpMom.end(), 0.0);
-				iBody[ib].markers[m].interpRho = 0.0;
-
-				// Loop over support nodes
-				for (size_t i = 0; i < iBody[ib].markers[m].deltaval.size(); i++) {
-
-					// Only interpolate over data this rank actually owns at the moment
-					if (rank == iBody[ib].markers[m].support_rank[i]) {
+	// Get the stencil table for this level
+	IBStencil &st = ibmStencil[level];
 
-
-						// Interpolate density
-#if (L_DIMS == 2)
-						iBody[ib].markers[m].interpRho += iBody[ib]._Owner->rho(
-								iBody[ib].markers[m].supp_i[i],
-								iBody[ib].markers[m].supp_j[i], M_lim) *
-								iBody[ib].markers[m].deltaval[i] * iBody[ib].markers[m].local_area;
-#else
-						iBody[ib].markers[m].interpRho += iBody[ib]._Owner->rho(
-								iBody[ib].markers[m].supp_i[i],
-								iBody[ib].markers[m].supp_j[i],
-								iBody[ib].markers[m].supp_k[i],
-								M_lim, K_lim) *
-								iBody[ib].markers[m].deltaval[i] * iBody[ib].markers[m].local_area;
+	// Loop over rows (markers only write to their own data)
+#ifdef L_ENABLE_OPENMP
+#pragma omp parallel for
 #endif
+	for (int r = 0; r < static_cast<int>(st.rowBody.size()); r++) {
 
-						// Loop over directions x y z
-						for (int dir = 0; dir < L_DIMS; dir++) {
+		// Owning grid
+		GridObj *g = st.rowGrid[r];
 
-							// Read given velocity component from support node, multiply by delta function
-							// for that support node and sum to get interpolated velocity.
-#if (L_DIMS == 2)
+		// Reset the values of interpolated velocity and density
+		double interpRho = 0.0;
+		double interpMom[L_DIMS] = { 0.0 };
 
-							iBody[ib].markers[m].interpMom[dir] += iBody[ib]._Owner->rho(
-									iBody[ib].markers[m].supp_i[i],
-									iBody[ib].markers[m].supp_j[i], M_lim) *
-									iBody[ib]._Owner->u(
-									iBody[ib].markers[m].supp_i[i],
-									iBody[ib].markers[m].supp_j[i],
-									dir, M_lim, L_DIMS) * iBody[ib].markers[m].deltaval[i] * iBody[ib].markers[m].local_area;
-#else
-							iBody[ib].markers[m].interpMom[dir] += iBody[ib]._Owner->rho(
-									iBody[ib].markers[m].supp_i[i],
-									iBody[ib].markers[m].supp_j[i],
-									iBody[ib].markers[m].supp_k[i],
-									M_lim, K_lim) *
-									iBody[ib]._Owner->u(
-									iBody[ib].markers[m].supp_i[i],
-									iBody[ib].markers[m].supp_j[i],
-									iBody[ib].markers[m].supp_k[i],
-									dir, M_lim, K_lim, L_DIMS) * iBody[ib].markers[m].deltaval[i] * iBody[ib].markers[m].local_area;
-#endif
-						}
-					}
-				}
-			}
+		// Sum over the on-rank support sites
+		for (int e = st.rowStart[r]; e < st.rowStart[r + 1]; e++) {
+			int id = st.site[e];
+			interpRho += g->rho[id] * st.wInterp[e];
+			for (int dir = 0; dir < L_DIMS; dir++)
+				interpMom[dir] += g->rho[id] * g->u[id * L_DIMS + dir] * st.wInterp[e];
 		}
+
+		// Store on the marker
+		IBMarker &marker = iBody[st.rowBody[r]].markers[st.rowMarker[r]];
+		marker.interpRho = interpRho;
+		for (int dir = 0; dir < L_DIMS; dir++)
+			marker.interpMom[dir] = interpMom[dir];
 	}
 
 	// Pass the necessary values between ranks
@@ -602,7 +559,11 @@ void ObjectManager::ibm_computeForce(int level) {
 
 		// Only do if this body is on this grid level
 		if (iBody[ib]._Owner->level == level) {
-			for (auto m : iBody[ib].validMarkers) {
+#ifdef L_ENABLE_OPENMP
+#pragma omp parallel for
+#endif
+			for (int mm = 0; mm < static_cast<int>(iBody[ib].validMarkers.size()); mm++) {
+				int m = iBody[ib].validMarkers[mm];
 				for (int dir = 0; dir < L_DIMS; dir++) {
 
 					// Compute restorative force (in lattice units)
@@ -617,58 +578,40 @@ void ObjectManager::ibm_computeForce(int level) {
 // *****************************************************************************
 ///	\brief	Spread restorative force back onto marker support
 ///
+///			Uses the site-ordered entries of the stencil table so each site 
+///			is written by one thread. Contributions to a site are applied in 
+///			body then marker order as in the serial code.
+///
 ///	\param	level		current grid level
 void ObjectManager::ibm_spread(int level) {
 
-	// Get rank
-	int rank = GridUtils::safeGetRank();
-
-	// Loop through bodies
-	for (size_t ib = 0; ib < iBody.size(); ib++) {
-
-		// Only spread the bodies that exist on this grid level
-		if (iBody[ib]._Owner->level == level) {
-
-			// Get volume scaling
-			double volWidth, volDepth;
-
-			// Get grid sizes
-			size_t M_lim = iBody[ib]._Owner->M_lim;
-			size_t K_lim = iBody[ib]._Owner->K_lim;
-
-			// Loop through markers
-			for (auto m : iBody[ib].validMarkers) {
-
-				// Loop through support sites
-				for (size_t s = 0; s < iBody[ib].markers[m].deltaval.size(); s++) {
+	// Get the stencil table for this level
+	IBStencil &st = ibmStencil[level];
 
-					// Only spread over data this rank actually owns at the moment
-					if (rank == iBody[ib].markers[m].support_rank[s]) {
+	// Pack the marker forces
+	int nRows = static_cast<int>(st.rowBody.size());
+#ifdef L_ENABLE_OPENMP
+#pragma omp parallel for
+#endif
+	for (int r = 0; r < nRows; r++) {
+		IBMarker &marker = iBody[st.rowBody[r]].markers[st.rowMarker[r]];
+		for (int dir = 0; dir < L_DIMS; dir++)
+			st.rowForce[r * L_DIMS + dir] = marker.force_xyz[dir];
+	}
 
-						// Set volume scaling
-						volWidth = iBody[ib].markers[m].epsilon;
-						volDepth = 1.0;
-#if (L_DIMS == 3)
-						volDepth = iBody[ib].markers[m].ds;
+	// Loop over support sites
+#ifdef L_ENABLE_OPENMP
+#pragma omp parallel for
 #endif
+	for (int n = 0; n < static_cast<int>(st.uniqueSite.size()); n++) {
 
-						// Loop over directions x y z
-						for (size_t dir = 0; dir < L_DIMS; dir++) {
-
-							// Add contribution of current marker force to support node Cartesian force vector using delta values computed when support was computed
-							iBody[ib]._Owner->force_xyz(
-									iBody[ib].markers[m].supp_i[s],
-									iBody[ib].markers[m].supp_j[s],
-									iBody[ib].markers[m].supp_k[s],
-									dir, M_lim, K_lim, L_DIMS) -=
-									iBody[ib].markers[m].deltaval[s] *
-									iBody[ib].markers[m].force_xyz[dir] *
-									volWidth * volDepth *
-									iBody[ib].markers[m].ds;
-						}
-					}
-				}
-			}
+		// Site force
+		double *force = &(st.siteGrid[n]->force_xyz[st.uniqueSite[n] * L_DIMS]);
+
+		// Add contribution of each marker force using the prefolded weights
+		for (int e = st.siteStart[n]; e < st.siteStart[n + 1]; e++) {
+			for (int dir = 0; dir < L_DIMS; dir++)
+				force[dir] -= st.wSpread[e] * st.rowForce[st.siteRow[e] * L_DIMS + dir];
 		}
 	}
 
@@ -695,47 +638,30 @@ void ObjectManager::ibm_spread(int level) {
 ///	\param	level		current grid level
 void ObjectManager::ibm_updateMacroscopic(int level) {
 
-	// Get rank
-	int rank = GridUtils::safeGetRank();
+	// Get the stencil table for this level
+	IBStencil &st = ibmStencil[level];
 
-	// Grid indices and type
-	int idx, jdx, kdx, id;
-	eType type_local;
-
-	// First do all support points that belong to markers that this rank owns
-	// Loop through all IBM bodies
-	for (size_t ib = 0; ib < iBody.size(); ib++) {
-
-		// Only do if body belongs to this grid level
-		if (iBody[ib]._Owner->level == level) {
-
-			// Loop through all markers
-			for (auto m : iBody[ib].validMarkers) {
-				for (size_t s = 0; s < iBody[ib].markers[m].deltaval.size(); s++) {
-
-					// Only do if this rank actually owns this support site
-					if (iBody[ib].markers[m].support_rank[s] == rank) {
-
-						// Get indices
-						idx = iBody[ib].markers[m].supp_i[s];
-						jdx = iBody[ib].markers[m].supp_j[s];
-						kdx = iBody[ib].markers[m].supp_k[s];
+	// First do all support sites of markers that this rank owns (each site is listed once)
+#ifdef L_ENABLE_OPENMP
+#pragma omp parallel for
+#endif
+	for (int n = 0; n < static_cast<int>(st.uniqueSite.size()); n++) {
 
-						// Grid site index and type
-						id = kdx + jdx * iBody[ib]._Owner->K_lim + idx * iBody[ib]._Owner->K_lim * iBody[ib]._Owner->M_lim;
-						type_local = iBody[ib]._Owner->LatTyp[id];
+		// Get indices
+		GridObj *g = st.siteGrid[n];
+		int id = st.uniqueSite[n];
+		int kdx = id % g->K_lim;
+		int jdx = (id / g->K_lim) % g->M_lim;
+		int idx = id / (g->K_lim * g->M_lim);
 
-						// Update macroscopic value at this site
-						iBody[ib]._Owner->_LBM_macro_opt(idx, jdx, kdx, id, type_local);
-					}
-				}
-			}
-		}
+		// Update macroscopic value at this site
+		g->_LBM_macro_opt(idx, jdx, kdx, id, g->LatTyp[id]);
 	}
 
 	// Now loop through any support sites this rank owns which belong to markers off-rank
 #ifdef L_BUILD_FOR_MPI
-	int ib;
+	int ib, idx, jdx, kdx, id;
+	eType type_local;
 
 	// Get MPI manager instance
 	MpiManager *mpim = MpiManager::getInstance();
@@ -767,21 +693,49 @@ void ObjectManager::ibm_updateMacroscopic(int level) {
 
 
 // *****************************************************************************
-///	\brief	Compute epsilon for a given iBody
+///	\brief	Compute epsilon for the iBodies on a level
 ///
 ///	\param	level		current grid level
 void ObjectManager::ibm_findEpsilon(int level) {
 
+	/* The Reproducing Kernel Particle Method (see Pinelli et al. 2010, JCP) requires suitable weighting
+	to be computed to ensure conservation while using the interpolation functions. Epsilon is this weighting.
+	Markers only interact when their supports overlap so the system is assembled in sparse form and solved 
+	iteratively, starting from the current epsilon values. */
+
+	// Sparse coefficient matrix and the marker rows and columns
+	std::vector<int> rowPtr, colIdx;
+	std::vector<double> val;
+	std::vector<IBMarker*> rows;
+	std::vector<double> cols;
+	int it;
+	double res;
+
 #ifdef L_UNIVERSAL_EPSILON_CALC
 
-	// Temorary iBody for storing all markers in whole simulation
-	std::vector<IBBody> iBodyTmp(1);
+	// Each rank assembles the rows of its valid markers against the markers of the whole level
+	std::vector<int> rowCounts;
+	ibm_universalEpsilonGather(level, rows, cols, rowCounts);
+	ibm_buildEpsilonMatrix(rows, cols, _Grids->dh / pow(2.0, level), rowPtr, colIdx, val);
+
+	// Solve the system across the ranks of the level
+	std::vector<double> bVector(rows.size(), 1.0);
+	std::vector<double> epsilon(rows.size());
+	for (size_t m = 0; m < rows.size(); m++) epsilon[m] = rows[m]->epsilon;
+#ifdef L_BUILD_FOR_MPI
+	res = GridUtils::solveSparseSystem(rowPtr, colIdx, val, bVector, epsilon, it, rowCounts, MpiManager::getInstance()->lev_comm[level]);
+#else
+	res = GridUtils::solveSparseSystem(rowPtr, colIdx, val, bVector, epsilon, it);
+#endif
+	if (res > L_EPSILON_TOL)
+		L_WARN("Epsilon solver on level " + std::to_string(level) + " stopped after " + std::to_string(it) + 
+		" iterations with a residual of " + std::to_string(res), GridUtils::logfile);
 
-	// Gather all the markers into the temporary iBody vector
-	ibm_universalEpsilonGather(level, iBodyTmp[0]);
+	// Assign epsilon
+	for (size_t m = 0; m < rows.size(); m++) rows[m]->epsilon = epsilon[m];
 
-	// Set the pointer values to avoid copying memory
-	std::vector<IBBody> *iBodyPtr = &iBodyTmp;
+	// Update the owning ranks
+	ibm_universalEpsilonScatter(level);
 
 #else
 
@@ -794,10 +748,6 @@ void ObjectManager::ibm_findEpsilon(int level) {
 		mpim->mpi_epsilonCommGather(level);
 	#endif
 
-		// Set the pointer values to avoid copying memory
-		std::vector<IBBody> *iBodyPtr = &iBody;
-#endif
-
 	// Get rank
 	int rank = GridUtils::safeGetRank();
 
@@ -806,95 +756,55 @@ void ObjectManager::ibm_findEpsilon(int level) {
 #endif
 
 	// Loop through all iBodys this rank owns
-	for (size_t ib = 0; ib < (*iBodyPtr).size(); ib++) {
-		if ((*iBodyPtr)[ib].owningRank == rank && (*iBodyPtr)[ib].level == level && (*iBodyPtr)[ib].markers.size() > 0) {
-
-			/* The Reproducing Kernel Particle Method (see Pinelli et al. 2010, JCP) requires suitable weighting
-			to be computed to ensure conservation while using the interpolation functions. Epsilon is this weighting.
-			We can use built-in libraries to solve the ensuing linear system in future. */
-
-			// Declarations
-			double Delta_I, Delta_J;
-
-			//////////////////////////////////
-			//	Build coefficient matrix A	//
-			//		with a_ij values.		//
-			//////////////////////////////////
-
-			// Initialise 2D std vector with zeros
-			std::vector< std::vector<double> > A((*iBodyPtr)[ib].markers.size(), std::vector<double>((*iBodyPtr)[ib].markers.size(), 0.0));
+	for (size_t ib = 0; ib < iBody.size(); ib++) {
+		if (iBody[ib].owningRank == rank && iBody[ib].level == level && iBody[ib].markers.size() > 0) {
+
+			// Rows and columns are all the markers of the body
+			rows.clear();
+			cols.clear();
+			for (IBMarker &marker : iBody[ib].markers) {
+				rows.push_back(&marker);
+				for (int d = 0; d < L_DIMS; d++) cols.push_back(marker.position[d]);
+				cols.push_back(marker.dilation);
+				cols.push_back(marker.ds);
+			}
 
 #ifdef L_IBM_DEBUG
-			L_INFO("Building coefficient matrix for IBBody ID: " + std::to_string(iBodyPtr->at(ib).id), GridUtils::logfile);
+			L_INFO("Building coefficient matrix for IBBody ID: " + std::to_string(iBody[ib].id), GridUtils::logfile);
 #endif
-
-			// Loop over support of marker I and integrate delta value multiplied by delta value of marker J.
-			for (size_t I = 0; I < (*iBodyPtr)[ib].markers.size(); I++) {
-
-				// Loop over markers J
-				for (size_t J = 0; J < (*iBodyPtr)[ib].markers.size(); J++) {
-
-					// Sum delta values evaluated for each support of I
-					for (size_t s = 0; s < (*iBodyPtr)[ib].markers[I].deltaval.size(); s++) {
-
-						Delta_I = (*iBodyPtr)[ib].markers[I].deltaval[s];
-#if (L_DIMS == 3)
-						Delta_J =
-							ibm_deltaKernel(
-							((*iBodyPtr)[ib].markers[J].position[eXDirection] - (*iBodyPtr)[ib].markers[I].supp_x[s]) / (*iBodyPtr)[ib].dh,
-							(*iBodyPtr)[ib].markers[J].dilation
-							) *
-							ibm_deltaKernel(
-							((*iBodyPtr)[ib].markers[J].position[eYDirection] - (*iBodyPtr)[ib].markers[I].supp_y[s]) / (*iBodyPtr)[ib].dh,
-							(*iBodyPtr)[ib].markers[J].dilation
-							) *
-							ibm_deltaKernel(
-							((*iBodyPtr)[ib].markers[J].position[eZDirection] - (*iBodyPtr)[ib].markers[I].supp_z[s]) / (*iBodyPtr)[ib].dh,
-							(*iBodyPtr)[ib].markers[J].dilation
-							);
-#else
-						Delta_J =
-							ibm_deltaKernel(
-							((*iBodyPtr)[ib].markers[J].position[eXDirection] - (*iBodyPtr)[ib].markers[I].supp_x[s]) / (*iBodyPtr)[ib].dh,
-							(*iBodyPtr)[ib].markers[J].dilation
-							) *
-							ibm_deltaKernel(
-							((*iBodyPtr)[ib].markers[J].position[eYDirection] - (*iBodyPtr)[ib].markers[I].supp_y[s]) / (*iBodyPtr)[ib].dh,
-							(*iBodyPtr)[ib].markers[J].dilation
-							);
-#endif
-						// Multiply by local area (or volume in 3D)
-						A[I][J] += Delta_I * Delta_J * (*iBodyPtr)[ib].markers[I].local_area;
-					}
-
-					// Multiply by arc length between markers in lattice units
-					A[I][J] = A[I][J] * (*iBodyPtr)[ib].markers[J].ds;
-				}
-			}
+			ibm_buildEpsilonMatrix(rows, cols, iBody[ib].dh, rowPtr, colIdx, val);
 
 			// Create vectors
-			std::vector<double> bVector((*iBodyPtr)[ib].markers.size(), 1.0);
+			std::vector<double> bVector(rows.size(), 1.0);
+			std::vector<double> epsilon(rows.size());
+			for (size_t m = 0; m < rows.size(); m++) epsilon[m] = rows[m]->epsilon;
 
 			//////////////////
 			// Solve system //
 			//////////////////
 
 #ifdef L_IBM_DEBUG
-			L_INFO("Solving linear system for IBBody ID: " + std::to_string(iBodyPtr->at(ib).id)
-				+ ", A size = " + std::to_string(A.at(0).size()) + " x " + std::to_string(A.size())
-				+ ", b size = " + std::to_string(bVector.size()), GridUtils::logfile);
+			L_INFO("Solving linear system for IBBody ID: " + std::to_string(iBody[ib].id)
+				+ ", A size = " + std::to_string(rows.size()) + " x " + std::to_string(rows.size())
+				+ ", " + std::to_string(val.size()) + " non-zeros", GridUtils::logfile);
 #endif
 
 			// Solve linear system
-			std::vector<double> epsilon = GridUtils::solveLinearSystem(A, bVector);
+#ifdef L_BUILD_FOR_MPI
+			std::vector<int> rowCounts(1, static_cast<int>(rows.size()));
+			res = GridUtils::solveSparseSystem(rowPtr, colIdx, val, bVector, epsilon, it, rowCounts, MPI_COMM_SELF);
+#else
+			res = GridUtils::solveSparseSystem(rowPtr, colIdx, val, bVector, epsilon, it);
+#endif
+			if (res > L_EPSILON_TOL)
+				L_WARN("Epsilon solver for IBBody ID " + std::to_string(iBody[ib].id) + " stopped after " + std::to_string(it) + 
+				" iterations with a residual of " + std::to_string(res), GridUtils::logfile);
 
 			// Assign epsilon
 #ifdef L_IBM_DEBUG
-			L_INFO("Updating epsilon for IBBody ID: " + std::to_string(iBodyPtr->at(ib).id), GridUtils::logfile);
+			L_INFO("Updating epsilon for IBBody ID: " + std::to_string(iBody[ib].id), GridUtils::logfile);
 #endif
-			for (size_t m = 0; m < (*iBodyPtr)[ib].markers.size(); m++) {
-				(*iBodyPtr)[ib].markers[m].epsilon = epsilon[m];
-			}
+			for (size_t m = 0; m < rows.size(); m++) rows[m]->epsilon = epsilon[m];
 		}
 	}
 
@@ -902,12 +812,6 @@ void ObjectManager::ibm_findEpsilon(int level) {
 	MPI_Barrier(MpiManager::getInstance()->world_comm);
 #endif
 
-#ifdef L_UNIVERSAL_EPSILON_CALC
-
-	// Redistribute epsilon
-	ibm_universalEpsilonScatter(level, iBodyTmp[0]);
-
-#else
 	#ifdef L_BUILD_FOR_MPI
 
 #ifdef L_IBM_DEBUG
@@ -917,6 +821,102 @@ void ObjectManager::ibm_findEpsilon(int level) {
 		mpim->mpi_epsilonCommScatter(level);
 	#endif
 #endif
+
+	// Epsilon is final so pack the stencils
+	ibm_buildStencils(level);
+}
+
+
+// *****************************************************************************
+///	\brief	Pack the support stencils of a level into a flat table
+///
+///			Builds a row for each valid marker of the bodies on this level 
+///			with an entry for each support site this rank owns. The weights 
+///			are prefolded and the entries are then transposed into site order 
+///			for spreading. The stable sort keeps the body and marker order at 
+///			each site so the summation order is unchanged. Must be called 
+///			whenever the support, ds or epsilon change.
+///
+///	\param	level		current grid level
+void ObjectManager::ibm_buildStencils(int level) {
+
+	// Get rank
+	int rank = GridUtils::safeGetRank();
+
+	// Reset table but keep its storage
+	IBStencil &st = ibmStencil[level];
+	st.rowBody.clear();
+	st.rowMarker.clear();
+	st.rowGrid.clear();
+	st.rowStart.assign(1, 0);
+	st.site.clear();
+	st.wInterp.clear();
+	st.uniqueSite.clear();
+	st.siteGrid.clear();
+	st.siteStart.clear();
+	st.siteRow.clear();
+	st.wSpread.clear();
+
+	// Row and spreading weight of each entry in marker order
+	std::vector<int> entryRow;
+	std::vector<double> entryWeight;
+
+	// Loop through bodies on this level
+	for (size_t ib = 0; ib < iBody.size(); ib++) {
+		if (iBody[ib]._Owner->level != level) continue;
+
+		GridObj *g = iBody[ib]._Owner;
+		for (auto m : iBody[ib].validMarkers) {
+			IBMarker &marker = iBody[ib].markers[m];
+
+			// Volume scaling
+			double volDepth = 1.0;
+#if (L_DIMS == 3)
+			volDepth = marker.ds;
+#endif
+
+			// Add row
+			int r = static_cast<int>(st.rowBody.size());
+			st.rowBody.push_back(static_cast<int>(ib));
+			st.rowMarker.push_back(m);
+			st.rowGrid.push_back(g);
+
+			// Add entries for support sites this rank owns
+			for (size_t s = 0; s < marker.deltaval.size(); s++) {
+				if (marker.support_rank[s] == rank) {
+					st.site.push_back(marker.supp_k[s] + marker.supp_j[s] * g->K_lim + marker.supp_i[s] * g->K_lim * g->M_lim);
+					st.wInterp.push_back(marker.deltaval[s] * marker.local_area);
+					entryRow.push_back(r);
+					entryWeight.push_back(marker.deltaval[s] * marker.epsilon * volDepth * marker.ds);
+				}
+			}
+			st.rowStart.push_back(static_cast<int>(st.site.size()));
+		}
+	}
+	st.rowForce.resize(st.rowBody.size() * L_DIMS);
+
+	// Sort entries by grid then site
+	std::vector<int> order(st.site.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+		int regA = st.rowGrid[entryRow[a]]->region_number;
+		int regB = st.rowGrid[entryRow[b]]->region_number;
+		return (regA != regB) ? (regA < regB) : (st.site[a] < st.site[b]);
+	});
+
+	// Transpose into site order
+	for (size_t n = 0; n < order.size(); n++) {
+		int e = order[n];
+		GridObj *g = st.rowGrid[entryRow[e]];
+		if (st.uniqueSite.empty() || st.uniqueSite.back() != st.site[e] || st.siteGrid.back() != g) {
+			st.uniqueSite.push_back(st.site[e]);
+			st.siteGrid.push_back(g);
+			st.siteStart.push_back(static_cast<int>(n));
+		}
+		st.siteRow.push_back(entryRow[e]);
+		st.wSpread.push_back(entryWeight[e]);
+	}
+	st.siteStart.push_back(static_cast<int>(order.size()));
 }
 
 
@@ -1060,83 +1060,258 @@ void ObjectManager::ibm_finaliseReadIn(int iBodyID) {
 
 
 // *****************************************************************************
-///	\brief	Gather all the markers into the temporary iBody vector
+///	\brief	Gather the markers for the universal epsilon calculation
+///
+///			The rows are the valid markers on this rank for all bodies on the 
+///			level. The columns are the position, dilation and ds of the valid 
+///			markers of every rank on the level in rank order.
 ///
 ///	\param	level		current grid level
-///	\param	iBodyTmp	container for all markers in entire simulation
-void ObjectManager::ibm_universalEpsilonGather(int level, IBBody &iBodyTmp) {
+///	\param	rows		markers of the rows owned by this rank
+///	\param	cols		column data for all markers on the level
+///	\param	rowCounts	number of rows on each rank of the level
+void ObjectManager::ibm_universalEpsilonGather(int level, std::vector<IBMarker*> &rows, std::vector<double> &cols, std::vector<int> &rowCounts) {
 
+	// Loop through all valid markers of iBodies on this level
+	for (size_t ib = 0; ib < iBody.size(); ib++) {
+		if (iBody[ib].level == level) {
+			for (auto m : iBody[ib].validMarkers) {
+				rows.push_back(&iBody[ib].markers[m]);
+				for (int d = 0; d < L_DIMS; d++) cols.push_back(iBody[ib].markers[m].position[d]);
+				cols.push_back(iBody[ib].markers[m].dilation);
+				cols.push_back(iBody[ib].markers[m].ds);
+			}
+		}
+	}
 
 #ifdef L_BUILD_FOR_MPI
 
-	// Get mpi manager instance
-	MpiManager *mpim = MpiManager::getInstance();
+	// Gather in the data for all markers on this level
+	MpiManager::getInstance()->mpi_uniEpsilonCommGather(level, cols, rowCounts);
 
-	// Set root rank
-	std::vector<int> lev2glob = mpim->mpi_mapRankLevelToWorld(level);
-	int rootRank = lev2glob[0];
+#else
 
-	// Gather in the data for all markers in the system
-	mpim->mpi_uniEpsilonCommGather(level, rootRank, iBodyTmp);
+	rowCounts.assign(1, static_cast<int>(rows.size()));
 
-#else
+#endif
+}
 
-	// Loop through all iBodies and all markers
-	for (int ib = 0; ib < iBody.size(); ib++) {
 
-		// Check if this body is on this grid level
-		if (iBody[ib].level == level) {
+// *****************************************************************************
+///	\brief	Spread the epsilon values to the ranks which own the iBodies
+///
+///	\param	level		current grid level.
+void ObjectManager::ibm_universalEpsilonScatter(int level) {
 
-			// Set markers
-			for (int m = 0; m < iBody[ib].markers.size(); m++) {
-				iBodyTmp.markers.push_back(iBody[ib].markers[m]);
-			}
+#ifdef L_BUILD_FOR_MPI
+
+	// Send epsilon of the markers to the owning ranks of their bodies
+	MpiManager::getInstance()->mpi_uniEpsilonCommScatter(level);
 
-			// Set the global values
-			iBodyTmp.owningRank = 0;
-			iBodyTmp.level = level;
-			iBodyTmp._Owner = iBody[ib]._Owner;
-			iBodyTmp.dh = iBody[ib].dh;
+#endif
+}
+
+
+// *****************************************************************************
+///	\brief	Assemble the sparse epsilon coefficient matrix
+///
+///			Entry (I,J) integrates the kernel of marker J over the support of 
+///			marker I. The columns are binned into cells as wide as the largest 
+///			kernel so only the markers in the cells around the support of a 
+///			row are evaluated. Entries are summed in the same order as the 
+///			dense assembly.
+///
+///	\param	rows		markers of the rows (with support and local area)
+///	\param	cols		position, dilation and ds of each column marker
+///	\param	dh			lattice spacing of the level
+///	\param	rowPtr		offset of the first entry of each row (rows + 1)
+///	\param	colIdx		column of each entry
+///	\param	val			value of each entry
+void ObjectManager::ibm_buildEpsilonMatrix(const std::vector<IBMarker*> &rows, const std::vector<double> &cols, double dh,
+	std::vector<int> &rowPtr, std::vector<int> &colIdx, std::vector<double> &val) {
+
+	// Number of values per column marker
+	const int stride = L_DIMS + 2;
+	int nCols = static_cast<int>(cols.size()) / stride;
+
+	rowPtr.assign(1, 0);
+	colIdx.clear();
+	val.clear();
+
+	// Cell size and extent of the column markers
+	double cellSize = 0.0;
+	double lo[3] = { 0.0, 0.0, 0.0 };
+	double hi[3] = { 0.0, 0.0, 0.0 };
+	for (int J = 0; J < nCols; J++) {
+		cellSize = std::max(cellSize, 1.5 * cols[J * stride + L_DIMS] * dh);
+		for (int d = 0; d < L_DIMS; d++) {
+			lo[d] = (J == 0) ? cols[J * stride + d] : std::min(lo[d], cols[J * stride + d]);
+			hi[d] = (J == 0) ? cols[J * stride + d] : std::max(hi[d], cols[J * stride + d]);
 		}
 	}
+	long long nCells[3] = { 1, 1, 1 };
+	for (int d = 0; d < L_DIMS; d++)
+		nCells[d] = static_cast<long long>((hi[d] - lo[d]) / cellSize) + 1;
+
+	// Cell of a position
+	auto getCell = [&](double pos, int d) {
+		return static_cast<long long>(std::floor((pos - lo[d]) / cellSize));
+	};
+
+	// Sort the columns by cell
+	std::vector<std::pair<long long, int>> colCells(nCols);
+	for (int J = 0; J < nCols; J++) {
+		long long c[3] = { 0, 0, 0 };
+		for (int d = 0; d < L_DIMS; d++)
+			c[d] = std::min(std::max(getCell(cols[J * stride + d], d), 0LL), nCells[d] - 1);
+		colCells[J] = std::make_pair((c[0] * nCells[1] + c[1]) * nCells[2] + c[2], J);
+	}
+	std::sort(colCells.begin(), colCells.end());
+
+	// Loop over rows
+	std::vector<int> candidates;
+	for (size_t I = 0; I < rows.size(); I++) {
+		IBMarker &marker = *rows[I];
+		const double *supp[3] = { marker.supp_x.data(), marker.supp_y.data(), marker.supp_z.data() };
+		size_t nSupp = marker.deltaval.size();
+
+		// Cells around the support
+		long long cLo[3] = { 0, 0, 0 }, cHi[3] = { 0, 0, 0 };
+		for (int d = 0; d < L_DIMS; d++) {
+			double sLo = supp[d][0], sHi = supp[d][0];
+			for (size_t s = 1; s < nSupp; s++) {
+				sLo = std::min(sLo, supp[d][s]);
+				sHi = std::max(sHi, supp[d][s]);
+			}
+			cLo[d] = std::max(getCell(sLo, d) - 1, 0LL);
+			cHi[d] = std::min(getCell(sHi, d) + 1, nCells[d] - 1);
+		}
 
+		// Candidate columns
+		candidates.clear();
+		if (nSupp > 0) {
+			for (long long ci = cLo[0]; ci <= cHi[0]; ci++) {
+				for (long long cj = cLo[1]; cj <= cHi[1]; cj++) {
+					for (long long ck = cLo[2]; ck <= cHi[2]; ck++) {
+						long long key = (ci * nCells[1] + cj) * nCells[2] + ck;
+						auto range = std::equal_range(colCells.begin(), colCells.end(), std::make_pair(key, 0),
+							[](const std::pair<long long, int> &a, const std::pair<long long, int> &b) { return a.first < b.first; });
+						for (auto c = range.first; c != range.second; c++) candidates.push_back(c->second);
+					}
+				}
+			}
+		}
+		std::sort(candidates.begin(), candidates.end());
+
+		// Sum delta values evaluated for each support of I
+		for (int J : candidates) {
+			const double *colJ = &cols[J * stride];
+			double a = 0.0;
+			for (size_t s = 0; s < nSupp; s++) {
+				double Delta_J = 1.0;
+				for (int d = 0; d < L_DIMS; d++)
+					Delta_J *= ibm_deltaKernel((colJ[d] - supp[d][s]) / dh, colJ[L_DIMS]);
+
+				// Multiply by local area (or volume in 3D)
+				a += marker.deltaval[s] * Delta_J * marker.local_area;
+			}
 
-#endif
+			// Multiply by arc length between markers in lattice units
+			if (a != 0.0) {
+				colIdx.push_back(J);
+				val.push_back(a * colJ[L_DIMS + 1]);
+			}
+		}
+		rowPtr.push_back(static_cast<int>(colIdx.size()));
+	}
 }
 
 
+#ifdef L_ADAPTIVE_REFINEMENT
 // *****************************************************************************
-///	\brief	Spread all the epsilon values to all ranks which own markers
+///	\brief	Tag the coarse sites near the markers for adaptive refinement.
 ///
-///	\param	level		current grid level.
-///	\param	iBodyTmp	container for all markers in entire simulation
-void ObjectManager::ibm_universalEpsilonScatter(int level, IBBody &iBodyTmp) {
+///			With the body distance criterion all sites within L_AMR_THRESHOLD
+///			of a marker are tagged. Otherwise only the sites next to the 
+///			markers of bodies on sub-grids are tagged so these stay refined.
+///
+///	\param	tags	tag of each site on L0 (global ijk flattened as k + K * (j + M * i)).
+///	\param	size	global size of L0.
+///	\param	dh		lattice spacing of L0.
+void ObjectManager::ibm_tagSites(std::vector<unsigned char> &tags, const int *size, double dh) {
 
+	for (IBBody &body : iBody) {
 
-#ifdef L_BUILD_FOR_MPI
+		double radius;
+		if (L_AMR_CRITERION == eAmrBodyDistance) radius = L_AMR_THRESHOLD;
+		else if (body.level > 0) radius = dh;
+		else continue;
 
-	// Get mpi manager instance
-	MpiManager *mpim = MpiManager::getInstance();
+		for (IBMarker &marker : body.markers) {
 
-	// Set root rank
-	std::vector<int> lev2glob = mpim->mpi_mapRankLevelToWorld(level);
-	int rootRank = lev2glob[0];
+			// Sites within the radius of the marker
+			int lo[3] = { 0, 0, 0 }, hi[3] = { 0, 0, 0 };
+			for (int d = 0; d < L_DIMS; d++) {
+				lo[d] = std::max(static_cast<int>(std::floor((marker.position[d] - radius) / dh)), 0);
+				hi[d] = std::min(static_cast<int>(std::floor((marker.position[d] + radius) / dh)), size[d] - 1);
+			}
+			for (int i = lo[0]; i <= hi[0]; i++) {
+				for (int j = lo[1]; j <= hi[1]; j++) {
+					for (int k = lo[2]; k <= hi[2]; k++) {
+
+						// Distance from the marker to the nearest point of the site
+						int ijk[3] = { i, j, k };
+						double distSq = 0.0;
+						for (int d = 0; d < L_DIMS; d++) {
+							double dist = std::max(fabs((ijk[d] + 0.5) * dh - marker.position[d]) - 0.5 * dh, 0.0);
+							distSq += dist * dist;
+						}
+						if (distSq <= radius * radius) tags[k + size[2] * (j + size[1] * i)] = 1;
+					}
+				}
+			}
+		}
+	}
+}
 
-	// Gather in the data for all markers in the system
-	mpim->mpi_uniEpsilonCommScatter(level, rootRank, iBodyTmp);
+// *****************************************************************************
+///	\brief	Check the bodies on sub-grids lie inside the edges of their grid.
+///
+///			Uses the edges in the grid manager so can be called once new edges
+///			have been placed but before the grids are built. The markers must
+///			be clear of the transition layer and the support must fit.
+///
+///	\return	true if the markers on this rank are all inside their grid.
+bool ObjectManager::ibm_insideSubGrids() {
 
-#else
+	GridManager *gm = GridManager::getInstance();
 
-	// Loop through all iBodies and all markers
-	int markerIdx = 0;
-	for (int ib = 0; ib < iBody.size(); ib++) {
-		if (iBody[ib].level == level) {
-			for (int m = 0; m < iBody[ib].markers.size(); m++) {
-				iBody[ib].markers[m].epsilon = iBodyTmp.markers[markerIdx].epsilon;
-				markerIdx++;
+	for (IBBody &body : iBody) {
+
+		if (body.level == 0) continue;
+		int idx = body.level + body._Owner->region_number * L_NUM_LEVELS;
+		double margin = 4.0 * body._Owner->dh;
+
+		for (IBMarker &marker : body.markers) {
+			for (int d = 0; d < L_DIMS; d++) {
+				if (marker.position[d] < gm->global_edges[2 * d][idx] + margin ||
+					marker.position[d] > gm->global_edges[2 * d + 1][idx] - margin)
+					return false;
 			}
 		}
 	}
+	return true;
+}
 
-#endif
+// *****************************************************************************
+///	\brief	Point the bodies on sub-grids at the grids of a new hierarchy.
+///
+///	\param	Grids	pointer to L0 of the new hierarchy.
+void ObjectManager::ibm_updateOwners(GridObj *Grids) {
+
+	for (IBBody &body : iBody) {
+		if (body.level > 0)
+			GridUtils::getGrid(Grids, body.level, body._Owner->region_number, body._Owner);
+	}
 }
+#endif
@@ -141,13 +141,26 @@ void ObjectManager::ibm_spreadOffRankForces(int level) {
 ///	\brief	Update new markers across all ranks
 ///
 ///	\param	level		current grid level
-void ObjectManager::ibm_updateMarkers(int level) {
+///	\param	bAllBodies	pass on the markers of all bodies rather than only flexible ones (used when rebalancing)
+void ObjectManager::ibm_updateMarkers(int level, bool bAllBodies) {
 
 	// Get the mpi manager instance
 	MpiManager *mpim = MpiManager::getInstance();
 
-	// Loop through all flexible bodies that this rank owns
-	for (auto ib : idxFEM) {
+	// Bodies owned by this rank whose markers are passed on
+	std::vector<int> ownedBodies;
+	if (bAllBodies) {
+		for (size_t ib = 0; ib < iBody.size(); ib++) {
+			if (iBody[ib].owningRank == mpim->my_rank)
+				ownedBodies.push_back(static_cast<int>(ib));
+		}
+	}
+	else {
+		ownedBodies = idxFEM;
+	}
+
+	// Loop through all bodies that this rank owns
+	for (auto ib : ownedBodies) {
 
 		// Only do if on this grid level
 		if (iBody[ib]._Owner->level == level) {
@@ -165,13 +178,13 @@ void ObjectManager::ibm_updateMarkers(int level) {
 	std::vector<std::vector<std::vector<double>>> vels(iBody.size(), std::vector<std::vector<double>>(0, std::vector<double>(0)));
 
 	// Do MPI comm for spreading markers
-	mpim->mpi_spreadNewMarkers(level, markerIDs, positions, vels);
+	mpim->mpi_spreadNewMarkers(level, ownedBodies, markerIDs, positions, vels);
 
 	// Loop through all iBodies
 	for (size_t ib = 0; ib < iBody.size(); ib++) {
 
-		// If body is on this level and flexible
-		if (iBody[ib]._Owner->level == level && iBody[ib].isFlexible) {
+		// If body is on this level and flexible (or all bodies are being updated)
+		if (iBody[ib]._Owner->level == level && (iBody[ib].isFlexible || bAllBodies)) {
 
 			// Also if not owned by this rank
 			if (iBody[ib].owningRank != mpim->my_rank) {
@@ -131,69 +131,111 @@ void ObjectManager::io_writeLiftDrag() {
 // *****************************************************************************
 ///	\brief	Read/write body information to restart file
 ///
-///	\param	IO_flag		flag indicating write (true) or read (false)
-///	\param	level		current grid level
+///			IB body state is written to a single binary restart file which 
+///			starts with a header of four 64-bit integers (identifier, format 
+///			version, number of bodies and number of values following) and is
+///			followed by a block of doubles for each body written by the rank
+///			which owns it. Each block holds the body ID, number of markers and
+///			number of FEM DOFs followed by the ID, position, initial position
+///			and velocity of every marker and, for flexible bodies, the FEM 
+///			displacements, velocities and accelerations (current and at the
+///			start of the time step). Blocks are written collectively with 
+///			MPI-IO in MPI builds. Every rank reads the whole file and updates 
+///			the markers it holds by ID so the file may be read with any number 
+///			of ranks. The markers are then passed on to the ranks on which they
+///			now lie. Must be called by all ranks.
+///
+///	\param	IO_flag		flag indicating write or read
+///	\param	level		current grid level (bodies are read/written from L0 only)
 void ObjectManager::io_restart(eIOFlag IO_flag, int level) {
 
+	// Only the coarsest grid reads/writes the bodies
+	if (level != 0) return;
+
 	int rank = GridUtils::safeGetRank();
+	const int nMarkerValues = 10;
+	const int nHeader = 4;
+	long long header[nHeader];
 
-	if (IO_flag == eWrite) {
+#ifdef L_BUILD_FOR_MPI
+	MpiManager *mpim = MpiManager::getInstance();
+	MPI_File fh;
+#endif
 
-		// Output stream
-		std::ofstream file;
+	if (IO_flag == eWrite) {
 
 		// IB BODIES //
 
-		if (level == 0) {
-			// Overwrite as first to write
-			file.open(GridUtils::path_str + "/restart_IBBody_Rnk" + std::to_string(rank) + ".out", std::ios::out);
-		} else if (level == 0) {
-			// Append
-			file.open(GridUtils::path_str + "/restart_IBBody_Rnk" + std::to_string(rank) + ".out", std::ios::out | std::ios::app);
-		} else {
-			// Must be a subgrid which doesn't own any IB-bodies so return
-			return;
-		}
-
+		// Pack the bodies owned by this rank
+		std::vector<double> blocks;
+		for (size_t b = 0; b < iBody.size(); b++) {
 
-		// Counters
-		size_t b, m, num_bod = iBody.size();
+			if (iBody[b].owningRank != rank) continue;
 
-		// Write out the number of bodies
-		file << num_bod << std::endl;
+			FEMBody *fBody = (iBody[b].isFlexible ? iBody[b].fBody : nullptr);
+			size_t nDOFs = (fBody ? fBody->U.size() : 0);
 
-		// Loop over bodies and markers and write out the positions
-		for (b = 0; b < num_bod; b++) {
+			blocks.push_back(iBody[b].id);
+			blocks.push_back(static_cast<double>(iBody[b].markers.size()));
+			blocks.push_back(static_cast<double>(nDOFs));
 
-			// Add a separator between bodies
-			file << "\t/\t";
+			for (size_t m = 0; m < iBody[b].markers.size(); m++) {
+				blocks.push_back(iBody[b].markers[m].id);
+				blocks.insert(blocks.end(), iBody[b].markers[m].position.begin(), iBody[b].markers[m].position.begin() + 3);
+				blocks.insert(blocks.end(), iBody[b].markers[m].position0.begin(), iBody[b].markers[m].position0.begin() + 3);
+				blocks.insert(blocks.end(), iBody[b].markers[m].markerVel.begin(), iBody[b].markers[m].markerVel.begin() + 3);
+			}
 
-			// Number of markers with separator
-			file << iBody[b].markers.size() << "\t/\t";
+			if (fBody) {
+				blocks.insert(blocks.end(), fBody->U.begin(), fBody->U.end());
+				blocks.insert(blocks.end(), fBody->Udot.begin(), fBody->Udot.end());
+				blocks.insert(blocks.end(), fBody->Udotdot.begin(), fBody->Udotdot.end());
+				blocks.insert(blocks.end(), fBody->U_n.begin(), fBody->U_n.end());
+				blocks.insert(blocks.end(), fBody->Udot_n.begin(), fBody->Udot_n.end());
+				blocks.insert(blocks.end(), fBody->Udotdot_n.begin(), fBody->Udotdot_n.end());
+			}
+		}
 
-			for (m = 0; m < iBody[b].markers.size(); m++) {
+		// Header
+		long long nLocal = static_cast<long long>(blocks.size());
+		header[0] = L_RESTART_ID;
+		header[1] = L_RESTART_VERSION;
+		header[2] = static_cast<long long>(iBody.size());
+		header[3] = nLocal;
 
-				// Positions of each marker
-				file	<< iBody[b].markers[m].position[0] << "\t"
-						<< iBody[b].markers[m].position[1] << "\t"
-						<< iBody[b].markers[m].position[2] << "\t";
+		std::string fileName = GridUtils::path_str + "/restart_IBBody.bin";
 
+#ifdef L_BUILD_FOR_MPI
 
-				if (iBody[b].isFlexible) {
+		// Offset of the blocks of this rank and total size
+		long long nBefore = 0;
+		MPI_Exscan(&nLocal, &nBefore, 1, MPI_LONG_LONG, MPI_SUM, mpim->world_comm);
+		if (mpim->my_rank == 0) nBefore = 0;
+		MPI_Allreduce(&nLocal, &header[3], 1, MPI_LONG_LONG, MPI_SUM, mpim->world_comm);
 
-					// Old positions of each marker
-					file << iBody[b].markers[m].position0[0] << "\t"
-						<< iBody[b].markers[m].position0[1] << "\t"
-						<< iBody[b].markers[m].position0[2] << "\t";
-				}
+		// Replace any existing file
+		if (mpim->my_rank == 0) MPI_File_delete(fileName.c_str(), MPI_INFO_NULL);
+		MPI_Barrier(mpim->world_comm);
+		if (MPI_File_open(mpim->world_comm, fileName.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS)
+			L_ERROR("Error opening IBM restart file for writing. Exiting.", GridUtils::logfile);
 
-			}
+		if (mpim->my_rank == 0)
+			MPI_File_write_at(fh, 0, header, nHeader, MPI_LONG_LONG, MPI_STATUS_IGNORE);
+		MPI_File_write_at_all(fh, static_cast<MPI_Offset>(sizeof(header) + nBefore * sizeof(double)),
+			blocks.data(), static_cast<int>(nLocal), MPI_DOUBLE, MPI_STATUS_IGNORE);
+		MPI_File_close(&fh);
 
-		}
+#else
 
-		// Close file
+		std::ofstream file(fileName, std::ios::out | std::ios::binary);
+		if (!file.is_open())
+			L_ERROR("Error opening IBM restart file for writing. Exiting.", GridUtils::logfile);
+		file.write(reinterpret_cast<const char*>(header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(blocks.data()), blocks.size() * sizeof(double));
 		file.close();
 
+#endif
+
 
 		// BFL BODIES //
 
@@ -202,79 +244,111 @@ void ObjectManager::io_restart(eIOFlag IO_flag, int level) {
 
 	} else {
 
-		// Input stream
-		std::ifstream file;
-
 		// IB BODIES //
 
-		// We only enter this routine if on correct level so no need to check
-		file.open("./input/restart_IBBody_Rnk" + std::to_string(rank) + ".out", std::ios::in);
+		std::string fileName = "./input/restart_IBBody.bin";
+		std::vector<double> blocks;
 
-		if (!file.is_open()) {
-			L_ERROR("Error opening IBM restart file. Exiting.", GridUtils::logfile);
-		}
+#ifdef L_BUILD_FOR_MPI
 
-		// Read in one line of file at a time
-		std::string line_in;	// String to store line
-		std::istringstream iss;	// Buffer stream
+		// Every rank reads the whole file
+		if (MPI_File_open(mpim->world_comm, fileName.c_str(), MPI_MODE_RDONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS)
+			L_ERROR("Error opening IBM restart file. Exiting.", GridUtils::logfile);
+		MPI_File_read_at_all(fh, 0, header, nHeader, MPI_LONG_LONG, MPI_STATUS_IGNORE);
+		blocks.resize(header[3]);
+		MPI_File_read_at_all(fh, static_cast<MPI_Offset>(sizeof(header)),
+			blocks.data(), static_cast<int>(header[3]), MPI_DOUBLE, MPI_STATUS_IGNORE);
+		MPI_File_close(&fh);
 
-		// Get line up to separator and put in buffer
-		std::getline(file,line_in,'/');
-		iss.str(line_in);
-		iss.seekg(0); // Reset buffer position to start of buffer
+#else
 
-		// Counters
-		int b, m, num_bod, num_mark;
+		std::ifstream file(fileName, std::ios::in | std::ios::binary);
+		if (!file.is_open())
+			L_ERROR("Error opening IBM restart file. Exiting.", GridUtils::logfile);
+		file.read(reinterpret_cast<char*>(header), sizeof(header));
+		blocks.resize(header[3]);
+		file.read(reinterpret_cast<char*>(blocks.data()), blocks.size() * sizeof(double));
+		file.close();
 
-		// Read in number of bodies
-		iss >> num_bod;
+#endif
 
-		// Check number of bodies is correct
-		if (iBody.size() != num_bod) {
+		// Check file
+		if (header[0] != L_RESTART_ID || header[1] != L_RESTART_VERSION)
+			L_ERROR("IBM restart file is not a valid restart file. Exiting.", GridUtils::logfile);
+		if (header[2] != static_cast<long long>(iBody.size()))
 			L_ERROR("Number of IBM bodies does not match the number specified in the restart file. Exiting.", GridUtils::logfile);
-		}
-
-		// Loop over bodies
-		for (b = 0; b < num_bod; b++) {
-
-			// Exit if reached end of file
-			if (file.eof()) break;
 
-			// Get next bit up to separator and put in buffer
-			std::getline(file,line_in,'/');
-			iss.str(line_in);
-			iss.seekg(0); // Reset buffer position to start of buffer
-
-			// Read in the number of markers for this body
-			iss >> num_mark;
+		// Loop over body blocks
+		size_t pos = 0;
+		while (pos < blocks.size()) {
+
+			int bodyID = static_cast<int>(blocks[pos]);
+			int nMarkers = static_cast<int>(blocks[pos + 1]);
+			size_t nDOFs = static_cast<size_t>(blocks[pos + 2]);
+			const double *markerData = &blocks[pos + 3];
+			const double *femData = markerData + nMarkers * nMarkerValues;
+			pos += 3 + nMarkers * nMarkerValues + 6 * nDOFs;
+
+			// Get the body
+			size_t b;
+			for (b = 0; b < iBody.size(); b++) {
+				if (iBody[b].id == bodyID) break;
+			}
+			if (b == iBody.size()) continue;
 
 			// Check number of markers the same
-			if (iBody[b].markers.size() != num_mark) {
+			if (iBody[b].owningRank == rank && static_cast<int>(iBody[b].markers.size()) != nMarkers) {
 				L_ERROR("Number of IBM markers does not match the number specified for body " +
-					std::to_string(b) + " in the restart file. Exiting.", GridUtils::logfile);
+					std::to_string(bodyID) + " in the restart file. Exiting.", GridUtils::logfile);
 			}
 
-			// Read in marker data
-			for (m = 0; m < num_mark; m++) {
+			// Position in the block of each marker ID
+			std::vector<int> markerIdx(nMarkers, -1);
+			for (int m = 0; m < nMarkers; m++) {
+				int markerID = static_cast<int>(markerData[m * nMarkerValues]);
+				if (markerID >= 0 && markerID < nMarkers) markerIdx[markerID] = m;
+			}
 
-				// Positions of each marker
-				iss		>> iBody[b].markers[m].position[0]
-						>> iBody[b].markers[m].position[1]
-						>> iBody[b].markers[m].position[2];
+			// Update the markers held on this rank
+			for (size_t m = 0; m < iBody[b].markers.size(); m++) {
 
-				if (iBody[b].isFlexible) {
+				int markerID = iBody[b].markers[m].id;
+				if (markerID < 0 || markerID >= nMarkers || markerIdx[markerID] < 0) continue;
+				const double *marker = markerData + markerIdx[markerID] * nMarkerValues;
 
-					// Old positions of each marker
-					iss		>> iBody[b].markers[m].position0[0]
-							>> iBody[b].markers[m].position0[1]
-							>> iBody[b].markers[m].position0[2];
+				for (int d = 0; d < 3; d++) {
+					iBody[b].markers[m].position[d] = marker[1 + d];
+					iBody[b].markers[m].position0[d] = marker[4 + d];
+					iBody[b].markers[m].markerVel[d] = marker[7 + d];
 				}
 			}
 
+			// Structural state is held by the owning rank
+			if (iBody[b].owningRank == rank && iBody[b].isFlexible && iBody[b].fBody) {
+
+				FEMBody *fBody = iBody[b].fBody;
+				if (fBody->U.size() != nDOFs) {
+					L_ERROR("Number of FEM DOFs does not match the number specified for body " +
+						std::to_string(bodyID) + " in the restart file. Exiting.", GridUtils::logfile);
+				}
+
+				fBody->U.assign(femData, femData + nDOFs);
+				fBody->Udot.assign(femData + nDOFs, femData + 2 * nDOFs);
+				fBody->Udotdot.assign(femData + 2 * nDOFs, femData + 3 * nDOFs);
+				fBody->U_n.assign(femData + 3 * nDOFs, femData + 4 * nDOFs);
+				fBody->Udot_n.assign(femData + 4 * nDOFs, femData + 5 * nDOFs);
+				fBody->Udotdot_n.assign(femData + 5 * nDOFs, femData + 6 * nDOFs);
+
+				// Update the nodes and elements from the displacements
+				fBody->updateFEMValues();
+			}
 		}
 
-		// Close file
-		file.close();
+#ifdef L_BUILD_FOR_MPI
+		// Pass the markers on to the ranks on which they now lie
+		for (int lev = 0; lev <= mpim->rankGrids[mpim->my_rank]; lev++)
+			ibm_updateMarkers(lev, true);
+#endif
 
 
 		// BFL BODIES //
@@ -285,7 +359,6 @@ void ObjectManager::io_restart(eIOFlag IO_flag, int level) {
 
 }
 
-
 // *****************************************************************************
 ///	\brief	Wrapper for writing body position data to VTK file
 ///
@@ -1017,6 +1090,14 @@ void ObjectManager::io_readInCloud(PCpts*& _PCpts, GeomPacked *geom)
 	}
 #endif	
 
+	// Bounce-back bodies are registered on every rank so body indices match across ranks
+	if (geom->objtype == eBBBCloud)
+	{
+		bbbOnGridLevel.push_back(geom->onGridLev);
+		bbbOnGridReg.push_back(geom->onGridReg);
+		bbbForce.resize(3 * bbbOnGridLevel.size(), 0.0);
+	}
+
 	// If there are points left
 	if (!_PCpts->x.empty() && geom->objtype != eIBBCloud)
 	{
@@ -1055,7 +1136,8 @@ void ObjectManager::io_readInCloud(PCpts*& _PCpts, GeomPacked *geom)
 /// \brief	Write out the forces on a solid object
 ///
 ///			Writes out the forces on solid objects in the domain computed using
-///			momentum exchange. Each rank writes its own file. Output is a CSV file.
+///			momentum exchange. Each rank writes its own file for each body. 
+///			Output is a CSV file.
 ///
 ///	\param	tval		time value at which write out is taking place
 void ObjectManager::io_writeForcesOnObjects(double tval) {
@@ -1064,31 +1146,30 @@ void ObjectManager::io_writeForcesOnObjects(double tval) {
 	int rank = GridUtils::safeGetRank();
 	std::ofstream fout;
 	fout.precision(L_OUTPUT_PRECISION);
-	std::stringstream fileName;
 
 	// BB OBJECTS //
-
-	// Get grid on which object resides
-	GridObj *g = NULL;
-	GridUtils::getGrid(_Grids, bbbOnGridLevel, bbbOnGridReg, g);
-	// If this grid exists on this process
-	if (g != NULL)
+	for (size_t b = 0; b < bbbOnGridLevel.size(); ++b)
 	{
-		// Filename
-		fileName << GridUtils::path_str + "/LiftDragBBB_Rnk" << rank << ".csv";
+		// Get grid on which object resides
+		GridObj *g = NULL;
+		GridUtils::getGrid(_Grids, bbbOnGridLevel[b], bbbOnGridReg[b], g);
+
+		// If this grid exists on this process
+		if (g == NULL) continue;
 
 		// Open file
-		fout.open(fileName.str().c_str(), std::ios::out | std::ios::app);
+		fout.open(GridUtils::path_str + "/LiftDragBBB_Body" + std::to_string(b) + 
+			"_Rnk" + std::to_string(rank) + ".csv", std::ios::out | std::ios::app);
 
 		// Write out the header (first time step only)
 		if (static_cast<int>(tval) == L_EXTRA_OUT_FREQ) fout << "Time,Fx,Fy,Fz" << std::endl;
 
 		// Scaled with respect to refinement ratio
 		fout << std::to_string(tval) << ","
-			<< std::to_string(bbbForceOnObjectX * g->refinement_ratio) << ","
-			<< std::to_string(bbbForceOnObjectY * g->refinement_ratio) << ","
-#if (dims == 3)
-			<< std::to_string(bbbForceOnObjectZ * g->refinement_ratio)
+			<< std::to_string(bbbForce[3 * b + eXDirection] * g->refinement_ratio) << ","
+			<< std::to_string(bbbForce[3 * b + eYDirection] * g->refinement_ratio) << ","
+#if (L_DIMS == 3)
+			<< std::to_string(bbbForce[3 * b + eZDirection] * g->refinement_ratio)
 #else
 			<< std::to_string(0.0)
 #endif
@@ -1098,16 +1179,13 @@ void ObjectManager::io_writeForcesOnObjects(double tval) {
 	}
 
 	// BFL OBJECTS //
-	ObjectManager *objman = ObjectManager::getInstance();
-	
-	// Search for bodies on this rank
-	for (BFLBody& body : objman->pBody)
+	for (size_t b = 0; b < pBody.size(); ++b)
 	{
-		// Filename
-		fileName << GridUtils::path_str + "/LiftDragBFL_Rnk" << rank << ".csv";
+		BFLBody &body = pBody[b];
 
 		// Open file
-		fout.open(fileName.str().c_str(), std::ios::out | std::ios::app);
+		fout.open(GridUtils::path_str + "/LiftDragBFL_Body" + std::to_string(b) + 
+			"_Rnk" + std::to_string(rank) + ".csv", std::ios::out | std::ios::app);
 
 		// Write out the header (first time step only)
 		if (static_cast<int>(tval) == L_EXTRA_OUT_FREQ) fout << "Time,Fx,Fy,Fz" << std::endl;
@@ -1130,7 +1208,7 @@ void ObjectManager::io_writeForcesOnObjects(double tval) {
 		fout << std::to_string(tval) << ","
 			<< std::to_string(bodyForceX * body._Owner->refinement_ratio) << ","
 			<< std::to_string(bodyForceY * body._Owner->refinement_ratio) << ","
-#if (dims == 3)
+#if (L_DIMS == 3)
 			<< std::to_string(bodyForceZ * body._Owner->refinement_ratio)
 #else
 			<< std::to_string(0.0)
@@ -79,8 +79,14 @@ int main( int argc, char* argv[] )
 
 #ifdef L_BUILD_FOR_MPI
 
+#ifdef L_ENABLE_OPENMP
+	// Hybrid mode -- only the master thread of each rank makes MPI calls
+	int mpiThreadSupport;
+	MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &mpiThreadSupport);
+#else
 	// Usual initialise
 	MPI_Init(&argc, &argv);
+#endif
 
 #endif
 
@@ -195,7 +201,12 @@ int main( int argc, char* argv[] )
 	*/
 
 	// Create the first object in the hierarchy (level = 0)
+#ifdef L_MPI_REBALANCE
+	// Hierarchy is replaced when the domain is rebalanced
+	GridObj *Grids = new GridObj(0);
+#else
 	GridObj *const Grids = new GridObj(0);
+#endif
 
 
 	// Log file information
@@ -225,6 +236,12 @@ int main( int argc, char* argv[] )
 	L_INFO("Reynolds Number = " + std::to_string(L_RE), GridUtils::logfile);
 #endif
 
+#if (defined L_USE_AA_STREAMING && defined L_USE_KBC_COLLISION)
+	/* The KBC operator works on the stored equilibrium which is not kept when 
+	 * streaming in place. */
+	L_ERROR("In-place streaming is incompatible with the KBC collision operator. Exiting.", GridUtils::logfile);
+#endif
+
 
 	/*
 	****************************************************************************
@@ -243,6 +260,21 @@ int main( int argc, char* argv[] )
 		L_ERROR("Loading the initial velocity field from a file is icompatible with subgrids. Exiting.", GridUtils::logfile);
 #endif
 
+#ifdef L_USE_AA_STREAMING
+		/* Explosion and coalescence between grids need the populations of the 
+		 * previous time step which are overwritten when streaming in place. */
+		L_ERROR("In-place streaming is incompatible with subgrids. Exiting.", GridUtils::logfile);
+#endif
+
+#if (defined L_ADAPTIVE_REFINEMENT && L_NUM_LEVELS > 1 && !defined L_AUTO_SUBGRIDS)
+		/* Only level 1 is placed by the adaptive refinement so the lower levels
+		 * must be placed relative to their parent. */
+		L_ERROR("Adaptive refinement with more than one level requires L_AUTO_SUBGRIDS. Exiting.", GridUtils::logfile);
+#endif
+#if (defined L_ADAPTIVE_REFINEMENT && L_AMR_PADDING < 1)
+		L_ERROR("Adaptive refinement requires L_AMR_PADDING of at least 1. Exiting.", GridUtils::logfile);
+#endif
+
 		// Loop over number of regions and add subgrids to Grids
 		for (int reg = 0; reg < L_NUM_REGIONS; reg++) {
 
@@ -405,7 +437,33 @@ int main( int argc, char* argv[] )
 #endif
 
 #ifdef L_ENABLE_OPENMP
-	L_WARN("OpenMP support enabled -- currently experimental!", GridUtils::logfile);
+	L_INFO("OpenMP enabled with " + std::to_string(omp_get_max_threads()) + " thread(s) per process.", GridUtils::logfile);
+#ifdef L_BUILD_FOR_MPI
+	if (mpiThreadSupport < MPI_THREAD_FUNNELED)
+		L_WARN("MPI library does not provide MPI_THREAD_FUNNELED support -- hybrid MPI/OpenMP may not be safe.", GridUtils::logfile);
+#endif
+#if (defined L_USE_AA_STREAMING && defined L_REGULARISED_BOUNDARIES)
+	L_WARN("In-place streaming with regularised boundaries is not threaded.", GridUtils::logfile);
+#endif
+#endif
+
+#if (defined L_BUILD_FOR_MPI && defined L_MPI_OVERLAP && (defined L_USE_AA_STREAMING || defined L_REGULARISED_BOUNDARIES))
+	L_WARN("Halo exchange cannot be overlapped with in-place streaming or regularised boundaries -- using blocking exchange.", GridUtils::logfile);
+#endif
+
+#if (defined L_ENABLE_OPENMP && defined L_OMP_BENCHMARK)
+	// Thread-scaling of the kernel on the coarse grid
+	Grids->LBM_benchmarkThreads();
+#endif
+
+#if (defined L_USE_SIMD_COLLISION && defined L_COLLISION_BENCHMARK)
+	// Compare scalar and vectorised collision kernels on the coarse grid
+	Grids->LBM_benchmarkCollision();
+#endif
+
+#if (defined L_BUILD_FOR_MPI && defined L_MPI_BENCHMARK)
+	// Compare the halo exchange transports on the coarse grid
+	mpim->mpi_benchmarkExchange();
 #endif
 	
 	L_INFO("Initialising LBM time-stepping...", GridUtils::logfile);
@@ -560,6 +618,18 @@ int main( int argc, char* argv[] )
 			Grids->io_restart(eWrite);
 		}
 
+#if (defined L_BUILD_FOR_MPI && defined L_MPI_REBALANCE)
+		// Rebalance the domain if the step times of the ranks have drifted apart
+		if (Grids->t % L_MPI_REBALANCE_FREQ == 0 && Grids->t < L_TOTAL_TIMESTEPS)
+			mpim->mpi_rebalance(Grids);
+#endif
+
+#ifdef L_ADAPTIVE_REFINEMENT
+		// Adapt the sub-grids to the flow
+		if (L_NUM_LEVELS != 0 && Grids->t % L_AMR_FREQ == 0 && Grids->t < L_TOTAL_TIMESTEPS)
+			Grids->LBM_adaptSubGrids();
+#endif
+
 
 #ifdef L_SHOW_TIME_TO_COMPLETE
 		// Update outer loop time (inc. effects of writing out for accuracy)
@@ -652,6 +722,11 @@ int main( int argc, char* argv[] )
 #endif
 
 
+#if (defined L_BUILD_FOR_MPI && defined L_MPI_COST_MODEL)
+	// Write the cost map for future decompositions
+	mpim->mpi_writeCostMap();
+#endif
+
 	// Close log file
 	curr_time = time(NULL);			// Current system date/time and string buffer
 	time_str = ctime(&curr_time);	// Format as string
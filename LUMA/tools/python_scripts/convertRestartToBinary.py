@@ -0,0 +1,50 @@
+# Script that converts the ASCII restart files restart_LBM_Rnk<N>.out written by LUMA 1.7.33 or older
+# to the binary restart file restart_LBM.bin read by later versions (on any number of ranks).
+# Only the lattice data are converted. IB bodies are re-initialised from the geometry configuration.
+# Must be run on a machine with the same byte order as the one that will read the file.
+
+import glob
+import struct
+import numpy as np
+
+# Input folder
+finput = './/'
+
+# Output folder
+foutput = './/input//'
+
+# Lattice settings (must match definitions.h of the build that will read the file)
+dims = 2
+nvels = 9
+resolution = 40.0
+N = 101
+M = 17
+K = 1
+
+# Time step at which the files were written (for information only)
+timestep = 0
+
+# Header and record layout (see GridObj::io_restart)
+L_RESTART_ID = 0x4C554D41
+L_RESTART_VERSION = 1
+dh = 1.0 / resolution
+
+records = []
+for name in sorted(glob.glob(finput + 'restart_LBM_Rnk*.out')):
+	print(name)
+	data = np.atleast_2d(np.loadtxt(name, delimiter='\t', usecols=range(0, 5 + dims + 1 + nvels)))
+	for row in data:
+		level = int(row[0])
+		region = int(row[1])
+		scale = 2 ** level
+		gi = int(round(row[2] / (dh / scale) - 0.5))
+		gj = int(round(row[3] / (dh / scale) - 0.5))
+		gk = int(round(row[4] / (dh / scale) - 0.5)) if dims == 3 else 0
+		index = gi + N * scale * (gj + M * scale * gk)
+		records.append(struct.pack('=iiq', level, region, index) + struct.pack('=%dd' % (dims + 1 + nvels), *row[5:]))
+
+# Write binary file
+with open(foutput + 'restart_LBM.bin', 'wb') as f:
+	f.write(struct.pack('=9q', L_RESTART_ID, L_RESTART_VERSION, dims, nvels, N, M, K, timestep, len(records)))
+	for r in records:
+		f.write(r)